@@ -0,0 +1,255 @@
+#include "batch_behavior_tree_executor.hpp"
+#include <algorithm>
+#include <cassert>
+
+void fluczakAI::BatchBehaviorTreeExecutor::Execute(std::span<BehaviorTreeContext> contexts, std::span<Status> results)
+{
+    assert(results.empty() || results.size() == contexts.size());
+    const size_t count = contexts.size();
+    const auto& nodes = m_tree.GetNodes();
+    if (nodes.empty() || count == 0) return;
+
+    if (m_scratch.empty())
+    {
+        // A level of scratch memory per level of the tree, so the scratch of a node is never reallocated
+        // while its children are executed
+        size_t maxDepth = 1;
+        std::vector<uint32_t> ends;
+        for (const auto& node : nodes)
+        {
+            while (!ends.empty() && &node - nodes.data() >= ends.back()) ends.pop_back();
+            ends.push_back(node.subtreeEnd);
+            maxDepth = std::max(maxDepth, ends.size());
+        }
+        m_scratch.resize(maxDepth);
+    }
+
+    m_contexts = contexts.data();
+    m_results.resize(count);
+    m_agents.resize(count);
+    for (size_t i = 0; i < count; i++)
+    {
+        m_agents[i] = static_cast<uint32_t>(i);
+        if (contexts[i].statuses.Size() < m_tree.GetNodeCount())
+        {
+            contexts[i].statuses.Resize(m_tree.GetNodeCount());
+        }
+        // The agents don't follow their running path, it's cleared so Resume starts from the root
+        contexts[i].runningPath.clear();
+    }
+
+    ExecuteNode(0, m_agents.data(), count, 0);
+
+    if (!results.empty())
+    {
+        std::copy_n(m_results.data(), count, results.data());
+    }
+}
+
+void fluczakAI::BatchBehaviorTreeExecutor::ExecuteNode(uint32_t index, const uint32_t* agents, size_t count, size_t depth)
+{
+    const auto& nodes = m_tree.GetNodes();
+    const FlatBehaviorTree::Node& node = nodes[index];
+    const uint32_t firstChild = index + 1;
+
+    if (node.type == FlatBehaviorTree::NodeType::LEAF)
+    {
+        ExecuteLeaf(node, agents, count);
+        return;
+    }
+
+    for (size_t i = 0; i < count; i++)
+    {
+        m_tree.ResetPendingChildren(index, m_contexts[agents[i]]);
+    }
+
+    Scratch& scratch = m_scratch[depth];
+    std::vector<uint32_t>& active = scratch.active;
+    std::vector<uint32_t>& group = scratch.group;
+    active.assign(agents, agents + count);
+
+    // Keep the agents for which the predicate is true, in order
+    const auto retain = [&active](auto predicate)
+    {
+        active.erase(std::remove_if(active.begin(), active.end(), [&](uint32_t agent) { return !predicate(agent); }), active.end());
+    };
+
+    switch (node.type)
+    {
+    case FlatBehaviorTree::NodeType::SEQUENCE:
+    {
+        // Whether every child of the agent was already successful, indexed by agent
+        scratch.flags.resize(m_results.size());
+        for (size_t i = 0; i < count; i++) scratch.flags[agents[i]] = 1;
+        for (uint32_t child = firstChild; child < node.subtreeEnd && !active.empty(); child = nodes[child].subtreeEnd)
+        {
+            group.clear();
+            for (const uint32_t agent : active)
+            {
+                if (m_contexts[agent].statuses[nodes[child].id] == Status::SUCCESS) continue;
+                scratch.flags[agent] = 0;
+                group.push_back(agent);
+            }
+            if (group.empty()) continue;
+
+            ExecuteNode(child, group.data(), group.size(), depth + 1);
+            // An agent stops at the first child that doesn't succeed, its result is the result of the child
+            retain([&](uint32_t agent) { return !std::binary_search(group.begin(), group.end(), agent) || m_results[agent] == Status::SUCCESS; });
+        }
+
+        for (const uint32_t agent : active)
+        {
+            if (scratch.flags[agent] != 0)
+            {
+                for (uint32_t child = firstChild; child < node.subtreeEnd; child = nodes[child].subtreeEnd)
+                {
+                    m_tree.ResetSubtree(child, m_contexts[agent]);
+                }
+            }
+            m_results[agent] = Status::SUCCESS;
+        }
+        break;
+    }
+    case FlatBehaviorTree::NodeType::SELECTOR:
+    {
+        for (uint32_t child = firstChild; child < node.subtreeEnd && !active.empty(); child = nodes[child].subtreeEnd)
+        {
+            group.assign(active.begin(), active.end());
+            ExecuteNode(child, group.data(), group.size(), depth + 1);
+
+            retain([&](uint32_t agent)
+            {
+                if (m_results[agent] == Status::FAILURE) return true;
+                for (uint32_t other = firstChild; other < node.subtreeEnd; other = nodes[other].subtreeEnd)
+                {
+                    if (other != child) m_tree.ResetSubtree(other, m_contexts[agent]);
+                }
+                return false;
+            });
+        }
+
+        for (const uint32_t agent : active) m_results[agent] = Status::FAILURE;
+        break;
+    }
+    case FlatBehaviorTree::NodeType::REPEATER:
+    {
+        for (int i = 0; i < node.numRepeats && !active.empty(); i++)
+        {
+            group.assign(active.begin(), active.end());
+            ExecuteNode(firstChild, group.data(), group.size(), depth + 1);
+
+            retain([&](uint32_t agent)
+            {
+                // Like Repeater::Tick this checks the status of the repeater itself
+                const Status status = m_contexts[agent].statuses[node.id];
+                if (status == Status::RUNNING || status == Status::FAILURE)
+                {
+                    m_results[agent] = status == Status::RUNNING ? Status::SUCCESS : Status::FAILURE;
+                    return false;
+                }
+                m_tree.ResetSubtree(firstChild, m_contexts[agent]);
+                return true;
+            });
+        }
+
+        for (const uint32_t agent : active) m_results[agent] = Status::SUCCESS;
+        break;
+    }
+    case FlatBehaviorTree::NodeType::INVERTER:
+        ExecuteNode(firstChild, agents, count, depth + 1);
+        for (const uint32_t agent : active)
+        {
+            const Status status = m_results[agent];
+            m_results[agent] = status == Status::FAILURE ? Status::SUCCESS : status == Status::SUCCESS ? Status::FAILURE : Status::INVALID;
+        }
+        break;
+
+    case FlatBehaviorTree::NodeType::ALWAYS_SUCCEED:
+        ExecuteNode(firstChild, agents, count, depth + 1);
+        for (const uint32_t agent : active) m_results[agent] = Status::SUCCESS;
+        break;
+
+    case FlatBehaviorTree::NodeType::UNTIL_FAIL:
+        ExecuteNode(firstChild, agents, count, depth + 1);
+        for (const uint32_t agent : active) m_results[agent] = m_results[agent] != Status::FAILURE ? Status::SUCCESS : Status::FAILURE;
+        break;
+
+    case FlatBehaviorTree::NodeType::COMPARISON:
+    {
+        m_comparisonBlackboards.resize(active.size());
+        m_comparisonResults.resize((active.size() + 63) / 64);
+        for (size_t i = 0; i < active.size(); i++)
+        {
+            m_comparisonBlackboards[i] = m_contexts[active[i]].blackboard.get();
+        }
+        node.comparator->EvaluateBatch(m_comparisonBlackboards.data(), active.size(), m_comparisonResults.data());
+
+        group.clear();
+        for (size_t i = 0; i < active.size(); i++)
+        {
+            const bool passes = (m_comparisonResults[i >> 6] >> (i & 63)) & 1;
+            if (passes != node.isNegation)
+            {
+                group.push_back(active[i]);
+            }
+            else
+            {
+                m_results[active[i]] = Status::FAILURE;
+            }
+        }
+
+        if (!group.empty())
+        {
+            ExecuteNode(firstChild, group.data(), group.size(), depth + 1);
+        }
+        break;
+    }
+    case FlatBehaviorTree::NodeType::LEAF:
+        break;
+    }
+
+    // Built-in behaviors have no Initialize and End, so their Execute only stores the status
+    for (size_t i = 0; i < count; i++)
+    {
+        m_contexts[agents[i]].statuses[node.id] = m_results[agents[i]];
+    }
+}
+
+void fluczakAI::BatchBehaviorTreeExecutor::ExecuteLeaf(const FlatBehaviorTree::Node& node, const uint32_t* agents, size_t count)
+{
+    if (node.action == nullptr)
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            m_results[agents[i]] = node.behavior->Execute(m_contexts[agents[i]]);
+        }
+        return;
+    }
+
+    // The steps of Behavior::Execute, each done for the whole group
+    m_leafContexts.resize(count);
+    m_leafResults.resize(count);
+    for (size_t i = 0; i < count; i++)
+    {
+        BehaviorTreeContext& context = m_contexts[agents[i]];
+        m_leafContexts[i] = &context;
+        if (context.statuses[node.id] != Status::RUNNING)
+        {
+            node.action->Initialize(context);
+        }
+    }
+
+    node.action->TickBatch({m_leafContexts.data(), count}, {m_leafResults.data(), count});
+
+    for (size_t i = 0; i < count; i++)
+    {
+        BehaviorTreeContext& context = m_contexts[agents[i]];
+        const Status status = m_leafResults[i];
+        if (status != Status::RUNNING)
+        {
+            node.action->End(context, status);
+        }
+        context.statuses[node.id] = status;
+        m_results[agents[i]] = status;
+    }
+}
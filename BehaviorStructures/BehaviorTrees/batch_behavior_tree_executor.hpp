@@ -0,0 +1,60 @@
+#pragma once
+#include <cstdint>
+#include <span>
+#include <vector>
+#include "flat_behavior_tree.hpp"
+
+namespace fluczakAI
+{
+/**
+ * \brief Executes one tree for many contexts at once. Instead of walking the whole tree for one agent after
+ * another, the agents are advanced together node by node: all agents that reach a node are executed as a
+ * group, so composites run in tight loops over the group, comparisons evaluate the whole group with
+ * IComparator::EvaluateBatch and actions tick it with BehaviorTreeAction::TickBatch.
+ * Every agent goes through the same behaviors in the same order as with FlatBehaviorTree::Execute, only the
+ * agents are interleaved, so their contexts must not share state that the behaviors modify.
+ * An executor keeps scratch memory between calls and can't be used by multiple threads at once.
+ */
+class BatchBehaviorTreeExecutor
+{
+public:
+    /**
+     * \param tree - the tree to execute, it has to outlive the executor
+     */
+    explicit BatchBehaviorTreeExecutor(const FlatBehaviorTree& tree) : m_tree(tree) {}
+
+    /**
+     * \brief Execute the tree for a span of contexts
+     * \param contexts - the contexts to execute the tree for
+     * \param results - optional, empty or the status of the root for every context
+     */
+    void Execute(std::span<BehaviorTreeContext> contexts, std::span<Status> results = {});
+
+private:
+    /**
+     * \brief The memory used while executing a node at a given depth of the tree
+     */
+    struct Scratch
+    {
+        std::vector<uint32_t> active{};
+        std::vector<uint32_t> group{};
+        std::vector<uint8_t> flags{};
+    };
+
+    /**
+     * \brief Execute a node for a group of agents, the status of every agent is written to m_results
+     */
+    void ExecuteNode(uint32_t index, const uint32_t* agents, size_t count, size_t depth);
+    void ExecuteLeaf(const FlatBehaviorTree::Node& node, const uint32_t* agents, size_t count);
+
+    const FlatBehaviorTree& m_tree;
+    BehaviorTreeContext* m_contexts = nullptr;
+    std::vector<Status> m_results{};
+    std::vector<Scratch> m_scratch{};
+    std::vector<uint32_t> m_agents{};
+    std::vector<BehaviorTreeContext*> m_leafContexts{};
+    std::vector<Status> m_leafResults{};
+    std::vector<const Blackboard*> m_comparisonBlackboards{};
+    std::vector<uint64_t> m_comparisonResults{};
+};
+}
@@ -1,15 +1,105 @@
 #include "behavior_tree.hpp"
 #include "behavior_tree_builder.hpp"
+#include "behavior_tree_cache.hpp"
 #include "../Serialization/editor_variables.hpp"
 #include "behaviors.hpp"
 #include "../Serialization/generic_factory.hpp"
 #include "behaviors.hpp"
+#include <cstdlib>
+#if defined(__GNUG__)
+#include <cxxabi.h>
+#endif
 
 void fluczakAI::BehaviorTree::Execute(fluczakAI::BehaviorTreeContext& context) const
 {
+    if (context.statuses.Size() < m_nodeCount)
+    {
+        context.statuses.Resize(m_nodeCount);
+    }
+
     m_root->Execute(context);
 }
 
+void fluczakAI::BehaviorTree::InitializeContext(BehaviorTreeContext& context) const
+{
+    context.statuses.Resize(m_nodeCount);
+    context.statuses.Clear();
+    context.coroutines.Clear();
+}
+
+size_t fluczakAI::BehaviorTree::CountNodes(const Behavior* behavior)
+{
+    if (behavior == nullptr) return 0;
+
+    size_t count = static_cast<size_t>(behavior->GetId() + 1);
+
+    if (const auto subtreeRef = dynamic_cast<const SubtreeRef*>(behavior))
+    {
+        count = static_cast<size_t>(subtreeRef->GetId()) + subtreeRef->GetNodeCount();
+    }
+    else if (const auto composite = dynamic_cast<const Composite*>(behavior))
+    {
+        for (const auto& child : composite->GetChildren())
+        {
+            count = std::max(count, CountNodes(child.get()));
+        }
+    }
+    else if (const auto decorator = dynamic_cast<const Decorator*>(behavior))
+    {
+        count = std::max(count, CountNodes(decorator->GetChild().get()));
+    }
+
+    return count;
+}
+
+bool fluczakAI::BehaviorTree::ReferencesSubtrees(const Behavior* behavior)
+{
+    if (behavior == nullptr) return false;
+    if (dynamic_cast<const SubtreeRef*>(behavior) != nullptr) return true;
+
+    if (const auto composite = dynamic_cast<const Composite*>(behavior))
+    {
+        for (const auto& child : composite->GetChildren())
+        {
+            if (ReferencesSubtrees(child.get())) return true;
+        }
+    }
+    else if (const auto decorator = dynamic_cast<const Decorator*>(behavior))
+    {
+        return ReferencesSubtrees(decorator->GetChild().get());
+    }
+
+    return false;
+}
+
+bool fluczakAI::BehaviorTree::FindEagerResets(Behavior* behavior)
+{
+    if (behavior == nullptr) return false;
+
+    if (const auto composite = dynamic_cast<Composite*>(behavior))
+    {
+        bool hasEagerReset = false;
+        for (const auto& child : composite->GetChildren())
+        {
+            // Every child is visited, the ones after an eager child may have composites to mark as well
+            hasEagerReset = FindEagerResets(child.get()) || hasEagerReset;
+        }
+        composite->SetEagerReset(hasEagerReset);
+    }
+    else if (const auto decorator = dynamic_cast<Decorator*>(behavior))
+    {
+        decorator->SetEagerReset(FindEagerResets(decorator->GetChild().get()));
+    }
+
+    return behavior->HasEagerReset();
+}
+
+void fluczakAI::BehaviorTree::BindLayout(const BlackboardLayout& layout)
+{
+    if (m_root == nullptr) return;
+    m_root->BindLayout(layout);
+}
+
 #if defined(NLOHMANN_JSON_VERSION_MAJOR)
 
 void fluczakAI::BehaviorTree::SerializeBehavior(nlohmann::json& json, const std::unique_ptr<Behavior>& behavior)
@@ -19,6 +109,14 @@ void fluczakAI::BehaviorTree::SerializeBehavior(nlohmann::json& json, const std:
 
     auto name = std::string(typeid(*behavior).name());
 
+#if defined(__GNUG__)
+    // GCC and Clang name types by their mangled names
+    int demangleStatus = 0;
+    char* demangled = abi::__cxa_demangle(name.c_str(), nullptr, nullptr, &demangleStatus);
+    if (demangleStatus == 0) name = demangled;
+    std::free(demangled);
+#endif
+
     size_t pos = name.find('<');
 
     if (pos != std::string::npos)
@@ -32,10 +130,11 @@ void fluczakAI::BehaviorTree::SerializeBehavior(nlohmann::json& json, const std:
         name.erase(i, 5);
     }
 
-    i = name.find("AI::");
+    // Behaviors are deserialized by their names without the namespace
+    i = name.rfind("::");
     if (i != std::string::npos)
     {
-        name.erase(i, 4);
+        name.erase(0, i + 2);
     }
 
     const auto action = dynamic_cast<const fluczakAI::BehaviorTreeAction*>(behavior.get());
@@ -57,6 +156,26 @@ void fluczakAI::BehaviorTree::SerializeBehavior(nlohmann::json& json, const std:
         }
     }
 
+    // A shared subtree is stored once, references only keep its name
+    if (const auto subtreeRef = dynamic_cast<const SubtreeRef*>(behavior.get()))
+    {
+        node["name"] = "SubtreeRef";
+        node["subtree"] = subtreeRef->GetName();
+    }
+
+    const auto selector = dynamic_cast<const Selector*>(behavior.get());
+    if (selector != nullptr && selector->IsInterrupting())
+    {
+        node["interrupting"] = true;
+    }
+
+    const auto parallel = dynamic_cast<const Parallel*>(behavior.get());
+    if (parallel != nullptr)
+    {
+        node["success-threshold"] = parallel->GetSuccessThreshold();
+        node["failure-threshold"] = parallel->GetFailureThreshold();
+    }
+
     const auto composite = dynamic_cast<const Composite*>(behavior.get());
     const auto decorator = dynamic_cast<const Decorator*>(behavior.get());
     if (composite != nullptr)
@@ -77,7 +196,7 @@ void fluczakAI::BehaviorTree::SerializeBehavior(nlohmann::json& json, const std:
     json["children"] = children;
 }
 
-void fluczakAI::BehaviorTree::DeserializeAction(std::string& actionName,const nlohmann::json& variables,BehaviorTreeBuilder& builder) const
+void fluczakAI::BehaviorTree::DeserializeAction(std::string& actionName,const nlohmann::json& variables,BehaviorTreeBuilder& builder)
 {
     actionName.erase(std::remove_if(actionName.begin(), actionName.end(),
         [](unsigned char c) { return std::isspace(c); }),
@@ -86,7 +205,7 @@ void fluczakAI::BehaviorTree::DeserializeAction(std::string& actionName,const nl
 	auto temp = GenericFactory<fluczakAI::BehaviorTreeAction>::Instance().CreateProduct(actionName);
     if (temp != nullptr)
     {
-        temp->SetId(builder.GetId()+1);
+        temp->SetId(builder.NextId());
 
         for (auto variable : variables)
         {
@@ -98,7 +217,10 @@ void fluczakAI::BehaviorTree::DeserializeAction(std::string& actionName,const nl
         return;
     }
 
-    builder.AddBehavior(std::make_unique<BehaviorTreeAction>());
+    if (m_error.empty()) m_error = "action " + actionName + " is not registered";
+    auto placeholder = std::make_unique<BehaviorTreeAction>();
+    placeholder->SetId(builder.NextId());
+    builder.AddBehavior(std::move(placeholder));
 }
 
 nlohmann::json fluczakAI::BehaviorTree::Serialize()
@@ -118,7 +240,7 @@ nlohmann::json fluczakAI::BehaviorTree::Serialize()
     stream >> value;                            \
     builder.Comparison(fluczakAI::Comparator<type>(comparisonKey, static_cast<ComparisonType>(comparisonType), value));
 
-void fluczakAI::BehaviorTree::DeserializeBehavior(const nlohmann::json& json, BehaviorTreeBuilder& builder)
+void fluczakAI::BehaviorTree::DeserializeBehavior(const nlohmann::json& json, BehaviorTreeBuilder& builder, const BehaviorTreeCache* library)
 {
     std::string name = json.at("name").get<std::string>();
     name.erase(std::remove_if(name.begin(), name.end(), isspace), name.end());
@@ -129,12 +251,16 @@ void fluczakAI::BehaviorTree::DeserializeBehavior(const nlohmann::json& json, Be
 
     if (name == "Selector")
     {
-        builder.Selector();
+        builder.Selector(json.value("interrupting", false));
     }
     if (name == "Sequence")
     {
         builder.Sequence();
     }
+    if (name == "Parallel")
+    {
+        builder.Parallel(json.value("success-threshold", 0), json.value("failure-threshold", 1));
+    }
     if (name == "Repeater")
     {
         int numRepeats = json["num-repeats"];
@@ -193,10 +319,27 @@ void fluczakAI::BehaviorTree::DeserializeBehavior(const nlohmann::json& json, Be
         std::string actionName = json["type"];
         DeserializeAction(actionName, json["editor-variables"],builder);
     }
+    if (name.find("SubtreeRef") != std::string::npos)
+    {
+        const std::string subtreeName = json["subtree"];
+        auto subtree = library != nullptr ? library->Find(subtreeName) : nullptr;
+        if (subtree != nullptr)
+        {
+            builder.Subtree(subtreeName, std::move(subtree));
+        }
+        else
+        {
+            // Like an unknown action, a missing subtree leaves a placeholder so the rest of the tree keeps its shape
+            if (m_error.empty()) m_error = "subtree " + subtreeName + " is not in the cache";
+            auto placeholder = std::make_unique<BehaviorTreeAction>();
+            placeholder->SetId(builder.NextId());
+            builder.AddBehavior(std::move(placeholder));
+        }
+    }
 
     for (int i = 0; i < numChildren; i++)
     {
-        DeserializeBehavior(children[i],builder);
+        DeserializeBehavior(children[i],builder,library);
     }
 
     if (builder.GetNodeStack().empty()) return;
@@ -204,15 +347,33 @@ void fluczakAI::BehaviorTree::DeserializeBehavior(const nlohmann::json& json, Be
 }
 
 void fluczakAI::BehaviorTree::Deserialize(nlohmann::json& json)
+{
+    Deserialize(json, nullptr);
+}
+
+void fluczakAI::BehaviorTree::Deserialize(nlohmann::json& json, const BehaviorTreeCache& library)
+{
+    Deserialize(json, &library);
+}
+
+void fluczakAI::BehaviorTree::Deserialize(nlohmann::json& json, const BehaviorTreeCache* library)
 {
     std::string version = json["version"];
+    m_error.clear();
     BehaviorTreeBuilder builder;
     if (json["behavior-structure-type"].get<std::string>() != "BehaviorTree") return;
     if (!json.contains("children")) return;
     const auto toDeserialize = json.at("children")[0];
-    DeserializeBehavior(toDeserialize,builder);
+    DeserializeBehavior(toDeserialize,builder,library);
     const std::unique_ptr<BehaviorTree> newTree = builder.End();
     m_root.swap(newTree->GetRoot());
+    m_nodeCount = newTree->GetNodeCount();
+}
+
+void fluczakAI::BehaviorTree::Deserialize(nlohmann::json& json, const BlackboardLayout& layout)
+{
+    Deserialize(json);
+    BindLayout(layout);
 }
 #endif
 
@@ -220,4 +381,13 @@ void fluczakAI::BehaviorTree::Deserialize(nlohmann::json& json)
 fluczakAI::BehaviorTree::BehaviorTree(std::unique_ptr<Behavior>& rootToSet)
 {
     m_root.swap(rootToSet);
+    // Trees assembled by hand can use any ids, so the count is derived from the highest one
+    m_nodeCount = CountNodes(m_root.get());
+    FindEagerResets(m_root.get());
+}
+
+fluczakAI::BehaviorTree::BehaviorTree(std::unique_ptr<Behavior>& rootToSet, size_t nodeCount) : m_nodeCount(nodeCount)
+{
+    m_root.swap(rootToSet);
+    FindEagerResets(m_root.get());
 }
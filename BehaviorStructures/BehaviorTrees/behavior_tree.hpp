@@ -1,5 +1,6 @@
 #pragma once
 #include <memory>
+#include <string>
 #include "behaviors.hpp"
 #include "behavior_tree_builder.hpp"
 #include "../Serialization/iserializable.hpp"
@@ -11,10 +12,17 @@ namespace fluczakAI
  * behavior tree execution context.
  */
     class BehaviorTreeBuilder;
+    class BehaviorTreeCache;
 class BehaviorTree : public ISerializable
     {
     public:
         BehaviorTree(std::unique_ptr<Behavior>& rootToSet);
+        /**
+         * \brief Create a tree whose behaviors are numbered 0..nodeCount-1
+         * \param rootToSet - the root of the tree
+         * \param nodeCount - the number of behaviors in the tree
+         */
+        BehaviorTree(std::unique_ptr<Behavior>& rootToSet, size_t nodeCount);
         /**
          * \brief This function executes its children based on their behaviors.
          * \param context - A behavior tree execution context
@@ -25,17 +33,94 @@ class BehaviorTree : public ISerializable
          * \return - a pointer to the root behavior
          */
         std::unique_ptr<Behavior>& GetRoot()  { return m_root; }
+        const std::unique_ptr<Behavior>& GetRoot() const { return m_root; }
+
+        /**
+         * \brief A getter for the number of statuses a context needs to execute the tree, one past the highest
+         * behavior id
+         */
+        size_t GetNodeCount() const { return m_nodeCount; }
+
+        /**
+         * \brief Presize the statuses of a context for this tree and set them to INVALID, destroying the frames of
+         * its coroutine actions
+         * \param context - A behavior tree execution context
+         */
+        void InitializeContext(BehaviorTreeContext& context) const;
+
+        /**
+         * \brief Resolve the blackboard keys used by the tree to the slots of a given layout, so blackboards
+         * using that layout are read at constant offsets
+         * \param layout - the layout of the blackboards the tree is going to be executed with
+         */
+        void BindLayout(const BlackboardLayout& layout);
 
 #if defined(NLOHMANN_JSON_VERSION_MAJOR)
         static void SerializeBehavior(nlohmann::json& json, const std::unique_ptr<Behavior>& behavior);
         nlohmann::json Serialize() override;
 
-        void DeserializeBehavior(const nlohmann::json& json, BehaviorTreeBuilder& builder);
-        void DeserializeAction(std::string& actionName, const nlohmann::json& variables, BehaviorTreeBuilder& builder) const;
+        /**
+         * \brief Add a serialized behavior and its children to a builder
+         * \param library - the cache the shared trees of SubtreeRefs are found in, by name. A reference to a tree
+         * that isn't found becomes a placeholder action, see GetError.
+         */
+        void DeserializeBehavior(const nlohmann::json& json, BehaviorTreeBuilder& builder, const BehaviorTreeCache* library = nullptr);
+        /**
+         * \brief Add a serialized action to a builder. An action that isn't registered in the GenericFactory
+         * becomes a placeholder action, see GetError.
+         */
+        void DeserializeAction(std::string& actionName, const nlohmann::json& variables, BehaviorTreeBuilder& builder);
+        /**
+         * \brief Deserialize the tree. There is no cache to find the shared trees in, so every SubtreeRef becomes a
+         * placeholder action, see GetError.
+         */
         void Deserialize(nlohmann::json& json) override;
+        /**
+         * \brief Deserialize the tree and resolve its blackboard keys against a given layout
+         */
+        void Deserialize(nlohmann::json& json, const BlackboardLayout& layout);
+        /**
+         * \brief Deserialize the tree, finding the shared trees referenced by its SubtreeRefs in a given cache
+         */
+        void Deserialize(nlohmann::json& json, const BehaviorTreeCache& library);
+
+        /**
+         * \brief Get why the last Deserialize had to put a placeholder action in place of a behavior, e.g. an action
+         * that isn't registered or a subtree that isn't in the cache. The placeholder does nothing, so the tree
+         * doesn't behave as it was serialized.
+         * \return - the first problem found, empty if the tree was deserialized as it was serialized
+         */
+        const std::string& GetError() const { return m_error; }
 #endif
+        /**
+         * \brief Get the number of statuses needed to execute a behavior and its children, one past the highest id
+         * among them
+         * \param behavior - the behavior to count from
+         */
+        static size_t CountNodes(const Behavior* behavior);
+
+        /**
+         * \brief Whether or not a behavior or any of its children is a SubtreeRef
+         * \param behavior - the behavior to check from
+         */
+        static bool ReferencesSubtrees(const Behavior* behavior);
+
+        /**
+         * \brief Mark the composites and decorators that have a behavior with an eager reset below them, so they
+         * reset their children right away, see Behavior::HasEagerReset. Called when a tree is created.
+         * \param behavior - the behavior to mark from
+         * \return - whether the behavior has an eager reset
+         */
+        static bool FindEagerResets(Behavior* behavior);
+
     private:
+#if defined(NLOHMANN_JSON_VERSION_MAJOR)
+        void Deserialize(nlohmann::json& json, const BehaviorTreeCache* library);
+#endif
+
         std::unique_ptr<Behavior> m_root = {};
+        size_t m_nodeCount = 0;
+        std::string m_error{};
 
 
     };
@@ -4,9 +4,9 @@
 #include "behaviors.hpp"
 
 
-fluczakAI::BehaviorTreeBuilder& fluczakAI::BehaviorTreeBuilder::Selector()
+fluczakAI::BehaviorTreeBuilder& fluczakAI::BehaviorTreeBuilder::Selector(bool isInterrupting)
 {
-    auto temp = std::make_unique<fluczakAI::Selector>(id++);
+    auto temp = std::make_unique<fluczakAI::Selector>(id++, isInterrupting);
     AddBehavior(std::move(temp));
     return *this;
 }
@@ -33,6 +33,13 @@ fluczakAI::BehaviorTreeBuilder& fluczakAI::BehaviorTreeBuilder::Sequence()
     return *this;
 }
 
+fluczakAI::BehaviorTreeBuilder& fluczakAI::BehaviorTreeBuilder::Parallel(int successThreshold, int failureThreshold)
+{
+    auto temp = std::make_unique<fluczakAI::Parallel>(id++, successThreshold, failureThreshold);
+    AddBehavior(std::move(temp));
+    return *this;
+}
+
 fluczakAI::BehaviorTreeBuilder& fluczakAI::BehaviorTreeBuilder::Repeater(int numRepeats)
 {
     auto temp = std::make_unique<fluczakAI::Repeater>(id++, numRepeats);
@@ -61,6 +68,14 @@ fluczakAI::BehaviorTreeBuilder& fluczakAI::BehaviorTreeBuilder::UntilFail()
     return *this;
 }
 
+fluczakAI::BehaviorTreeBuilder& fluczakAI::BehaviorTreeBuilder::Subtree(const std::string& name, std::shared_ptr<const BehaviorTree> subtree)
+{
+    auto temp = std::make_unique<fluczakAI::SubtreeRef>(id, name, std::move(subtree));
+    id += static_cast<int>(temp->GetNodeCount());
+    AddBehavior(std::move(temp));
+    return *this;
+}
+
 fluczakAI::BehaviorTreeBuilder& fluczakAI::BehaviorTreeBuilder::Back()
 {
     m_nodeStack.pop();
@@ -69,6 +84,6 @@ fluczakAI::BehaviorTreeBuilder& fluczakAI::BehaviorTreeBuilder::Back()
 
 std::unique_ptr<fluczakAI::BehaviorTree> fluczakAI::BehaviorTreeBuilder::End()
 {
-    auto behavior_tree = std::make_unique<fluczakAI::BehaviorTree>(m_treeRoot);
+    auto behavior_tree = std::make_unique<fluczakAI::BehaviorTree>(m_treeRoot, static_cast<size_t>(id));
     return std::move(behavior_tree);
 }
@@ -37,9 +37,10 @@ public:
     /**
      * \brief Add a selector to the behavior tree (a child of previously created behavior or the last
      * behavior that was lead to by Back())
+     * \param isInterrupting - whether or not children before a running child are checked again when resuming
      * \return - Behavior tree builder
      */
-   BehaviorTreeBuilder& Selector();
+   BehaviorTreeBuilder& Selector(bool isInterrupting = false);
 
     /**
      * \brief Add a sequence to the behavior tree (a child of previously created behavior or the last
@@ -48,6 +49,15 @@ public:
      */
    BehaviorTreeBuilder& Sequence();
 
+    /**
+     * \brief Add a parallel to the behavior tree (a child of previously created behavior or the last
+     * behavior that was lead to by Back())
+     * \param successThreshold - number of children that have to succeed, 0 or less for all of them
+     * \param failureThreshold - number of children that have to fail, 0 or less for all of them
+     * \return - Behavior tree builder
+     */
+   BehaviorTreeBuilder& Parallel(int successThreshold = 0, int failureThreshold = 1);
+
     /**
      * \brief  Add a Repeater to the behavior tree (a child of previously created behavior)
      * \param numRepeats - number of times the behavior is executed
@@ -73,7 +83,16 @@ public:
      */
    BehaviorTreeBuilder& UntilFail();
 
-    
+    /**
+     * \brief Add a reference to a shared tree to the behavior tree (a child of previously created behavior or the
+     * last behavior that was lead to by Back()). The ids of the shared tree are reserved after the id of the
+     * reference, so every reference has its own statuses.
+     * \param name - the name the shared tree is serialized with, e.g. its name in a BehaviorTreeCache
+     * \param subtree - the shared tree
+     * \return - Behavior tree builder
+     */
+   BehaviorTreeBuilder& Subtree(const std::string& name, std::shared_ptr<const BehaviorTree> subtree);
+
     /**
      * \brief- Back out to the previously created behavior tree node
      * \return - Behavior tree builder
@@ -86,6 +105,11 @@ public:
      */
     std::unique_ptr<BehaviorTree> End();
     int GetId() const { return id; }
+    /**
+     * \brief Reserve the id of the next behavior. Ids are handed out in preorder as 0..N-1.
+     * \return - the reserved id
+     */
+    int NextId() { return id++; }
     void AddBehavior(std::unique_ptr<fluczakAI::Behavior> behavior);
     const std::stack<fluczakAI::Behavior*>& GetNodeStack() { return m_nodeStack; }
 private:
@@ -100,6 +124,7 @@ BehaviorTreeBuilder& BehaviorTreeBuilder::Action(Args... args)
 {
     auto temp = std::make_unique<T>(args...);
     dynamic_cast<fluczakAI::BehaviorTreeAction*>(temp.get())->SetId(id++);
+    fluczakAI::BehaviorTreeAction::OnCreated(*temp);
     AddBehavior(std::move(temp));
     return *this;
 }
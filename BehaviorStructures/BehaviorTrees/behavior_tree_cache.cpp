@@ -0,0 +1,254 @@
+#include "behavior_tree_cache.hpp"
+#include <algorithm>
+#include <cassert>
+#include <cctype>
+#include <fstream>
+#include <sstream>
+#include "../Serialization/generic_factory.hpp"
+
+#if defined(NLOHMANN_JSON_VERSION_MAJOR)
+namespace
+{
+    /**
+     * \brief Check a behavior and its children the way BehaviorTree::DeserializeBehavior reads them
+     */
+    bool ValidateBehavior(const nlohmann::json& json, std::string& error, const fluczakAI::BehaviorTreeCache* library)
+    {
+        if (!json.is_object() || !json.contains("name") || !json["name"].is_string())
+        {
+            error = "a behavior has no name";
+            return false;
+        }
+
+        std::string name = json["name"].get<std::string>();
+        name.erase(std::remove_if(name.begin(), name.end(), [](unsigned char c) { return std::isspace(c); }), name.end());
+
+        if (!json.contains("children") || !json["children"].is_array())
+        {
+            error = name + " has no children array";
+            return false;
+        }
+        const size_t numChildren = json["children"].size();
+
+        const bool isComparison = name.find("Comparison") != std::string::npos;
+        const bool isDecorator = isComparison || name == "Repeater" || name == "Inverter" || name == "AlwaysSucceed" || name == "UntilFail";
+
+        if (name == "Action")
+        {
+            if (!json.contains("type") || !json["type"].is_string())
+            {
+                error = "an action has no type";
+                return false;
+            }
+
+            std::string type = json["type"].get<std::string>();
+            type.erase(std::remove_if(type.begin(), type.end(), [](unsigned char c) { return std::isspace(c); }), type.end());
+            if (!fluczakAI::GenericFactory<fluczakAI::BehaviorTreeAction>::Instance().HasProduct(type))
+            {
+                error = "action " + type + " is not registered";
+                return false;
+            }
+
+            if (!json.contains("editor-variables") || !(json["editor-variables"].is_null() || json["editor-variables"].is_array()))
+            {
+                error = "the editor variables of " + type + " aren't an array";
+                return false;
+            }
+            // Iterating a null json visits nothing
+            for (const auto& variable : json["editor-variables"])
+            {
+                if (!variable.is_object() || !variable.contains("name") || !variable["name"].is_string() ||
+                    !variable.contains("value") || !variable["value"].is_string())
+                {
+                    error = "an editor variable of " + type + " has no name or value";
+                    return false;
+                }
+            }
+        }
+        else if (name.find("SubtreeRef") != std::string::npos)
+        {
+            if (!json.contains("subtree") || !json["subtree"].is_string())
+            {
+                error = "a subtree reference has no subtree";
+                return false;
+            }
+            if (library != nullptr && library->Find(json["subtree"].get<std::string>()) == nullptr)
+            {
+                error = "subtree " + json["subtree"].get<std::string>() + " is not in the cache";
+                return false;
+            }
+        }
+        else if (name == "Repeater")
+        {
+            if (!json.contains("num-repeats") || !json["num-repeats"].is_number_integer())
+            {
+                error = "a repeater has no number of repeats";
+                return false;
+            }
+        }
+        else if (isComparison)
+        {
+            if (!json.contains("comparator"))
+            {
+                error = "a comparison has no comparator";
+                return false;
+            }
+
+            std::stringstream stream(json["comparator"].dump());
+            std::string key;
+            std::string typeName;
+            int comparisonType = 0;
+            stream >> key >> typeName >> comparisonType;
+            const bool isKnownType = typeName == "float" || typeName == "double" || typeName == "bool" || typeName == "int" ||
+                typeName.find("string") != std::string::npos;
+            if (!stream || !isKnownType)
+            {
+                error = "comparator " + json["comparator"].dump() + " can't be read";
+                return false;
+            }
+        }
+        else if (!isDecorator && name != "Selector" && name != "Sequence" && name != "Parallel")
+        {
+            error = "unknown behavior " + name;
+            return false;
+        }
+
+        if (isDecorator && numChildren != 1)
+        {
+            error = name + " needs exactly one child";
+            return false;
+        }
+        if ((name == "Action" || name.find("SubtreeRef") != std::string::npos) && numChildren != 0)
+        {
+            error = name + " can't have children";
+            return false;
+        }
+
+        for (const auto& child : json["children"])
+        {
+            if (!ValidateBehavior(child, error, library)) return false;
+        }
+        return true;
+    }
+}
+
+bool fluczakAI::BehaviorTreeCache::Validate(const nlohmann::json& json, std::string& error, const BehaviorTreeCache* library)
+{
+    if (!json.is_object() || json.value("behavior-structure-type", "") != "BehaviorTree")
+    {
+        error = "not a behavior tree";
+        return false;
+    }
+    if (!json.contains("version") || !json["version"].is_string())
+    {
+        error = "the tree has no version";
+        return false;
+    }
+    if (!json.contains("children") || !json["children"].is_array() || json["children"].size() != 1)
+    {
+        error = "the tree needs exactly one root";
+        return false;
+    }
+
+    return ValidateBehavior(json["children"][0], error, library);
+}
+
+std::shared_ptr<const fluczakAI::BehaviorTree> fluczakAI::BehaviorTreeCache::Add(const std::string& name, const nlohmann::json& json)
+{
+    std::shared_ptr<const BehaviorTree> prototype = Build(name, json);
+    if (prototype == nullptr) return nullptr;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_trees[name] = prototype;
+    return prototype;
+}
+
+std::shared_ptr<const fluczakAI::BehaviorTree> fluczakAI::BehaviorTreeCache::Load(const std::string& path)
+{
+    if (auto prototype = Find(path)) return prototype;
+
+    std::ifstream input(path);
+    const nlohmann::json json = input ? nlohmann::json::parse(input, nullptr, false) : nlohmann::json();
+    if (!input || json.is_discarded())
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_error = path + ": can't be read";
+        return nullptr;
+    }
+
+    std::shared_ptr<const BehaviorTree> prototype = Build(path, json);
+    if (prototype == nullptr) return nullptr;
+
+    // Another thread may have loaded the same file in the meantime, its tree is kept so there is one prototype
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_trees.emplace(path, std::move(prototype)).first->second;
+}
+
+std::unique_ptr<fluczakAI::BehaviorTree> fluczakAI::BehaviorTreeCache::Build(const std::string& name, const nlohmann::json& json)
+{
+    std::string error;
+    if (!Validate(json, error, this))
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_error = name + ": " + error;
+        return nullptr;
+    }
+
+    // Deserialize takes the json by reference
+    nlohmann::json copy = json;
+    std::unique_ptr<Behavior> root;
+    auto tree = std::make_unique<BehaviorTree>(root);
+    tree->Deserialize(copy, *this);
+    if (m_layout != nullptr) tree->BindLayout(*m_layout);
+    return tree;
+}
+#endif
+
+std::shared_ptr<const fluczakAI::BehaviorTree> fluczakAI::BehaviorTreeCache::Add(const std::string& name, std::unique_ptr<BehaviorTree> tree)
+{
+    assert(tree != nullptr);
+    if (m_layout != nullptr) tree->BindLayout(*m_layout);
+
+    std::shared_ptr<const BehaviorTree> prototype = std::move(tree);
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_trees[name] = prototype;
+    return prototype;
+}
+
+std::shared_ptr<const fluczakAI::BehaviorTree> fluczakAI::BehaviorTreeCache::Find(const std::string& name) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const auto it = m_trees.find(name);
+    return it != m_trees.end() ? it->second : nullptr;
+}
+
+std::shared_ptr<const fluczakAI::BehaviorTree> fluczakAI::BehaviorTreeCache::Instantiate(const std::string& name, BehaviorTreeContext& context) const
+{
+    auto tree = Find(name);
+    if (tree != nullptr) tree->InitializeContext(context);
+    return tree;
+}
+
+bool fluczakAI::BehaviorTreeCache::Remove(const std::string& name)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_trees.erase(name) != 0;
+}
+
+void fluczakAI::BehaviorTreeCache::Clear()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_trees.clear();
+}
+
+size_t fluczakAI::BehaviorTreeCache::Size() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_trees.size();
+}
+
+std::string fluczakAI::BehaviorTreeCache::GetError() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_error;
+}
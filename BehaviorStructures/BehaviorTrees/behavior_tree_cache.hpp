@@ -0,0 +1,112 @@
+#pragma once
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include "behavior_tree.hpp"
+
+namespace fluczakAI
+{
+/**
+ * \brief Keeps the behavior trees of a game as shared, immutable prototypes, so a tree asset is deserialized and
+ * validated once instead of once per agent. Executing a tree only changes the context it is executed with, as
+ * long as its actions keep the state of an agent there and not in their members, see BehaviorTreeAction, so
+ * any number of agents can share a prototype: instancing an agent costs a context, not a copy of the tree, its
+ * actions and their editor variables. Contexts of a prototype can also be recycled with a ContextPool created
+ * from it, and a FlatBehaviorTree can be built from it. The cache is also the library of the subtrees shared with
+ * SubtreeRef: a tree is referenced by its name in the cache, and the trees added from json find their references
+ * there.
+ * Replacing or removing a tree doesn't affect the agents already executing it, they keep the old prototype alive
+ * until they let go of it. All functions are safe to call from multiple threads.
+ */
+class BehaviorTreeCache
+{
+public:
+    BehaviorTreeCache() = default;
+
+    /**
+     * \param layout - the layout the blackboard keys of the added trees are resolved against, see
+     * BehaviorTree::BindLayout. It has to outlive the cache and the trees.
+     */
+    explicit BehaviorTreeCache(const BlackboardLayout& layout) : m_layout(&layout) {}
+
+    BehaviorTreeCache(const BehaviorTreeCache&) = delete;
+    BehaviorTreeCache& operator=(const BehaviorTreeCache&) = delete;
+
+    /**
+     * \brief Make a tree the prototype of a given name, replacing the previous one
+     * \param name - the name the tree is found by
+     * \param tree - the tree, it must not be changed afterwards
+     * \return - the prototype
+     */
+    std::shared_ptr<const BehaviorTree> Add(const std::string& name, std::unique_ptr<BehaviorTree> tree);
+
+#if defined(NLOHMANN_JSON_VERSION_MAJOR)
+    /**
+     * \brief Validate and deserialize a tree and make it the prototype of a given name, replacing the previous one.
+     * The subtrees it references with SubtreeRef are found in this cache, so they have to be added first.
+     * \param name - the name the tree is found by
+     * \param json - the output of BehaviorTree::Serialize
+     * \return - the prototype, null if the json isn't a valid tree, see GetError
+     */
+    std::shared_ptr<const BehaviorTree> Add(const std::string& name, const nlohmann::json& json);
+
+    /**
+     * \brief Get the prototype of a tree file, loading it the first time. The subtrees it references with SubtreeRef
+     * are found in this cache, so they have to be added or loaded first.
+     * \param path - path to a file written from BehaviorTree::Serialize, also the name the tree is found by
+     * \return - the prototype, null if the file can't be read or isn't a valid tree, see GetError
+     */
+    std::shared_ptr<const BehaviorTree> Load(const std::string& path);
+
+    /**
+     * \brief Check that a json describes a tree BehaviorTree::Deserialize can build as it was serialized: all the
+     * behaviors are known, their actions are registered in the GenericFactory, and decorators and comparisons
+     * have a single child
+     * \param json - the output of BehaviorTree::Serialize
+     * \param error - set to the first problem found
+     * \param library - the cache the subtrees referenced by the tree have to be in, they aren't checked if null
+     * \return - whether the tree is valid
+     */
+    static bool Validate(const nlohmann::json& json, std::string& error, const BehaviorTreeCache* library = nullptr);
+#endif
+
+    /**
+     * \brief Get the prototype of a given name
+     * \return - the prototype, null if there is no tree of that name
+     */
+    std::shared_ptr<const BehaviorTree> Find(const std::string& name) const;
+
+    /**
+     * \brief Prepare the context of a new agent executing the tree of a given name
+     * \param name - the name of the tree
+     * \param context - the context of the agent, initialized with BehaviorTree::InitializeContext
+     * \return - the prototype the agent has to be executed with, null if there is no tree of that name
+     */
+    std::shared_ptr<const BehaviorTree> Instantiate(const std::string& name, BehaviorTreeContext& context) const;
+
+    /**
+     * \brief Remove the prototype of a given name from the cache
+     * \return - whether there was a tree of that name
+     */
+    bool Remove(const std::string& name);
+
+    void Clear();
+    size_t Size() const;
+
+    /**
+     * \brief Get the reason the last Add or Load failed
+     */
+    std::string GetError() const;
+
+private:
+#if defined(NLOHMANN_JSON_VERSION_MAJOR)
+    std::unique_ptr<BehaviorTree> Build(const std::string& name, const nlohmann::json& json);
+#endif
+
+    mutable std::mutex m_mutex{};
+    std::unordered_map<std::string, std::shared_ptr<const BehaviorTree>> m_trees{};
+    const BlackboardLayout* m_layout = nullptr;
+    std::string m_error{};
+};
+}
@@ -1,4 +1,6 @@
 #include "behaviors.hpp"
+#include "behavior_tree.hpp"
+#include "../Scheduling/thread_pool.hpp"
 
 
 
@@ -9,13 +11,13 @@ void fluczakAI::Behavior::Reset(fluczakAI::BehaviorTreeContext& context)
 
 fluczakAI::Status fluczakAI::Behavior::Execute(BehaviorTreeContext& context)
 {
-    Status& status = context.statuses[m_id];
-    if (status != Status::RUNNING)
+    // The status is copied rather than referenced, children executed by Tick can grow the status store
+    if (context.statuses[m_id] != Status::RUNNING)
     {
         Initialize(context);
     }
 
-    status = Tick(context);
+    const Status status = Tick(context);
 
     if (status != Status::RUNNING)
     {
@@ -26,8 +28,27 @@ fluczakAI::Status fluczakAI::Behavior::Execute(BehaviorTreeContext& context)
     return status;
 }
 
+fluczakAI::Status fluczakAI::Composite::Execute(BehaviorTreeContext& context)
+{
+    if (context.statuses.TakePendingReset(m_id))
+    {
+        for (auto& child : m_children)
+        {
+            child->Reset(context);
+        }
+    }
+
+    return Behavior::Execute(context);
+}
+
 void fluczakAI::Composite::Reset(BehaviorTreeContext& context)
 {
+    if (!m_hasEagerReset)
+    {
+        context.statuses.Invalidate(m_id);
+        return;
+    }
+
     Behavior::Reset(context);
     for (auto& child : m_children)
     {
@@ -35,6 +56,14 @@ void fluczakAI::Composite::Reset(BehaviorTreeContext& context)
     }
 }
 
+void fluczakAI::Composite::BindLayout(const BlackboardLayout& layout)
+{
+    for (auto& child : m_children)
+    {
+        child->BindLayout(layout);
+    }
+}
+
 void fluczakAI::Composite::RemoveChild(Behavior* child)
 {
     m_children.erase(std::remove_if(m_children.begin(), m_children.end(),[child](const std::unique_ptr<Behavior>& behavior)
@@ -43,12 +72,34 @@ void fluczakAI::Composite::RemoveChild(Behavior* child)
     }), m_children.end());
 }
 
+fluczakAI::Status fluczakAI::Decorator::Execute(BehaviorTreeContext& context)
+{
+    if (context.statuses.TakePendingReset(m_id) && m_child != nullptr)
+    {
+        m_child->Reset(context);
+    }
+
+    return Behavior::Execute(context);
+}
+
 void fluczakAI::Decorator::Reset(BehaviorTreeContext& context)
 {
+    if (!m_hasEagerReset)
+    {
+        context.statuses.Invalidate(m_id);
+        return;
+    }
+
     Behavior::Reset(context);
     m_child->Reset(context);
 }
 
+void fluczakAI::Decorator::BindLayout(const BlackboardLayout& layout)
+{
+    if (m_child == nullptr) return;
+    m_child->BindLayout(layout);
+}
+
 fluczakAI::Status fluczakAI::Condition::Tick(BehaviorTreeContext& context)
 {
     if (m_function())
@@ -111,6 +162,77 @@ fluczakAI::Status fluczakAI::Selector::Tick(BehaviorTreeContext& context)
     return Status::FAILURE;
 }
 
+fluczakAI::Status fluczakAI::Parallel::Tick(BehaviorTreeContext& context)
+{
+    const auto executeChild = [this, &context](size_t index)
+    {
+        const auto& child = m_children[index];
+        const Status status = context.statuses[child->GetId()];
+        if (status == Status::SUCCESS || status == Status::FAILURE) return;
+        child->Execute(context);
+    };
+
+    // A SubtreeRef shifts the offset of the statuses shared by all the children, so those run one after another
+    if (context.threadPool != nullptr && m_children.size() > 1 && !BehaviorTree::ReferencesSubtrees(this))
+    {
+        // Growing the stores while the children run would move the statuses and frames of the others
+        const size_t count = static_cast<size_t>(m_id + context.statuses.GetOffset()) + BehaviorTree::CountNodes(this);
+        if (context.statuses.Size() < count)
+        {
+            context.statuses.Resize(count);
+        }
+        context.coroutines.Reserve(count);
+
+        context.threadPool->ParallelFor(m_children.size(), 1, [&executeChild](size_t begin, size_t end, WorkerContext&)
+        {
+            for (size_t i = begin; i < end; i++)
+            {
+                executeChild(i);
+            }
+        });
+    }
+    else
+    {
+        for (size_t i = 0; i < m_children.size(); i++)
+        {
+            executeChild(i);
+        }
+    }
+
+    const int numChildren = static_cast<int>(m_children.size());
+    const int successThreshold = m_successThreshold > 0 ? std::min(m_successThreshold, numChildren) : numChildren;
+    const int failureThreshold = m_failureThreshold > 0 ? std::min(m_failureThreshold, numChildren) : numChildren;
+
+    int successes = 0;
+    int failures = 0;
+    for (const auto& child : m_children)
+    {
+        const Status status = context.statuses[child->GetId()];
+        if (status == Status::SUCCESS) successes++;
+        if (status == Status::FAILURE) failures++;
+    }
+
+    Status result = Status::RUNNING;
+    if (successes >= successThreshold)
+    {
+        result = Status::SUCCESS;
+    }
+    else if (failures >= failureThreshold || numChildren - failures < successThreshold)
+    {
+        result = Status::FAILURE;
+    }
+
+    if (result != Status::RUNNING)
+    {
+        for (const auto& child : m_children)
+        {
+            child->Reset(context);
+        }
+    }
+
+    return result;
+}
+
 fluczakAI::Status fluczakAI::Repeater::Tick(BehaviorTreeContext& context)
 {
     for (int i = 0 ; i < m_numRepeats;i++)
@@ -148,3 +270,65 @@ fluczakAI::Status fluczakAI::UntilFail::Tick(BehaviorTreeContext& context)
 
     return Status::FAILURE;
 }
+
+fluczakAI::SubtreeRef::SubtreeRef(int id, std::string name, std::shared_ptr<const BehaviorTree> subtree)
+    : Behavior(id), m_name(std::move(name)), m_subtree(std::move(subtree))
+{
+    assert(m_subtree != nullptr);
+}
+
+fluczakAI::Status fluczakAI::SubtreeRef::Execute(BehaviorTreeContext& context)
+{
+    if (context.statuses.TakePendingReset(m_id))
+    {
+        ResetSubtree(context);
+    }
+
+    return Behavior::Execute(context);
+}
+
+fluczakAI::Status fluczakAI::SubtreeRef::Tick(BehaviorTreeContext& context)
+{
+    const auto& root = m_subtree->GetRoot();
+    if (root == nullptr) return Status::FAILURE;
+
+    const int offset = context.statuses.GetOffset();
+    context.statuses.SetOffset(offset + m_id + 1);
+    const Status status = root->Execute(context);
+    context.statuses.SetOffset(offset);
+    return status;
+}
+
+void fluczakAI::SubtreeRef::Reset(BehaviorTreeContext& context)
+{
+    if (!HasEagerReset())
+    {
+        context.statuses.Invalidate(m_id);
+        return;
+    }
+
+    Behavior::Reset(context);
+    ResetSubtree(context);
+}
+
+bool fluczakAI::SubtreeRef::HasEagerReset() const
+{
+    const auto& root = m_subtree->GetRoot();
+    return root != nullptr && root->HasEagerReset();
+}
+
+void fluczakAI::SubtreeRef::ResetSubtree(BehaviorTreeContext& context) const
+{
+    const auto& root = m_subtree->GetRoot();
+    if (root == nullptr) return;
+
+    const int offset = context.statuses.GetOffset();
+    context.statuses.SetOffset(offset + m_id + 1);
+    root->Reset(context);
+    context.statuses.SetOffset(offset);
+}
+
+size_t fluczakAI::SubtreeRef::GetNodeCount() const
+{
+    return 1 + m_subtree->GetNodeCount();
+}
@@ -1,21 +1,30 @@
 #pragma once
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
 #include <functional>
 #include <memory>
+#include <span>
+#include <string>
+#include <type_traits>
 #include <vector>
-#include "../Blackboards/blackboard.hpp"
-#include "../Blackboards/comparator.hpp"
+#include "coroutine_frames.hpp"
+#include "../Blackboards/Blackboard.hpp"
+#include "../Blackboards/Comparator.hpp"
 #include "../execution_context.hpp"
 #include "../Serialization/json/single_include/nlohmann/json.hpp"
 
 namespace fluczakAI
 {
+class BehaviorTree;
 class EditorVariable;
+class ThreadPool;
 struct BehaviorTreeContext;
 
     /**
      * \brief Execution status of a given behavior
      */
-    enum class Status
+    enum class Status : uint8_t
     {
         INVALID = 0,
         SUCCESS = 1,
@@ -24,6 +33,118 @@ struct BehaviorTreeContext;
         ABORTED = 4
     };
 
+    /**
+     * \brief Statuses of the behaviors of a tree, stored in a flat array indexed by behavior id. Trees built with
+     * BehaviorTreeBuilder or deserialized from json number their behaviors 0..N-1, so a context only needs
+     * BehaviorTree::GetNodeCount() statuses. The array grows when an id past its end is accessed, but it should be
+     * presized with Resize, since growing invalidates references to the statuses.
+     * Next to every status the store keeps whether the behavior was reset since it last reset its children. Resetting
+     * a composite or a decorator only invalidates its own status and sets that mark, and the children are reset the
+     * next time it is executed, so a reset costs O(1) instead of O(subtree) and the statuses of a subtree that
+     * isn't executed again are never touched. Until then the children keep their outdated statuses. Behaviors
+     * whose Reset can't wait, see Behavior::HasEagerReset, make the composites and decorators above them reset their
+     * children right away instead.
+     * Ids are relative to an offset, which SubtreeRef shifts while a shared subtree is executed, so the subtree
+     * reads and writes the statuses reserved for that reference. Outside of a subtree the offset is 0.
+     */
+    class StatusStore
+    {
+    public:
+        /**
+         * \brief Get the status of a behavior, growing the store if the behavior has no status yet
+         * \param id - id of the behavior
+         * \return - a reference to the status
+         */
+        Status& operator[](int id)
+        {
+            id += m_offset;
+            assert(id >= 0);
+            if (static_cast<size_t>(id) >= m_statuses.size())
+            {
+                Resize(static_cast<size_t>(id) + 1);
+            }
+            return m_statuses[id];
+        }
+
+        /**
+         * \brief Get the status of a behavior without growing the store
+         * \param id - id of the behavior
+         * \return - the status, INVALID if the behavior has no status yet
+         */
+        Status Get(int id) const
+        {
+            id += m_offset;
+            return id >= 0 && static_cast<size_t>(id) < m_statuses.size() ? m_statuses[id] : Status::INVALID;
+        }
+
+        /**
+         * \brief Set the status of a behavior to INVALID and mark its children to be reset the next time it is executed
+         * \param id - id of the behavior
+         */
+        void Invalidate(int id)
+        {
+            (*this)[id] = Status::INVALID;
+            m_pendingResets[id + m_offset] = 1;
+        }
+
+        /**
+         * \brief Clear the mark set by Invalidate
+         * \param id - id of the behavior
+         * \return - whether the behavior was invalidated since the last call, if so its children have to be reset
+         */
+        bool TakePendingReset(int id)
+        {
+            id += m_offset;
+            if (id < 0 || static_cast<size_t>(id) >= m_pendingResets.size() || m_pendingResets[id] == 0) return false;
+            m_pendingResets[id] = 0;
+            return true;
+        }
+
+        /**
+         * \brief Make the store hold statuses for the ids 0..count-1 at offset 0, new statuses are INVALID
+         */
+        void Resize(size_t count)
+        {
+            m_statuses.resize(count, Status::INVALID);
+            m_pendingResets.resize(count, 0);
+        }
+
+        /**
+         * \brief Set every status to INVALID, keeping the size of the store
+         */
+        void Clear()
+        {
+            std::fill(m_statuses.begin(), m_statuses.end(), Status::INVALID);
+            std::fill(m_pendingResets.begin(), m_pendingResets.end(), uint8_t{0});
+        }
+
+        /**
+         * \brief Get the offset added to the ids, the index of the status of id 0
+         */
+        int GetOffset() const { return m_offset; }
+
+        /**
+         * \brief Set the offset added to the ids
+         * \param offset - the index of the status of id 0
+         */
+        void SetOffset(int offset) { m_offset = offset; }
+
+        size_t Size() const { return m_statuses.size(); }
+        Status* Data() { return m_statuses.data(); }
+        const Status* Data() const { return m_statuses.data(); }
+
+        /**
+         * \brief The marks set by Invalidate, one byte per status, e.g. to save them together with the statuses
+         */
+        uint8_t* PendingResets() { return m_pendingResets.data(); }
+        const uint8_t* PendingResets() const { return m_pendingResets.data(); }
+
+    private:
+        std::vector<Status> m_statuses{};
+        std::vector<uint8_t> m_pendingResets{};
+        int m_offset = 0;
+    };
+
     /**
      * \brief Base class for behavior tree execution context. Contains all useful elements for
      * Behavior Tree execution in a fly weight fashion.
@@ -32,7 +153,13 @@ struct BehaviorTreeContext;
     {
         float deltaTime = 0.0f;
         std::unique_ptr<Blackboard> blackboard = std::make_unique<Blackboard>();
-        std::unordered_map<int, Status> statuses;
+        StatusStore statuses;
+        // The nodes from the root to the running leaf of a FlatBehaviorTree, used by FlatBehaviorTree::Resume
+        std::vector<uint32_t> runningPath;
+        // The threads Parallel behaviors execute their children on, null to execute them on the calling thread
+        ThreadPool* threadPool = nullptr;
+        // The frames suspended in CoroutineActions, last so they are destroyed while the rest is still alive
+        CoroutineFrames coroutines;
     };
 
 
@@ -78,6 +205,12 @@ struct BehaviorTreeContext;
          */
         virtual void End(BehaviorTreeContext& context, Status status) {}
 
+        /**
+         * \brief Resolve the blackboard keys used by this behavior and its children to the slots
+         * of a given layout
+         * \param layout - the layout of the blackboards the behavior is going to be executed with
+         */
+        virtual void BindLayout(const BlackboardLayout& layout) {}
 
         /**
          * \brief A base function for adding a child to the behavior
@@ -93,6 +226,14 @@ struct BehaviorTreeContext;
          * \brief Remove all children from the behavior
          */
         virtual void ClearChild() {}
+        /**
+         * \brief Whether Reset has to reach this behavior as soon as one of its parents is reset, instead of the next
+         * time the parent is executed. True for behaviors whose Reset releases something, like CoroutineAction
+         * destroying its suspended frame, and for the composites and decorators above them once BehaviorTree
+         * found them.
+         */
+        virtual bool HasEagerReset() const { return false; }
+
         /**
          * \brief A getter for the behavior id
          * \return - behavior id
@@ -103,15 +244,64 @@ struct BehaviorTreeContext;
         int m_id = 0;
     };
 
+    /**
+     * \brief Whether a behavior type overrides Behavior::Reset, itself or through one of its bases
+     */
+    template <typename TBehavior>
+    constexpr bool OverridesReset = !std::is_same_v<decltype(&TBehavior::Reset), void (Behavior::*)(BehaviorTreeContext&)>;
+
     /**
      * \brief A base for an action behavior. It is meant to be a leaf of the behavior tree
      * it is supposed to execute actions.
+     * Resetting a composite or a decorator only reaches its children the next time it is executed, which may be
+     * never. An action that overrides Reset to clean up when it is aborted, e.g. by a higher priority branch of a
+     * selector, needs an eager reset so its Reset is called right away. Actions created by
+     * BehaviorTreeBuilder::Action, by GenericFactory and by static trees get one when they override Reset, actions
+     * created any other way opt in with SetEagerReset before the tree is created.
+     * One tree is executed by many agents, e.g. a prototype of BehaviorTreeCache, so an action must not keep the
+     * state of an agent in its members: what it remembers between ticks goes in the context, in the blackboard or a
+     * coroutine frame. Members are for the configuration shared by all the agents, like editor variables.
      */
     class BehaviorTreeAction : public Behavior
     {
     public:
         BehaviorTreeAction() : Behavior(-1){}
         void SetId(int id) { m_id = id; }
+
+        bool HasEagerReset() const override { return m_hasEagerReset; }
+
+        /**
+         * \brief Set whether Reset has to reach the action as soon as a parent of it is reset
+         */
+        void SetEagerReset(bool hasEagerReset) { m_hasEagerReset = hasEagerReset; }
+
+        /**
+         * \brief Called with the type an action was created as, gives the actions that override Reset an eager reset
+         */
+        template <typename TAction>
+        static void OnCreated(TAction& action)
+        {
+            if constexpr (OverridesReset<TAction>)
+            {
+                action.SetEagerReset(true);
+            }
+        }
+
+        /**
+         * \brief Tick the action for many contexts at once. Called by BatchBehaviorTreeExecutor instead of Tick, so
+         * an action can process all of the agents that reached it in a single loop. The default ticks the
+         * contexts one by one.
+         * \param contexts - the contexts to tick
+         * \param results - the status of every context at the end of the tick, as many as there are contexts
+         */
+        virtual void TickBatch(std::span<BehaviorTreeContext* const> contexts, std::span<Status> results)
+        {
+            for (size_t i = 0; i < contexts.size(); i++)
+            {
+                results[i] = Tick(*contexts[i]);
+            }
+        }
+
     	/**
 		* \brief Register a variable for serialization
 		* \param name - the name of the variable
@@ -123,6 +313,9 @@ struct BehaviorTreeContext;
         }
 
         std::unordered_map<std::string, EditorVariable*> editorVariables{};
+
+    private:
+        bool m_hasEagerReset = false;
     };
 
     /**
@@ -133,7 +326,22 @@ struct BehaviorTreeContext;
     public:
         Composite(int id) : Behavior(id) {}
 
+        /**
+         * \brief Reset the children if the composite was reset since it last did, then execute it
+         */
+        Status Execute(BehaviorTreeContext& context) override;
+        /**
+         * \brief Invalidate the status of the composite. Its children are reset the next time it is executed, or
+         * right away if one of them has an eager reset.
+         */
         void Reset(BehaviorTreeContext& context) override;
+        void BindLayout(const BlackboardLayout& layout) override;
+        bool HasEagerReset() const override { return m_hasEagerReset; }
+
+        /**
+         * \brief Set whether one of the children has an eager reset, see BehaviorTree::FindEagerResets
+         */
+        void SetEagerReset(bool hasEagerReset) { m_hasEagerReset = hasEagerReset; }
 
         /**
          * \brief A base function for adding a child to the behavior
@@ -159,6 +367,7 @@ struct BehaviorTreeContext;
         const std::vector<std::unique_ptr<Behavior>>& GetChildren()const { return m_children; }
     protected:
         std::vector<std::unique_ptr<Behavior>> m_children;
+        bool m_hasEagerReset = false;
     };
 
     /**
@@ -169,7 +378,22 @@ struct BehaviorTreeContext;
     public:
         Decorator(int id) : Behavior(id){}
 
+        /**
+         * \brief Reset the child if the decorator was reset since it last did, then execute it
+         */
+        Status Execute(BehaviorTreeContext& context) override;
+        /**
+         * \brief Invalidate the status of the decorator. Its child is reset the next time it is executed, or right
+         * away if it has an eager reset.
+         */
         void Reset(BehaviorTreeContext& context) override;
+        void BindLayout(const BlackboardLayout& layout) override;
+        bool HasEagerReset() const override { return m_hasEagerReset; }
+
+        /**
+         * \brief Set whether the child has an eager reset, see BehaviorTree::FindEagerResets
+         */
+        void SetEagerReset(bool hasEagerReset) { m_hasEagerReset = hasEagerReset; }
 
         /**
          * \brief Set the child of the behavior
@@ -198,6 +422,30 @@ struct BehaviorTreeContext;
         const std::unique_ptr<Behavior>& GetChild() const { return m_child;}
     protected:
         std::unique_ptr<Behavior> m_child{};
+        bool m_hasEagerReset = false;
+    };
+
+    /**
+     * \brief The part of a Comparison that doesn't depend on the type it compares, so comparisons of every
+     * type can be inspected through a single class
+     */
+    class ComparisonBase : public Decorator
+    {
+    public:
+        ComparisonBase(int id, bool isNegation) : Decorator(id), m_isNegation(isNegation) {}
+
+        /**
+         * \brief A getter for the comparator evaluated by the comparison
+         */
+        virtual const IComparator& GetComparator() const = 0;
+
+        /**
+         * \brief Whether or not the child is executed when the comparator fails instead of when it succeeds
+         */
+        bool IsNegation() const { return m_isNegation; }
+
+    protected:
+        bool m_isNegation = false;
     };
 
     /**
@@ -206,10 +454,12 @@ struct BehaviorTreeContext;
      * \tparam T - Type of the variable the comparator is going to compare against
      */
     template<typename T>
-    class Comparison :public Decorator
+    class Comparison :public ComparisonBase
     {
     public:
-        Comparison(int id, Comparator<T> comparator, bool isNegation = false): Decorator(id), m_comparator(comparator), m_isNegation(isNegation){};
+        Comparison(int id, Comparator<T> comparator, bool isNegation = false): ComparisonBase(id, isNegation), m_comparator(comparator){};
+
+        const IComparator& GetComparator() const override { return m_comparator; }
         /**
          * \brief Tick returns the result of the evaluation of the Comparator based on the blackboard
          * of the context. If the evaluation succeeds: it returns SUCCESS, if it fails: it returns FAIL
@@ -217,6 +467,12 @@ struct BehaviorTreeContext;
          * \return - The result of the evaluation
          */
         Status Tick(BehaviorTreeContext& context) override;
+
+        void BindLayout(const BlackboardLayout& layout) override
+        {
+            m_comparator.BindLayout(layout);
+            ComparisonBase::BindLayout(layout);
+        }
 #if defined(NLOHMANN_JSON_VERSION_MAJOR)
 
     	/**
@@ -231,7 +487,6 @@ struct BehaviorTreeContext;
 
     private:
         Comparator<T> m_comparator;
-        bool m_isNegation = false;
     };
 
     class Condition : public Decorator
@@ -296,8 +551,47 @@ struct BehaviorTreeContext;
     class Selector : public Composite
     {
     public:
-        Selector(int id) : Composite(id) {}
+        Selector(int id, bool isInterrupting = false) : Composite(id), m_isInterrupting(isInterrupting) {}
         Status Tick(BehaviorTreeContext& context) override;
+
+        /**
+         * \brief Whether or not the children before a running child are executed again when resuming a tree
+         * with FlatBehaviorTree::Resume. Executing a tree from the root always executes them.
+         */
+        bool IsInterrupting() const { return m_isInterrupting; }
+
+    private:
+        bool m_isInterrupting = false;
+    };
+
+    /**
+     * \brief A composite that executes all of its children in the same tick. Children that have finished are not
+     * executed again until the parallel finishes itself. It succeeds once enough children have succeeded and fails
+     * once enough children have failed, or once too few children are left to succeed. When it finishes, all of its
+     * children are reset.
+     * If the context has a thread pool, the children are executed on it at the same time, so they must not write
+     * to anything the other children use, the blackboard included. Their statuses are stored in separate bytes
+     * of a store that is presized before the children start, and their calls to AIExecutionContext::Sleep and
+     * SleepUntilChanged are serialized. If any of its children references a shared subtree with SubtreeRef, they
+     * are all executed on the calling thread.
+     */
+    class Parallel : public Composite
+    {
+    public:
+        /**
+         * \param id - id of the behavior
+         * \param successThreshold - number of children that have to succeed, 0 or less for all of them
+         * \param failureThreshold - number of children that have to fail, 0 or less for all of them
+         */
+        Parallel(int id, int successThreshold = 0, int failureThreshold = 1) : Composite(id), m_successThreshold(successThreshold), m_failureThreshold(failureThreshold) {}
+        Status Tick(BehaviorTreeContext& context) override;
+
+        int GetSuccessThreshold() const { return m_successThreshold; }
+        int GetFailureThreshold() const { return m_failureThreshold; }
+
+    private:
+        int m_successThreshold = 0;
+        int m_failureThreshold = 1;
     };
 
     /**
@@ -309,6 +603,11 @@ struct BehaviorTreeContext;
         Repeater(int id, int repeats) : Decorator(id), m_numRepeats(repeats) {}
         Status Tick(BehaviorTreeContext& context) override;
 
+        /**
+         * \brief A getter for the number of times the child is executed
+         */
+        int GetNumRepeats() const { return m_numRepeats; }
+
 #if defined(NLOHMANN_JSON_VERSION_MAJOR)
         void Serialize(nlohmann::json& json) const override
         {
@@ -351,4 +650,48 @@ struct BehaviorTreeContext;
         UntilFail(const int id) : Decorator(id) {}
         Status Tick(BehaviorTreeContext& context) override;
     };
+
+    /**
+     * \brief A behavior that executes a tree shared by many trees, e.g. one from a BehaviorTreeCache, and returns the
+     * status of its root. The behaviors of the shared tree are numbered from 0, the reference reserves the statuses
+     * following its own for them and shifts the offset of the StatusStore while executing it. Every reference site
+     * so keeps its own statuses, as if the shared tree was copied in its place.
+     * BindLayout doesn't reach the shared tree, its keys are resolved by whoever shares it, e.g. BehaviorTreeCache.
+     */
+    class SubtreeRef : public Behavior
+    {
+    public:
+        /**
+         * \param id - id of the behavior, the statuses of the shared tree start at id + 1
+         * \param name - the name the shared tree is serialized with
+         * \param subtree - the shared tree, it must not change afterwards
+         */
+        SubtreeRef(int id, std::string name, std::shared_ptr<const BehaviorTree> subtree);
+
+        /**
+         * \brief Reset the shared tree if the reference was reset since it last did, then execute it
+         */
+        Status Execute(BehaviorTreeContext& context) override;
+        Status Tick(BehaviorTreeContext& context) override;
+        /**
+         * \brief Invalidate the status of the reference. The shared tree is reset the next time it is executed, or
+         * right away if its root has an eager reset.
+         */
+        void Reset(BehaviorTreeContext& context) override;
+        bool HasEagerReset() const override;
+
+        /**
+         * \brief Get the number of statuses used by the reference and the shared tree
+         */
+        size_t GetNodeCount() const;
+
+        const std::string& GetName() const { return m_name; }
+        const std::shared_ptr<const BehaviorTree>& GetSubtree() const { return m_subtree; }
+
+    private:
+        void ResetSubtree(BehaviorTreeContext& context) const;
+
+        std::string m_name;
+        std::shared_ptr<const BehaviorTree> m_subtree;
+    };
 }
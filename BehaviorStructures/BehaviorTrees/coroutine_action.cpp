@@ -0,0 +1,74 @@
+#include "coroutine_action.hpp"
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+
+namespace
+{
+    /**
+     * \brief Placed before every frame, so the frame can be freed without its context
+     */
+    struct alignas(std::max_align_t) FrameHeader
+    {
+        fluczakAI::CoroutineFramePool* pool;
+    };
+
+    void DestroyFrame(void* address)
+    {
+        fluczakAI::BehaviorTask::Handle::from_address(address).destroy();
+    }
+}
+
+void* fluczakAI::BehaviorTask::promise_type::Allocate(size_t size, CoroutineFramePool* pool)
+{
+    const size_t totalSize = sizeof(FrameHeader) + size;
+    auto* header = static_cast<FrameHeader*>(pool != nullptr ? pool->Allocate(totalSize) : ::operator new(totalSize));
+    header->pool = pool;
+    return header + 1;
+}
+
+void fluczakAI::BehaviorTask::promise_type::operator delete(void* memory, size_t size)
+{
+    FrameHeader* header = static_cast<FrameHeader*>(memory) - 1;
+    if (header->pool != nullptr)
+    {
+        header->pool->Deallocate(header, sizeof(FrameHeader) + size);
+        return;
+    }
+    ::operator delete(header);
+}
+
+void fluczakAI::CoroutineAction::Initialize(BehaviorTreeContext& context)
+{
+    context.coroutines.Destroy(GetFrameIndex(context));
+}
+
+fluczakAI::Status fluczakAI::CoroutineAction::Tick(BehaviorTreeContext& context)
+{
+    const int frameIndex = GetFrameIndex(context);
+    BehaviorTask::Handle handle = BehaviorTask::Handle::from_address(context.coroutines.Get(frameIndex));
+    if (!handle)
+    {
+        handle = Run(context).Release();
+        context.coroutines.Set(frameIndex, handle.address(), &DestroyFrame);
+    }
+
+    BehaviorTask::promise_type& promise = handle.promise();
+    promise.context = &context;
+    if (promise.isReady != nullptr && !promise.isReady(promise.awaiter, context))
+    {
+        return Status::RUNNING;
+    }
+
+    handle.resume();
+    if (!handle.done()) return Status::RUNNING;
+
+    const Status status = promise.result;
+    context.coroutines.Destroy(frameIndex);
+    return status;
+}
+
+void fluczakAI::CoroutineAction::Reset(BehaviorTreeContext& context)
+{
+    context.coroutines.Destroy(GetFrameIndex(context));
+    BehaviorTreeAction::Reset(context);
+}
+#endif
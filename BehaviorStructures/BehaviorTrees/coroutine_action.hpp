@@ -0,0 +1,202 @@
+#pragma once
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+#include <atomic>
+#include <coroutine>
+#include <exception>
+#include <utility>
+#include "behaviors.hpp"
+
+namespace fluczakAI
+{
+/**
+ * \brief The coroutine type of CoroutineAction::Run. The frame is allocated from the CoroutineFrames of the
+ * context the coroutine was started for.
+ */
+class BehaviorTask
+{
+public:
+    struct promise_type
+    {
+        Status result = Status::SUCCESS;
+        // The context of the tick that resumed the coroutine
+        BehaviorTreeContext* context = nullptr;
+        // What the coroutine waits for, checked on every tick before resuming it
+        bool (*isReady)(void* awaiter, BehaviorTreeContext& context) = nullptr;
+        void* awaiter = nullptr;
+
+        BehaviorTask get_return_object() { return BehaviorTask(std::coroutine_handle<promise_type>::from_promise(*this)); }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        std::suspend_always final_suspend() noexcept { return {}; }
+        void return_value(Status status) { result = status; }
+        void unhandled_exception() { std::terminate(); }
+
+        /**
+         * \brief Allocate the frame of CoroutineAction::Run from the pool of the context
+         */
+        template <typename TAction>
+        static void* operator new(size_t size, TAction&, BehaviorTreeContext& context)
+        {
+            return Allocate(size, &context.coroutines.GetPool());
+        }
+
+        static void* operator new(size_t size) { return Allocate(size, nullptr); }
+        static void operator delete(void* memory, size_t size);
+
+    private:
+        static void* Allocate(size_t size, CoroutineFramePool* pool);
+    };
+
+    using Handle = std::coroutine_handle<promise_type>;
+
+    BehaviorTask(BehaviorTask&& other) noexcept : m_handle(std::exchange(other.m_handle, nullptr)) {}
+    BehaviorTask& operator=(BehaviorTask&& other) noexcept
+    {
+        if (m_handle) m_handle.destroy();
+        m_handle = std::exchange(other.m_handle, nullptr);
+        return *this;
+    }
+    ~BehaviorTask()
+    {
+        if (m_handle) m_handle.destroy();
+    }
+
+    /**
+     * \brief Give up the ownership of the frame
+     */
+    Handle Release() { return std::exchange(m_handle, nullptr); }
+
+private:
+    explicit BehaviorTask(Handle handle) : m_handle(handle) {}
+
+    Handle m_handle = nullptr;
+};
+
+/**
+ * \brief A base for the awaitables of a BehaviorTask. The coroutine is suspended until a tick for which
+ * TDerived::IsReady(context) returns true, without being resumed on the ticks in between. Awaiting it returns
+ * the context of the tick that resumed the coroutine.
+ */
+template <typename TDerived>
+class TickAwaiter
+{
+public:
+    bool await_ready() const noexcept { return false; }
+
+    void await_suspend(BehaviorTask::Handle handle) noexcept
+    {
+        m_promise = &handle.promise();
+        m_promise->awaiter = static_cast<TDerived*>(this);
+        m_promise->isReady = [](void* awaiter, BehaviorTreeContext& context)
+        {
+            return static_cast<TDerived*>(awaiter)->IsReady(context);
+        };
+    }
+
+    BehaviorTreeContext& await_resume() const noexcept
+    {
+        m_promise->isReady = nullptr;
+        m_promise->awaiter = nullptr;
+        return *m_promise->context;
+    }
+
+private:
+    BehaviorTask::promise_type* m_promise = nullptr;
+};
+
+/**
+ * \brief Suspend the coroutine until the next tick
+ */
+class NextTick : public TickAwaiter<NextTick>
+{
+public:
+    bool IsReady(BehaviorTreeContext&) const { return true; }
+};
+
+/**
+ * \brief Suspend the coroutine until the deltaTime of the following ticks adds up to a given time
+ */
+class WaitFor : public TickAwaiter<WaitFor>
+{
+public:
+    explicit WaitFor(float seconds) : m_seconds(seconds) {}
+
+    bool IsReady(const BehaviorTreeContext& context)
+    {
+        m_elapsed += context.deltaTime;
+        return m_elapsed >= m_seconds;
+    }
+
+private:
+    float m_seconds = 0.0f;
+    float m_elapsed = 0.0f;
+};
+
+/**
+ * \brief Suspend the coroutine until the first tick for which a predicate of the context is true
+ * \tparam TPredicate - callable as bool(BehaviorTreeContext&)
+ */
+template <typename TPredicate>
+class WaitUntil : public TickAwaiter<WaitUntil<TPredicate>>
+{
+public:
+    explicit WaitUntil(TPredicate predicate) : m_predicate(std::move(predicate)) {}
+
+    bool IsReady(BehaviorTreeContext& context) { return m_predicate(context); }
+
+private:
+    TPredicate m_predicate;
+};
+
+/**
+ * \brief Suspend the coroutine until a flag is set, for example by a path query running on another thread
+ */
+class WaitForCompletion : public TickAwaiter<WaitForCompletion>
+{
+public:
+    explicit WaitForCompletion(const std::atomic<bool>& completed) : m_completed(completed) {}
+
+    bool IsReady(BehaviorTreeContext&) const { return m_completed.load(std::memory_order_acquire); }
+
+private:
+    const std::atomic<bool>& m_completed;
+};
+
+/**
+ * \brief An action written as a coroutine. Run is started when the action starts and resumed on every tick
+ * until it co_returns the status the action ends with, so the progress of the action lives in the frame
+ * instead of in the blackboard.
+ * Every context has its own frame. It is destroyed when the action finishes, when it is reset, when it
+ * starts again and when the context is destroyed.
+ */
+class CoroutineAction : public BehaviorTreeAction
+{
+public:
+    /**
+     * \brief Destroys a frame left over from an execution that didn't finish. Setup belongs at the start of Run.
+     */
+    void Initialize(BehaviorTreeContext& context) final;
+    Status Tick(BehaviorTreeContext& context) final;
+    void Reset(BehaviorTreeContext& context) override;
+
+    /**
+     * \brief The frame is destroyed by Reset, so a reset reaches the action as soon as one of its parents is reset
+     */
+    bool HasEagerReset() const override { return true; }
+
+protected:
+    /**
+     * \brief The body of the action
+     * \param context - the context the action was started for. If the context can be moved while the action is
+     * suspended, use the context returned by co_await instead.
+     * \return - the coroutine, co_return the status to end the action with
+     */
+    virtual BehaviorTask Run(BehaviorTreeContext& context) = 0;
+
+private:
+    /**
+     * \brief The index of the frame of the action, its id shifted like its status when it is part of a shared subtree
+     */
+    int GetFrameIndex(const BehaviorTreeContext& context) const { return m_id + context.statuses.GetOffset(); }
+};
+}
+#endif
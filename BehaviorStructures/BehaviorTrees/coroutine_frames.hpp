@@ -0,0 +1,181 @@
+#pragma once
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace fluczakAI
+{
+/**
+ * \brief A pool of memory for coroutine frames. Freed frames are kept in free lists by size class, so an agent that
+ * keeps restarting its coroutines doesn't allocate after the first few ticks. The children of a threaded Parallel
+ * share the pool of their context, so it can be used by multiple threads at once.
+ */
+class CoroutineFramePool
+{
+public:
+    CoroutineFramePool() = default;
+    CoroutineFramePool(const CoroutineFramePool&) = delete;
+    CoroutineFramePool& operator=(const CoroutineFramePool&) = delete;
+
+    ~CoroutineFramePool()
+    {
+        for (auto& freeList : m_freeLists)
+        {
+            for (void* memory : freeList) ::operator delete(memory);
+        }
+    }
+
+    /**
+     * \brief Allocate the memory of a frame, from the pool if one of the same size class was freed before
+     * \param size - size of the frame in bytes
+     */
+    void* Allocate(size_t size)
+    {
+        const size_t sizeClass = SizeClass(size);
+        if (sizeClass >= NumSizeClasses) return ::operator new(size);
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (sizeClass < m_freeLists.size() && !m_freeLists[sizeClass].empty())
+        {
+            void* memory = m_freeLists[sizeClass].back();
+            m_freeLists[sizeClass].pop_back();
+            return memory;
+        }
+        return ::operator new((sizeClass + 1) * Granularity);
+    }
+
+    /**
+     * \brief Give the memory of a frame back to the pool
+     * \param memory - memory returned by Allocate
+     * \param size - the size it was allocated with
+     */
+    void Deallocate(void* memory, size_t size)
+    {
+        const size_t sizeClass = SizeClass(size);
+        if (sizeClass >= NumSizeClasses)
+        {
+            ::operator delete(memory);
+            return;
+        }
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (sizeClass >= m_freeLists.size()) m_freeLists.resize(sizeClass + 1);
+        m_freeLists[sizeClass].push_back(memory);
+    }
+
+private:
+    static constexpr size_t Granularity = 64;
+    static constexpr size_t NumSizeClasses = 64;
+
+    static size_t SizeClass(size_t size) { return size == 0 ? 0 : (size - 1) / Granularity; }
+
+    std::mutex m_mutex{};
+    std::vector<std::vector<void*>> m_freeLists{};
+};
+
+/**
+ * \brief The coroutine frames of the CoroutineActions of a single context: the frame suspended in every action,
+ * by behavior id shifted like the statuses, and the pool they are allocated from. The pool stays at the same address when the context is
+ * moved. Only addresses are stored, so it can be used without coroutine support.
+ * Actions running at the same time on different threads may only use their own frames, and only once Reserve made
+ * room for them.
+ */
+class CoroutineFrames
+{
+public:
+    CoroutineFrames() = default;
+    CoroutineFrames(const CoroutineFrames&) = delete;
+    CoroutineFrames& operator=(const CoroutineFrames&) = delete;
+
+    CoroutineFrames(CoroutineFrames&& other) noexcept { *this = std::move(other); }
+
+    CoroutineFrames& operator=(CoroutineFrames&& other) noexcept
+    {
+        if (this == &other) return *this;
+        Clear();
+        m_frames = std::move(other.m_frames);
+        m_pool = std::move(other.m_pool);
+        other.m_frames.clear();
+        return *this;
+    }
+
+    // The frames go back to the pool before it is freed
+    ~CoroutineFrames() { Clear(); }
+
+    /**
+     * \brief Get the pool the frames are allocated from
+     */
+    CoroutineFramePool& GetPool()
+    {
+        if (m_pool == nullptr) m_pool = std::make_unique<CoroutineFramePool>();
+        return *m_pool;
+    }
+
+    /**
+     * \brief Make room for the frames of the behaviors with an id below a given count and create the pool, so
+     * setting those frames doesn't change the frames of the other behaviors
+     */
+    void Reserve(size_t count)
+    {
+        if (m_frames.size() < count) m_frames.resize(count);
+        GetPool();
+    }
+
+    /**
+     * \brief Get the address of the frame suspended in a behavior, null if there is none
+     */
+    void* Get(int id) const
+    {
+        return id >= 0 && static_cast<size_t>(id) < m_frames.size() ? m_frames[id].address : nullptr;
+    }
+
+    /**
+     * \brief Store the frame suspended in a behavior
+     * \param id - id of the behavior
+     * \param address - address of the frame
+     * \param destroy - destroys the frame at a given address
+     */
+    void Set(int id, void* address, void (*destroy)(void*))
+    {
+        assert(id >= 0 && Get(id) == nullptr);
+        if (static_cast<size_t>(id) >= m_frames.size()) m_frames.resize(static_cast<size_t>(id) + 1);
+        m_frames[id] = {address, destroy};
+    }
+
+    /**
+     * \brief Destroy the frame suspended in a behavior, if there is one
+     */
+    void Destroy(int id)
+    {
+        if (Get(id) == nullptr) return;
+        // Cleared first, so the destructors of the frame don't see it anymore
+        const Frame frame = std::exchange(m_frames[id], Frame{});
+        frame.destroy(frame.address);
+    }
+
+    /**
+     * \brief Destroy all of the suspended frames, keeping the pooled memory
+     */
+    void Clear()
+    {
+        for (size_t id = 0; id < m_frames.size(); id++)
+        {
+            Destroy(static_cast<int>(id));
+        }
+    }
+
+private:
+    struct Frame
+    {
+        void* address = nullptr;
+        void (*destroy)(void*) = nullptr;
+    };
+
+    std::vector<Frame> m_frames{};
+    std::unique_ptr<CoroutineFramePool> m_pool{};
+};
+}
@@ -0,0 +1,430 @@
+#include "flat_behavior_tree.hpp"
+#include <algorithm>
+#include <typeinfo>
+#include "behavior_tree.hpp"
+
+namespace
+{
+    /**
+     * \brief A built-in node that is being executed. Leaves never get a frame, they are executed directly
+     * by their parent.
+     */
+    struct Frame
+    {
+        uint32_t node;
+        // The child being executed
+        uint32_t child;
+        // Repeats done by a Repeater, whether all children were already successful for a Sequence
+        int counter;
+        // 1 + the position of the node in the running path when resuming through it, 0 otherwise
+        uint32_t resumeDepth;
+    };
+
+    /**
+     * \brief The frames of the executions on a thread. A leaf can execute another flat tree, so nested executions
+     * reserve their frames above the outer ones. The frames are never freed, so reserving them doesn't allocate
+     * after the first executions.
+     */
+    struct FrameStack
+    {
+        std::vector<Frame> frames{};
+        // The number of frames reserved by the executions in progress
+        size_t size = 0;
+
+        static FrameStack& Get()
+        {
+            thread_local FrameStack stack;
+            return stack;
+        }
+    };
+
+    std::vector<uint32_t>& PendingPath()
+    {
+        // The running path of the current execution, indexed by depth and written from the running leaf up once
+        // its status is known. A nested execution can swap it for another buffer, but only from within a leaf,
+        // before the outer execution writes to it.
+        thread_local std::vector<uint32_t> path;
+        return path;
+    }
+}
+
+fluczakAI::FlatBehaviorTree::FlatBehaviorTree(const BehaviorTree& tree) : m_nodeCount(tree.GetNodeCount())
+{
+    if (tree.GetRoot() == nullptr) return;
+    Flatten(tree.GetRoot().get(), 1);
+}
+
+void fluczakAI::FlatBehaviorTree::Flatten(Behavior* behavior, uint32_t depth)
+{
+    m_depth = std::max(m_depth, depth);
+
+    const auto index = static_cast<uint32_t>(m_nodes.size());
+    m_nodes.emplace_back();
+
+    Node node;
+    node.id = behavior->GetId();
+    node.behavior = behavior;
+    node.hasEagerReset = behavior->HasEagerReset();
+
+    // Only the exact built-in types are lowered, a subclass may have overridden any of their functions
+    const std::type_info& type = typeid(*behavior);
+    const auto decorator = dynamic_cast<Decorator*>(behavior);
+    const auto comparison = dynamic_cast<ComparisonBase*>(behavior);
+
+    if (type == typeid(Sequence) || type == typeid(Selector))
+    {
+        node.type = type == typeid(Sequence) ? NodeType::SEQUENCE : NodeType::SELECTOR;
+        node.isInterrupting = type == typeid(Selector) && static_cast<Selector*>(behavior)->IsInterrupting();
+        for (const auto& child : static_cast<Composite*>(behavior)->GetChildren())
+        {
+            Flatten(child.get(), depth + 1);
+        }
+    }
+    // A decorator without a child is left to its own Execute and Reset, which is where they fail
+    else if (decorator != nullptr && decorator->GetChild() != nullptr &&
+        (type == typeid(Inverter) || type == typeid(Repeater) || type == typeid(AlwaysSucceed) || type == typeid(UntilFail) || comparison != nullptr))
+    {
+        if (type == typeid(Inverter)) node.type = NodeType::INVERTER;
+        if (type == typeid(AlwaysSucceed)) node.type = NodeType::ALWAYS_SUCCEED;
+        if (type == typeid(UntilFail)) node.type = NodeType::UNTIL_FAIL;
+        if (type == typeid(Repeater))
+        {
+            node.type = NodeType::REPEATER;
+            node.numRepeats = static_cast<Repeater*>(behavior)->GetNumRepeats();
+        }
+        if (comparison != nullptr)
+        {
+            node.type = NodeType::COMPARISON;
+            node.comparator = &comparison->GetComparator();
+            node.isNegation = comparison->IsNegation();
+        }
+
+        Flatten(decorator->GetChild().get(), depth + 1);
+    }
+    else
+    {
+        node.action = dynamic_cast<BehaviorTreeAction*>(behavior);
+    }
+
+    node.subtreeEnd = static_cast<uint32_t>(m_nodes.size());
+    m_nodes[index] = node;
+}
+
+fluczakAI::Status fluczakAI::FlatBehaviorTree::Execute(BehaviorTreeContext& context) const
+{
+    return Run(context, false, false);
+}
+
+fluczakAI::Status fluczakAI::FlatBehaviorTree::Resume(BehaviorTreeContext& context) const
+{
+    return Run(context, true, IsRunningPathValid(context));
+}
+
+bool fluczakAI::FlatBehaviorTree::IsRunningPathValid(const BehaviorTreeContext& context) const
+{
+    const auto& path = context.runningPath;
+    if (path.empty() || path[0] != 0) return false;
+
+    for (size_t i = 0; i < path.size(); i++)
+    {
+        if (path[i] >= m_nodes.size()) return false;
+        if (context.statuses.Get(m_nodes[path[i]].id) != Status::RUNNING) return false;
+        if (i > 0 && (path[i] <= path[i - 1] || path[i] >= m_nodes[path[i - 1]].subtreeEnd)) return false;
+    }
+
+    // A path ends at the leaf that was running
+    return m_nodes[path.back()].type == NodeType::LEAF;
+}
+
+fluczakAI::Status fluczakAI::FlatBehaviorTree::Run(BehaviorTreeContext& context, bool recordPath, bool resume) const
+{
+    if (m_nodes.empty()) return Status::INVALID;
+
+    if (context.statuses.Size() < m_nodeCount)
+    {
+        context.statuses.Resize(m_nodeCount);
+    }
+
+    if (m_nodes[0].type == NodeType::LEAF)
+    {
+        const Status status = m_nodes[0].behavior->Execute(context);
+        context.runningPath.assign(recordPath && status == Status::RUNNING ? 1 : 0, 0);
+        return status;
+    }
+
+    const std::vector<uint32_t>& runningPath = context.runningPath;
+    std::vector<uint32_t>& pendingPath = PendingPath();
+    // The frames of the execution are reserved up front and indexed by depth, a nested execution started by a
+    // leaf reserves its own above them
+    FrameStack& stack = FrameStack::Get();
+    const size_t base = stack.size;
+    stack.size += m_depth;
+    if (stack.frames.size() < stack.size)
+    {
+        stack.frames.resize(stack.size);
+    }
+    Frame* frames = stack.frames.data() + base;
+    size_t top = 0;
+    ResetPendingChildren(0, context);
+    frames[0] = {0, 0, 0, resume ? 1u : 0u};
+
+    // The result of the last child executed, handed to its parent
+    Status result = Status::INVALID;
+    bool hasResult = false;
+
+    while (true)
+    {
+        Frame& frame = frames[top];
+        const Node& node = m_nodes[frame.node];
+        const uint32_t firstChild = frame.node + 1;
+
+        // The child to execute next, or none if the node is done
+        uint32_t call = 0;
+        Status finished = Status::INVALID;
+
+        switch (node.type)
+        {
+        case NodeType::SEQUENCE:
+            if (!hasResult && frame.resumeDepth != 0)
+            {
+                // The children before the running one have succeeded, so they would be skipped anyway
+                frame.child = runningPath[frame.resumeDepth];
+                frame.counter = 0;
+                call = frame.child;
+                break;
+            }
+
+            if (!hasResult)
+            {
+                frame.child = firstChild;
+                frame.counter = 1;
+            }
+            else if (result != Status::SUCCESS)
+            {
+                finished = result;
+                break;
+            }
+            else
+            {
+                frame.child = m_nodes[frame.child].subtreeEnd;
+            }
+
+            while (frame.child < node.subtreeEnd && context.statuses[m_nodes[frame.child].id] == Status::SUCCESS)
+            {
+                frame.child = m_nodes[frame.child].subtreeEnd;
+            }
+
+            if (frame.child < node.subtreeEnd)
+            {
+                frame.counter = 0;
+                call = frame.child;
+                break;
+            }
+
+            if (frame.counter != 0)
+            {
+                for (uint32_t child = firstChild; child < node.subtreeEnd; child = m_nodes[child].subtreeEnd)
+                {
+                    ResetSubtree(child, context);
+                }
+            }
+            finished = Status::SUCCESS;
+            break;
+
+        case NodeType::SELECTOR:
+            if (!hasResult && frame.resumeDepth != 0 && !node.isInterrupting)
+            {
+                frame.child = runningPath[frame.resumeDepth];
+                call = frame.child;
+                break;
+            }
+
+            if (!hasResult)
+            {
+                frame.child = firstChild;
+            }
+            else if (result != Status::FAILURE)
+            {
+                for (uint32_t child = firstChild; child < node.subtreeEnd; child = m_nodes[child].subtreeEnd)
+                {
+                    if (child != frame.child) ResetSubtree(child, context);
+                }
+                finished = result;
+                break;
+            }
+            else
+            {
+                frame.child = m_nodes[frame.child].subtreeEnd;
+            }
+
+            if (frame.child < node.subtreeEnd)
+            {
+                call = frame.child;
+                break;
+            }
+            finished = Status::FAILURE;
+            break;
+
+        case NodeType::REPEATER:
+            if (!hasResult)
+            {
+                frame.counter = 0;
+            }
+            else
+            {
+                // Like Repeater::Tick this checks the status of the repeater itself
+                const Status status = context.statuses[node.id];
+                if (status == Status::RUNNING)
+                {
+                    finished = Status::SUCCESS;
+                    break;
+                }
+                if (status == Status::FAILURE)
+                {
+                    finished = Status::FAILURE;
+                    break;
+                }
+                ResetSubtree(firstChild, context);
+                frame.counter++;
+            }
+
+            if (frame.counter < node.numRepeats)
+            {
+                call = firstChild;
+                break;
+            }
+            finished = Status::SUCCESS;
+            break;
+
+        case NodeType::INVERTER:
+            if (!hasResult)
+            {
+                call = firstChild;
+                break;
+            }
+            finished = result == Status::FAILURE ? Status::SUCCESS : result == Status::SUCCESS ? Status::FAILURE : Status::INVALID;
+            break;
+
+        case NodeType::ALWAYS_SUCCEED:
+            if (!hasResult)
+            {
+                call = firstChild;
+                break;
+            }
+            finished = Status::SUCCESS;
+            break;
+
+        case NodeType::UNTIL_FAIL:
+            if (!hasResult)
+            {
+                call = firstChild;
+                break;
+            }
+            finished = result != Status::FAILURE ? Status::SUCCESS : Status::FAILURE;
+            break;
+
+        case NodeType::COMPARISON:
+            if (!hasResult)
+            {
+                if (node.comparator->Evaluate(*context.blackboard) != node.isNegation)
+                {
+                    call = firstChild;
+                    break;
+                }
+                finished = Status::FAILURE;
+                break;
+            }
+            finished = result;
+            break;
+
+        case NodeType::LEAF:
+            break;
+        }
+
+        if (call != 0)
+        {
+            if (m_nodes[call].type == NodeType::LEAF)
+            {
+                result = m_nodes[call].behavior->Execute(context);
+                hasResult = true;
+                // A nested execution can have grown the stack
+                frames = stack.frames.data() + base;
+
+                if (result == Status::RUNNING)
+                {
+                    pendingPath.resize(top + 2);
+                    pendingPath[top + 1] = call;
+                }
+            }
+            else
+            {
+                const bool resumesChild = frame.resumeDepth != 0 && frame.resumeDepth < runningPath.size() && runningPath[frame.resumeDepth] == call;
+                const uint32_t childResumeDepth = resumesChild ? frame.resumeDepth + 1 : 0;
+
+                ResetPendingChildren(call, context);
+                frames[++top] = {call, 0, 0, childResumeDepth};
+                hasResult = false;
+            }
+            continue;
+        }
+
+        // Only a running child makes a node running, so the path below the node is already written
+        if (finished == Status::RUNNING)
+        {
+            pendingPath[top] = frame.node;
+        }
+
+        // Built-in behaviors have no Initialize and End, so their Execute only stores the status
+        context.statuses[node.id] = finished;
+        result = finished;
+        hasResult = true;
+        if (top == 0) break;
+        top--;
+    }
+
+    stack.size = base;
+
+    // Touching the path of every context costs a cache miss per agent, so only Resume, which reads it, keeps it
+    if (recordPath && result == Status::RUNNING)
+    {
+        context.runningPath.swap(pendingPath);
+    }
+    else
+    {
+        context.runningPath.clear();
+    }
+
+    return result;
+}
+
+void fluczakAI::FlatBehaviorTree::ResetSubtree(uint32_t index, BehaviorTreeContext& context) const
+{
+    const Node& node = m_nodes[index];
+    if (node.type == NodeType::LEAF)
+    {
+        node.behavior->Reset(context);
+    }
+    else if (node.hasEagerReset)
+    {
+        context.statuses[node.id] = Status::INVALID;
+        for (uint32_t child = index + 1; child < node.subtreeEnd; child = m_nodes[child].subtreeEnd)
+        {
+            ResetSubtree(child, context);
+        }
+    }
+    else
+    {
+        context.statuses.Invalidate(node.id);
+    }
+}
+
+void fluczakAI::FlatBehaviorTree::ResetPendingChildren(uint32_t index, BehaviorTreeContext& context) const
+{
+    const Node& node = m_nodes[index];
+    if (!context.statuses.TakePendingReset(node.id)) return;
+
+    for (uint32_t child = index + 1; child < node.subtreeEnd; child = m_nodes[child].subtreeEnd)
+    {
+        ResetSubtree(child, context);
+    }
+}
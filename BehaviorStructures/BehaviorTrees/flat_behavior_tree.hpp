@@ -0,0 +1,109 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "behaviors.hpp"
+
+namespace fluczakAI
+{
+class BehaviorTree;
+
+/**
+ * \brief A behavior tree lowered into a single array of nodes in preorder. The built-in behaviors (Sequence,
+ * Selector, Inverter, Repeater, AlwaysSucceed, UntilFail and Comparison) are executed by a loop over the array
+ * without virtual calls or recursion. Every other behavior, e.g. actions and conditions, becomes a leaf that
+ * is executed through Behavior::Execute, together with its children.
+ * The behaviors keep their ids, so the results and the statuses of a context are the same as when executing
+ * the original tree, and a context can be executed by either of them. Resume also records the running path of
+ * the context it continues from the next time.
+ */
+class FlatBehaviorTree
+{
+public:
+    enum class NodeType : uint8_t
+    {
+        SEQUENCE,
+        SELECTOR,
+        INVERTER,
+        REPEATER,
+        ALWAYS_SUCCEED,
+        UNTIL_FAIL,
+        COMPARISON,
+        LEAF
+    };
+
+    /**
+     * \brief A single behavior of the tree. The first child of a node is the next node in the array and the
+     * next sibling of a node starts at its subtreeEnd.
+     */
+    struct Node
+    {
+        NodeType type = NodeType::LEAF;
+        bool isNegation = false;
+        bool isInterrupting = false;
+        // Whether a reset of the node reaches the nodes below it right away, see Behavior::HasEagerReset
+        bool hasEagerReset = false;
+        int id = 0;
+        uint32_t subtreeEnd = 0;
+        int numRepeats = 0;
+        const IComparator* comparator = nullptr;
+        Behavior* behavior = nullptr;
+        // The behavior of a leaf if it is an action
+        BehaviorTreeAction* action = nullptr;
+    };
+
+    /**
+     * \brief Lower a behavior tree. The flat tree refers to the behaviors of the tree, so the tree has to
+     * outlive it and must not change its structure afterwards.
+     * \param tree - the tree to lower
+     */
+    explicit FlatBehaviorTree(const BehaviorTree& tree);
+
+    /**
+     * \brief Execute the tree for a given context, equivalent to BehaviorTree::Execute. The running path isn't
+     * recorded, so the next Resume starts from the root.
+     * \param context - A behavior tree execution context
+     * \return - the status of the root
+     */
+    Status Execute(BehaviorTreeContext& context) const;
+
+    /**
+     * \brief Execute the tree starting at the node that was running at the end of the previous execution
+     * instead of the root, so a tick costs O(depth) instead of O(tree) while an agent sits in a long running
+     * action. On the way to the running node sequences skip straight to their running child, comparisons are
+     * evaluated as usual and selectors only execute their children before the running one if they are
+     * interrupting. If nothing was running, or the statuses were reset since, the tree is executed from the root.
+     * \param context - A behavior tree execution context
+     * \return - the status of the root
+     */
+    Status Resume(BehaviorTreeContext& context) const;
+
+    /**
+     * \brief Reset a node, equivalent to Behavior::Reset. A built-in node only invalidates its own status, the
+     * nodes below it are reset by ResetPendingChildren once it is executed again, unless it has an eager reset.
+     * \param index - index of the node in the array
+     * \param context - A behavior tree execution context
+     */
+    void ResetSubtree(uint32_t index, BehaviorTreeContext& context) const;
+
+    /**
+     * \brief Reset the children of a built-in node if the node was reset since it last did, equivalent to the
+     * start of Composite::Execute and Decorator::Execute. Called before a built-in node is executed.
+     * \param index - index of the node in the array
+     * \param context - A behavior tree execution context
+     */
+    void ResetPendingChildren(uint32_t index, BehaviorTreeContext& context) const;
+
+    const std::vector<Node>& GetNodes() const { return m_nodes; }
+    size_t GetNodeCount() const { return m_nodeCount; }
+
+private:
+    void Flatten(Behavior* behavior, uint32_t depth);
+    Status Run(BehaviorTreeContext& context, bool recordPath, bool resume) const;
+    bool IsRunningPathValid(const BehaviorTreeContext& context) const;
+
+    std::vector<Node> m_nodes{};
+    size_t m_nodeCount = 0;
+    // The number of nodes on the longest path from the root, no execution needs more frames
+    uint32_t m_depth = 0;
+};
+}
@@ -0,0 +1,521 @@
+#pragma once
+#include <cstddef>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include "behaviors.hpp"
+
+namespace fluczakAI
+{
+    /**
+     * The description of a tree that is fixed at compile time. The structure is a type, e.g.
+     *
+     *   struct LowHealth { static Comparator<float> Create() { return {"health", ComparisonType::LESS, 10.0f}; } };
+     *   using Tree = StaticBehaviorTree<StaticSelector<StaticComparison<LowHealth, Flee>, StaticSequence<Walk, Attack>>>;
+     *
+     * Actions are the same classes that are added with BehaviorTreeBuilder::Action<T>, they are default
+     * constructed. Their functions are called non-virtually, so a subclass of an action in a static tree has
+     * to be a separate type in the description.
+     */
+
+    /**
+     * \brief A Sequence of a static tree
+     */
+    template <typename... TChildren>
+    struct StaticSequence {};
+
+    /**
+     * \brief A Selector of a static tree
+     */
+    template <typename... TChildren>
+    struct StaticSelector {};
+
+    /**
+     * \brief A Parallel of a static tree. Its children are always executed on the calling thread.
+     */
+    template <int SuccessThreshold, int FailureThreshold, typename... TChildren>
+    struct StaticParallel {};
+
+    /**
+     * \brief A Repeater of a static tree
+     */
+    template <int NumRepeats, typename TChild>
+    struct StaticRepeater {};
+
+    /**
+     * \brief An Inverter of a static tree
+     */
+    template <typename TChild>
+    struct StaticInverter {};
+
+    /**
+     * \brief An AlwaysSucceed of a static tree
+     */
+    template <typename TChild>
+    struct StaticAlwaysSucceed {};
+
+    /**
+     * \brief An UntilFail of a static tree
+     */
+    template <typename TChild>
+    struct StaticUntilFail {};
+
+    /**
+     * \brief A Comparison of a static tree
+     * \tparam TComparator - a type with a static Create() returning the Comparator<T> to evaluate
+     */
+    template <typename TComparator, typename TChild, bool IsNegation = false>
+    struct StaticComparison {};
+
+namespace detail
+{
+    /**
+     * \brief The number of behaviors in the subtree of a description
+     */
+    template <typename TDescription>
+    struct StaticNodeCount : std::integral_constant<int, 1> {};
+
+    template <typename... TChildren>
+    struct StaticNodeCount<StaticSequence<TChildren...>> : std::integral_constant<int, (1 + ... + StaticNodeCount<TChildren>::value)> {};
+
+    template <typename... TChildren>
+    struct StaticNodeCount<StaticSelector<TChildren...>> : std::integral_constant<int, (1 + ... + StaticNodeCount<TChildren>::value)> {};
+
+    template <int SuccessThreshold, int FailureThreshold, typename... TChildren>
+    struct StaticNodeCount<StaticParallel<SuccessThreshold, FailureThreshold, TChildren...>> : std::integral_constant<int, (1 + ... + StaticNodeCount<TChildren>::value)> {};
+
+    template <int NumRepeats, typename TChild>
+    struct StaticNodeCount<StaticRepeater<NumRepeats, TChild>> : std::integral_constant<int, 1 + StaticNodeCount<TChild>::value> {};
+
+    template <typename TChild>
+    struct StaticNodeCount<StaticInverter<TChild>> : std::integral_constant<int, 1 + StaticNodeCount<TChild>::value> {};
+
+    template <typename TChild>
+    struct StaticNodeCount<StaticAlwaysSucceed<TChild>> : std::integral_constant<int, 1 + StaticNodeCount<TChild>::value> {};
+
+    template <typename TChild>
+    struct StaticNodeCount<StaticUntilFail<TChild>> : std::integral_constant<int, 1 + StaticNodeCount<TChild>::value> {};
+
+    template <typename TComparator, typename TChild, bool IsNegation>
+    struct StaticNodeCount<StaticComparison<TComparator, TChild, IsNegation>> : std::integral_constant<int, 1 + StaticNodeCount<TChild>::value> {};
+
+    /**
+     * \brief The id of the child at a given index relative to the id of the first child, ids are handed out in
+     * preorder like BehaviorTreeBuilder does
+     */
+    template <typename... TChildren>
+    constexpr int StaticChildOffset(size_t index)
+    {
+        constexpr int counts[] = {StaticNodeCount<TChildren>::value..., 0};
+        int offset = 0;
+        for (size_t i = 0; i < index; i++)
+        {
+            offset += counts[i];
+        }
+        return offset;
+    }
+}
+
+    template <typename TDescription, int Id>
+    class StaticNode;
+
+namespace detail
+{
+    template <int FirstId, typename TIndices, typename... TChildren>
+    struct StaticChildNodes;
+
+    template <int FirstId, size_t... Indices, typename... TChildren>
+    struct StaticChildNodes<FirstId, std::index_sequence<Indices...>, TChildren...>
+    {
+        using Type = std::tuple<StaticNode<TChildren, FirstId + StaticChildOffset<TChildren...>(Indices)>...>;
+    };
+
+    /**
+     * \brief The part shared by the composites and decorators of a static tree: the children, the lazy reset of
+     * StatusStore and storing the status, the same way Composite and Decorator do it
+     */
+    template <int Id, typename... TChildren>
+    class StaticParent
+    {
+    public:
+        StaticParent()
+        {
+            ForEachChild([this](auto& child) { m_hasEagerReset = m_hasEagerReset || child.HasEagerReset(); });
+        }
+
+        void Reset(BehaviorTreeContext& context)
+        {
+            if (!m_hasEagerReset)
+            {
+                context.statuses.Invalidate(Id);
+                return;
+            }
+
+            context.statuses.Data()[Id] = Status::INVALID;
+            ForEachChild([&context](auto& child) { child.Reset(context); });
+        }
+
+        bool HasEagerReset() const { return m_hasEagerReset; }
+
+        void BindLayout(const BlackboardLayout& layout)
+        {
+            ForEachChild([&layout](auto& child) { child.BindLayout(layout); });
+        }
+
+        template <typename TFunction>
+        void ForEachAction(TFunction& function)
+        {
+            ForEachChild([&function](auto& child) { child.ForEachAction(function); });
+        }
+
+    protected:
+        template <typename TDerived>
+        Status ExecuteAs(BehaviorTreeContext& context)
+        {
+            if (context.statuses.TakePendingReset(Id))
+            {
+                ForEachChild([&context](auto& child) { child.Reset(context); });
+            }
+
+            // Built-in behaviors have no Initialize and End, so executing them only stores the status
+            const Status status = static_cast<TDerived*>(this)->Tick(context);
+            context.statuses.Data()[Id] = status;
+            return status;
+        }
+
+        template <typename TFunction>
+        void ForEachChild(TFunction&& function)
+        {
+            std::apply([&function](auto&... children) { (function(children), ...); }, m_children);
+        }
+
+        /**
+         * \brief Call a function for the children in order until it returns true
+         * \return - whether the function returned true for any of the children
+         */
+        template <typename TFunction>
+        bool ForEachChildUntil(TFunction&& function)
+        {
+            return std::apply([&function](auto&... children) { return (function(children) || ...); }, m_children);
+        }
+
+        typename StaticChildNodes<Id + 1, std::index_sequence_for<TChildren...>, TChildren...>::Type m_children{};
+        bool m_hasEagerReset = false;
+    };
+}
+
+    /**
+     * \brief An action of a static tree, executed with the steps of Behavior::Execute
+     */
+    template <typename TAction, int Id>
+    class StaticNode
+    {
+        static_assert(std::is_base_of_v<BehaviorTreeAction, TAction>, "A leaf of a static tree has to be an action");
+
+    public:
+        static constexpr int id = Id;
+
+        StaticNode()
+        {
+            m_action.SetId(Id);
+            BehaviorTreeAction::OnCreated(m_action);
+        }
+
+        Status Execute(BehaviorTreeContext& context)
+        {
+            if (context.statuses.Data()[Id] != Status::RUNNING)
+            {
+                m_action.TAction::Initialize(context);
+            }
+
+            const Status status = m_action.TAction::Tick(context);
+
+            if (status != Status::RUNNING)
+            {
+                m_action.TAction::End(context, status);
+            }
+
+            context.statuses.Data()[Id] = status;
+            return status;
+        }
+
+        void Reset(BehaviorTreeContext& context) { m_action.TAction::Reset(context); }
+        bool HasEagerReset() const { return m_action.HasEagerReset(); }
+        void BindLayout(const BlackboardLayout& layout) { m_action.TAction::BindLayout(layout); }
+
+        template <typename TFunction>
+        void ForEachAction(TFunction& function) { function(m_action); }
+
+        TAction& GetAction() { return m_action; }
+
+    private:
+        TAction m_action{};
+    };
+
+    template <typename... TChildren, int Id>
+    class StaticNode<StaticSequence<TChildren...>, Id> : public detail::StaticParent<Id, TChildren...>
+    {
+    public:
+        static constexpr int id = Id;
+
+        Status Execute(BehaviorTreeContext& context) { return this->template ExecuteAs<StaticNode>(context); }
+
+        Status Tick(BehaviorTreeContext& context)
+        {
+            bool allSuccess = true;
+            Status result = Status::SUCCESS;
+            this->ForEachChildUntil([&](auto& child)
+            {
+                if (context.statuses.Data()[child.id] == Status::SUCCESS) return false;
+                allSuccess = false;
+                result = child.Execute(context);
+                return result != Status::SUCCESS;
+            });
+
+            if (result != Status::SUCCESS) return result;
+
+            if (allSuccess)
+            {
+                this->ForEachChild([&context](auto& child) { child.Reset(context); });
+            }
+
+            return Status::SUCCESS;
+        }
+    };
+
+    template <typename... TChildren, int Id>
+    class StaticNode<StaticSelector<TChildren...>, Id> : public detail::StaticParent<Id, TChildren...>
+    {
+    public:
+        static constexpr int id = Id;
+
+        Status Execute(BehaviorTreeContext& context) { return this->template ExecuteAs<StaticNode>(context); }
+
+        Status Tick(BehaviorTreeContext& context)
+        {
+            int chosen = -1;
+            Status result = Status::FAILURE;
+            this->ForEachChildUntil([&](auto& child)
+            {
+                result = child.Execute(context);
+                if (result == Status::FAILURE) return false;
+                chosen = child.id;
+                return true;
+            });
+
+            if (chosen == -1) return Status::FAILURE;
+
+            this->ForEachChild([&context, chosen](auto& child)
+            {
+                if (child.id != chosen) child.Reset(context);
+            });
+            return result;
+        }
+    };
+
+    template <int SuccessThreshold, int FailureThreshold, typename... TChildren, int Id>
+    class StaticNode<StaticParallel<SuccessThreshold, FailureThreshold, TChildren...>, Id> : public detail::StaticParent<Id, TChildren...>
+    {
+    public:
+        static constexpr int id = Id;
+
+        Status Execute(BehaviorTreeContext& context) { return this->template ExecuteAs<StaticNode>(context); }
+
+        Status Tick(BehaviorTreeContext& context)
+        {
+            constexpr int numChildren = static_cast<int>(sizeof...(TChildren));
+            constexpr int successThreshold = SuccessThreshold > 0 && SuccessThreshold < numChildren ? SuccessThreshold : numChildren;
+            constexpr int failureThreshold = FailureThreshold > 0 && FailureThreshold < numChildren ? FailureThreshold : numChildren;
+
+            int successes = 0;
+            int failures = 0;
+            this->ForEachChild([&](auto& child)
+            {
+                Status status = context.statuses.Data()[child.id];
+                if (status != Status::SUCCESS && status != Status::FAILURE)
+                {
+                    status = child.Execute(context);
+                }
+                if (status == Status::SUCCESS) successes++;
+                if (status == Status::FAILURE) failures++;
+            });
+
+            Status result = Status::RUNNING;
+            if (successes >= successThreshold)
+            {
+                result = Status::SUCCESS;
+            }
+            else if (failures >= failureThreshold || numChildren - failures < successThreshold)
+            {
+                result = Status::FAILURE;
+            }
+
+            if (result != Status::RUNNING)
+            {
+                this->ForEachChild([&context](auto& child) { child.Reset(context); });
+            }
+
+            return result;
+        }
+    };
+
+    template <int NumRepeats, typename TChild, int Id>
+    class StaticNode<StaticRepeater<NumRepeats, TChild>, Id> : public detail::StaticParent<Id, TChild>
+    {
+    public:
+        static constexpr int id = Id;
+
+        Status Execute(BehaviorTreeContext& context) { return this->template ExecuteAs<StaticNode>(context); }
+
+        Status Tick(BehaviorTreeContext& context)
+        {
+            auto& child = std::get<0>(this->m_children);
+            for (int i = 0; i < NumRepeats; i++)
+            {
+                child.Execute(context);
+                // Like Repeater::Tick this checks the status of the repeater itself
+                if (context.statuses.Data()[Id] == Status::RUNNING) return Status::SUCCESS;
+                if (context.statuses.Data()[Id] == Status::FAILURE) return Status::FAILURE;
+                child.Reset(context);
+            }
+
+            return Status::SUCCESS;
+        }
+    };
+
+    template <typename TChild, int Id>
+    class StaticNode<StaticInverter<TChild>, Id> : public detail::StaticParent<Id, TChild>
+    {
+    public:
+        static constexpr int id = Id;
+
+        Status Execute(BehaviorTreeContext& context) { return this->template ExecuteAs<StaticNode>(context); }
+
+        Status Tick(BehaviorTreeContext& context)
+        {
+            const Status status = std::get<0>(this->m_children).Execute(context);
+            if (status == Status::FAILURE) return Status::SUCCESS;
+            if (status == Status::SUCCESS) return Status::FAILURE;
+            return Status::INVALID;
+        }
+    };
+
+    template <typename TChild, int Id>
+    class StaticNode<StaticAlwaysSucceed<TChild>, Id> : public detail::StaticParent<Id, TChild>
+    {
+    public:
+        static constexpr int id = Id;
+
+        Status Execute(BehaviorTreeContext& context) { return this->template ExecuteAs<StaticNode>(context); }
+
+        Status Tick(BehaviorTreeContext& context)
+        {
+            std::get<0>(this->m_children).Execute(context);
+            return Status::SUCCESS;
+        }
+    };
+
+    template <typename TChild, int Id>
+    class StaticNode<StaticUntilFail<TChild>, Id> : public detail::StaticParent<Id, TChild>
+    {
+    public:
+        static constexpr int id = Id;
+
+        Status Execute(BehaviorTreeContext& context) { return this->template ExecuteAs<StaticNode>(context); }
+
+        Status Tick(BehaviorTreeContext& context)
+        {
+            const Status status = std::get<0>(this->m_children).Execute(context);
+            return status != Status::FAILURE ? Status::SUCCESS : Status::FAILURE;
+        }
+    };
+
+    template <typename TComparator, typename TChild, bool IsNegation, int Id>
+    class StaticNode<StaticComparison<TComparator, TChild, IsNegation>, Id> : public detail::StaticParent<Id, TChild>
+    {
+    public:
+        static constexpr int id = Id;
+
+        Status Execute(BehaviorTreeContext& context) { return this->template ExecuteAs<StaticNode>(context); }
+
+        Status Tick(BehaviorTreeContext& context)
+        {
+            if (m_comparator.ComparatorType::Evaluate(*context.blackboard) != IsNegation)
+            {
+                return std::get<0>(this->m_children).Execute(context);
+            }
+            return Status::FAILURE;
+        }
+
+        void BindLayout(const BlackboardLayout& layout)
+        {
+            m_comparator.BindLayout(layout);
+            detail::StaticParent<Id, TChild>::BindLayout(layout);
+        }
+
+    private:
+        using ComparatorType = decltype(TComparator::Create());
+        ComparatorType m_comparator = TComparator::Create();
+    };
+
+    /**
+     * \brief A behavior tree whose structure is a type, see StaticSequence. Every behavior is a member of the
+     * tree and every call between them is resolved at compile time, so the whole traversal can be inlined.
+     * The behaviors get the same ids as when the tree is built with BehaviorTreeBuilder, and execute with the
+     * same semantics, so the statuses and results of a context are the same as with the runtime tree. The number
+     * of statuses is a compile time constant, and the statuses are read at constant offsets.
+     * \tparam TRoot - the description of the root
+     */
+    template <typename TRoot>
+    class StaticBehaviorTree
+    {
+    public:
+        static constexpr size_t NodeCount = static_cast<size_t>(detail::StaticNodeCount<TRoot>::value);
+
+        /**
+         * \brief Execute the tree for a given context
+         * \param context - A behavior tree execution context
+         * \return - the status of the root
+         */
+        Status Execute(BehaviorTreeContext& context)
+        {
+            if (context.statuses.Size() < NodeCount)
+            {
+                context.statuses.Resize(NodeCount);
+            }
+
+            return m_root.Execute(context);
+        }
+
+        /**
+         * \brief Presize the statuses of a context for this tree and set them to INVALID, destroying the frames of
+         * its coroutine actions
+         * \param context - A behavior tree execution context
+         */
+        void InitializeContext(BehaviorTreeContext& context) const
+        {
+            context.statuses.Resize(NodeCount);
+            context.statuses.Clear();
+            context.coroutines.Clear();
+        }
+
+        /**
+         * \brief Resolve the blackboard keys used by the tree to the slots of a given layout
+         */
+        void BindLayout(const BlackboardLayout& layout) { m_root.BindLayout(layout); }
+
+        /**
+         * \brief Call a function for every action of the tree in preorder, e.g. to set their editor variables
+         * \param function - called as function(action) with a reference to the action
+         */
+        template <typename TFunction>
+        void ForEachAction(TFunction&& function) { m_root.ForEachAction(function); }
+
+        size_t GetNodeCount() const { return NodeCount; }
+
+        StaticNode<TRoot, 0>& GetRoot() { return m_root; }
+
+    private:
+        StaticNode<TRoot, 0> m_root{};
+    };
+}
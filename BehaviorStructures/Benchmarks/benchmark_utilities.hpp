@@ -0,0 +1,57 @@
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <limits>
+#include <utility>
+
+/**
+ * \brief Time a function, the best of a number of runs is kept so a descheduled run doesn't skew the result
+ * \param runs - how many times the function is run
+ * \param setup - called before every run, outside of the timed part
+ * \param function - the function to time
+ * \return - the shortest run in nanoseconds
+ */
+template <typename TSetup, typename TFunction>
+double MeasureNanoseconds(int runs, TSetup&& setup, TFunction&& function)
+{
+    double best = std::numeric_limits<double>::max();
+    for (int i = 0; i < runs; i++)
+    {
+        setup();
+        const auto start = std::chrono::steady_clock::now();
+        function();
+        const auto end = std::chrono::steady_clock::now();
+        best = std::min(best, std::chrono::duration<double, std::nano>(end - start).count());
+    }
+    return best;
+}
+
+/**
+ * \brief Time a function that doesn't need to be set up before every run
+ */
+template <typename TFunction>
+double MeasureNanoseconds(int runs, TFunction&& function)
+{
+    return MeasureNanoseconds(runs, []() {}, std::forward<TFunction>(function));
+}
+
+/**
+ * \brief Print the time of a benchmark per processed item next to its speedup over a baseline
+ * \param name - name of the benchmark
+ * \param nanoseconds - time of the whole run
+ * \param items - how many items the run processed
+ * \param baseline - time of the whole baseline run, the speedup isn't printed if it's 0
+ */
+inline void PrintResult(const char* name, double nanoseconds, size_t items, double baseline = 0.0)
+{
+    if (baseline > 0.0)
+    {
+        std::printf("%-40s %10.2f ns/item %8.2fx\n", name, nanoseconds / static_cast<double>(items),
+                    baseline / nanoseconds);
+    }
+    else
+    {
+        std::printf("%-40s %10.2f ns/item\n", name, nanoseconds / static_cast<double>(items));
+    }
+}
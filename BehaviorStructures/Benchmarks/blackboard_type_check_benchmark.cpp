@@ -0,0 +1,109 @@
+// Compares checking the type of a type erased blackboard value with dynamic_cast against comparing its
+// BlackboardTypeId. The handles are the polymorphic ones the blackboard used to store, holding values of four
+// types in a random order, so three out of four checks fail and the branch on the result can't be predicted.
+// The reads of the same values through Blackboard::TryGet, which checks the type id, are timed for reference.
+
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+#include "Blackboards/Blackboard.hpp"
+#include "Blackboards/BlackboardTypeId.hpp"
+#include "benchmark_utilities.hpp"
+
+namespace
+{
+    struct IHandle
+    {
+        explicit IHandle(fluczakAI::BlackboardTypeId id) : typeId(id) {}
+        virtual ~IHandle() = default;
+        const fluczakAI::BlackboardTypeId typeId;
+    };
+
+    template <typename T>
+    struct Handle : IHandle
+    {
+        explicit Handle(T data) : IHandle(fluczakAI::GetBlackboardTypeId<T>()), value(data) {}
+        T value;
+    };
+
+    template <typename T>
+    const Handle<T>* TypeIdCast(const IHandle* handle)
+    {
+        if (handle->typeId != fluczakAI::GetBlackboardTypeId<T>()) return nullptr;
+        return static_cast<const Handle<T>*>(handle);
+    }
+}
+
+int main()
+{
+    constexpr size_t handleCount = 4096;
+    constexpr int repetitions = 200;
+    constexpr int runs = 10;
+
+    std::mt19937 generator(42);
+    std::vector<std::unique_ptr<IHandle>> handles;
+    std::vector<fluczakAI::BlackboardKey> keys;
+    fluczakAI::Blackboard blackboard;
+    for (size_t i = 0; i < handleCount; i++)
+    {
+        const fluczakAI::BlackboardKey key("value" + std::to_string(i));
+        keys.push_back(key);
+        switch (generator() % 4)
+        {
+            case 0: handles.push_back(std::make_unique<Handle<int>>(1)); blackboard.SetData(key, 1); break;
+            case 1: handles.push_back(std::make_unique<Handle<float>>(1.0f)); blackboard.SetData(key, 1.0f); break;
+            case 2: handles.push_back(std::make_unique<Handle<bool>>(true)); blackboard.SetData(key, true); break;
+            default: handles.push_back(std::make_unique<Handle<double>>(1.0)); blackboard.SetData(key, 1.0); break;
+        }
+    }
+
+    const size_t items = handleCount * repetitions;
+    std::printf("%zu values of 4 types, each read as an int %d times\n", handleCount, repetitions);
+
+    volatile int sink = 0;
+    const double dynamicCast = MeasureNanoseconds(runs, [&]()
+    {
+        int sum = 0;
+        for (int repetition = 0; repetition < repetitions; repetition++)
+        {
+            for (const auto& handle : handles)
+            {
+                if (const auto* typed = dynamic_cast<const Handle<int>*>(handle.get())) sum += typed->value;
+            }
+        }
+        sink = sum;
+    });
+    PrintResult("dynamic_cast", dynamicCast, items);
+
+    const double typeId = MeasureNanoseconds(runs, [&]()
+    {
+        int sum = 0;
+        for (int repetition = 0; repetition < repetitions; repetition++)
+        {
+            for (const auto& handle : handles)
+            {
+                if (const auto* typed = TypeIdCast<int>(handle.get())) sum += typed->value;
+            }
+        }
+        sink = sum;
+    });
+    PrintResult("BlackboardTypeId compare", typeId, items, dynamicCast);
+
+    const double tryGet = MeasureNanoseconds(runs, [&]()
+    {
+        int sum = 0;
+        for (int repetition = 0; repetition < repetitions; repetition++)
+        {
+            for (const auto& key : keys)
+            {
+                if (const int* value = blackboard.TryGet<int>(key)) sum += *value;
+            }
+        }
+        sink = sum;
+    });
+    PrintResult("Blackboard::TryGet", tryGet, items, dynamicCast);
+
+    return 0;
+}
@@ -0,0 +1,125 @@
+// Evaluates a comparator for 1k, 10k and 100k agents, once per agent with Comparator::Evaluate on the agent's own
+// blackboard, once per agent with Comparator::Compare on a column of a BlackboardColumnStore and once for the whole
+// column with EvaluateBatch, which uses the SIMD kernels of ComparatorBatch.hpp. The values are random, so about
+// half of the agents pass and the scalar paths can't predict their branches.
+
+#include <bitset>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <vector>
+#include "Blackboards/Blackboard.hpp"
+#include "Blackboards/BlackboardColumnStore.hpp"
+#include "Blackboards/Comparator.hpp"
+#include "benchmark_utilities.hpp"
+
+namespace
+{
+    const fluczakAI::BlackboardKey valueKey("value");
+
+    size_t CountBits(const std::vector<uint64_t>& results)
+    {
+        size_t count = 0;
+        for (const uint64_t word : results) count += std::bitset<64>(word).count();
+        return count;
+    }
+
+    /**
+     * \brief Benchmark one type at one number of agents
+     * \param name - name of the type to print
+     * \param random - creates the value of an agent
+     * \param constant - the value the agents are compared against
+     */
+    template <typename T, typename TRandom>
+    void Run(const char* name, size_t agentCount, TRandom&& random, T constant)
+    {
+        constexpr int runs = 20;
+        // Enough repetitions that the smaller populations still take a measurable time
+        const size_t repetitions = 1000000 / agentCount;
+        const size_t items = agentCount * repetitions;
+
+        std::vector<std::unique_ptr<fluczakAI::Blackboard>> blackboards(agentCount);
+        fluczakAI::BlackboardColumnStore store(agentCount);
+        store.AddColumn<T>(valueKey);
+        T* column = store.GetColumn<T>(valueKey);
+        for (size_t i = 0; i < agentCount; i++)
+        {
+            column[i] = random();
+            blackboards[i] = std::make_unique<fluczakAI::Blackboard>();
+            blackboards[i]->SetData(valueKey, column[i]);
+        }
+
+        const fluczakAI::Comparator<T> comparator(valueKey, fluczakAI::ComparisonType::LESS, constant);
+        std::vector<uint64_t> results((agentCount + 63) / 64);
+        char label[64];
+
+        const auto clear = [&results]() { std::fill(results.begin(), results.end(), uint64_t{0}); };
+        const double evaluate = MeasureNanoseconds(runs, clear, [&]()
+        {
+            for (size_t repetition = 0; repetition < repetitions; repetition++)
+            {
+                for (size_t i = 0; i < agentCount; i++)
+                {
+                    results[i >> 6] |= static_cast<uint64_t>(comparator.Evaluate(*blackboards[i])) << (i & 63);
+                }
+            }
+        });
+        const size_t expected = CountBits(results);
+        std::snprintf(label, sizeof(label), "%s Evaluate, %zu agents", name, agentCount);
+        PrintResult(label, evaluate, items);
+
+        const double compare = MeasureNanoseconds(runs, clear, [&]()
+        {
+            for (size_t repetition = 0; repetition < repetitions; repetition++)
+            {
+                for (size_t i = 0; i < agentCount; i++)
+                {
+                    results[i >> 6] |= static_cast<uint64_t>(comparator.Compare(column[i])) << (i & 63);
+                }
+            }
+        });
+        std::snprintf(label, sizeof(label), "%s Compare column, %zu agents", name, agentCount);
+        PrintResult(label, compare, items, evaluate);
+
+        const double batch = MeasureNanoseconds(runs, [&]()
+        {
+            for (size_t repetition = 0; repetition < repetitions; repetition++)
+            {
+                comparator.EvaluateBatch(store, results.data());
+            }
+        });
+        std::snprintf(label, sizeof(label), "%s EvaluateBatch, %zu agents", name, agentCount);
+        PrintResult(label, batch, items, evaluate);
+
+        if (CountBits(results) != expected)
+        {
+            std::printf("%s: EvaluateBatch passed %zu agents instead of %zu\n", name, CountBits(results), expected);
+        }
+    }
+}
+
+int main()
+{
+#if defined(FLUCZAKAI_BATCH_AVX2)
+    std::printf("SIMD kernels: AVX2\n");
+#elif defined(FLUCZAKAI_BATCH_SSE2)
+    std::printf("SIMD kernels: SSE2\n");
+#else
+    std::printf("SIMD kernels: none\n");
+#endif
+
+    std::mt19937 generator(42);
+    std::uniform_real_distribution<float> floats(0.0f, 1.0f);
+    std::uniform_int_distribution<int> ints(0, 1000);
+    std::uniform_int_distribution<int> bools(0, 1);
+
+    for (const size_t agentCount : {size_t{1000}, size_t{10000}, size_t{100000}})
+    {
+        Run<float>("float", agentCount, [&]() { return floats(generator); }, 0.5f);
+        Run<int>("int", agentCount, [&]() { return ints(generator); }, 500);
+        Run<bool>("bool", agentCount, [&]() { return bools(generator) != 0; }, true);
+    }
+
+    return 0;
+}
@@ -0,0 +1,115 @@
+// Ticks a population of agents through the same tree with BehaviorTree::Execute, FlatBehaviorTree::Execute,
+// FlatBehaviorTree::Resume and BatchBehaviorTreeExecutor. Every agent fails the comparisons of most branches of
+// the root selector and sits in a long running action, the common case of a tree that mostly waits. The selector
+// isn't interrupting, so Resume goes straight to the running action.
+
+#include <vector>
+#include "BehaviorTrees/batch_behavior_tree_executor.hpp"
+#include "BehaviorTrees/behavior_tree.hpp"
+#include "BehaviorTrees/behavior_tree_builder.hpp"
+#include "BehaviorTrees/flat_behavior_tree.hpp"
+#include "benchmark_utilities.hpp"
+
+namespace
+{
+    const fluczakAI::BlackboardKey branchKey("branch");
+
+    class SucceedingAction : public fluczakAI::BehaviorTreeAction
+    {
+    public:
+        fluczakAI::Status Tick(fluczakAI::BehaviorTreeContext& context) override { return fluczakAI::Status::SUCCESS; }
+    };
+
+    class RunningAction : public fluczakAI::BehaviorTreeAction
+    {
+    public:
+        fluczakAI::Status Tick(fluczakAI::BehaviorTreeContext& context) override { return fluczakAI::Status::RUNNING; }
+    };
+
+    /**
+     * \brief A selector of branches guarded by comparisons of the "branch" key, each a sequence of actions that
+     * ends in a running action
+     */
+    std::unique_ptr<fluczakAI::BehaviorTree> BuildTree(int branches)
+    {
+        fluczakAI::BehaviorTreeBuilder builder;
+        builder.Selector();
+        for (int branch = 0; branch < branches; branch++)
+        {
+            builder.Comparison(fluczakAI::Comparator<int>(branchKey, fluczakAI::ComparisonType::EQUAL, branch));
+            builder.Sequence();
+            for (int i = 0; i < 3; i++)
+            {
+                builder.Action<SucceedingAction>().Back();
+            }
+            builder.Action<RunningAction>().Back();
+            builder.Back();
+            builder.Back();
+        }
+        return builder.End();
+    }
+}
+
+int main()
+{
+    constexpr int branches = 8;
+    constexpr size_t agentCount = 10000;
+    constexpr int ticks = 20;
+    constexpr int runs = 5;
+
+    const auto tree = BuildTree(branches);
+    const fluczakAI::FlatBehaviorTree flat(*tree);
+    fluczakAI::BatchBehaviorTreeExecutor executor(flat);
+
+    std::vector<fluczakAI::BehaviorTreeContext> contexts(agentCount);
+    const auto resetContexts = [&contexts, &tree]()
+    {
+        for (size_t i = 0; i < contexts.size(); i++)
+        {
+            contexts[i].blackboard->SetData(branchKey, static_cast<int>(i % branches));
+            contexts[i].statuses.Resize(tree->GetNodeCount());
+            tree->GetRoot()->Reset(contexts[i]);
+        }
+    };
+
+    const size_t items = agentCount * ticks;
+    std::printf("%zu agents, %d ticks, %zu behaviors\n", agentCount, ticks, tree->GetNodeCount());
+
+    const double object = MeasureNanoseconds(runs, resetContexts, [&]()
+    {
+        for (int tick = 0; tick < ticks; tick++)
+        {
+            for (auto& context : contexts) tree->Execute(context);
+        }
+    });
+    PrintResult("BehaviorTree::Execute", object, items);
+
+    const double flatExecute = MeasureNanoseconds(runs, resetContexts, [&]()
+    {
+        for (int tick = 0; tick < ticks; tick++)
+        {
+            for (auto& context : contexts) flat.Execute(context);
+        }
+    });
+    PrintResult("FlatBehaviorTree::Execute", flatExecute, items, object);
+
+    const double flatResume = MeasureNanoseconds(runs, resetContexts, [&]()
+    {
+        for (int tick = 0; tick < ticks; tick++)
+        {
+            for (auto& context : contexts) flat.Resume(context);
+        }
+    });
+    PrintResult("FlatBehaviorTree::Resume", flatResume, items, object);
+
+    const double batch = MeasureNanoseconds(runs, resetContexts, [&]()
+    {
+        for (int tick = 0; tick < ticks; tick++)
+        {
+            executor.Execute(contexts);
+        }
+    });
+    PrintResult("BatchBehaviorTreeExecutor::Execute", batch, items, object);
+
+    return 0;
+}
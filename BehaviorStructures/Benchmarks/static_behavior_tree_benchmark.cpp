@@ -0,0 +1,109 @@
+// Ticks a population of agents through the same tree described at compile time with StaticBehaviorTree and
+// built at runtime with BehaviorTreeBuilder. Every agent fails the comparisons of most branches of the root
+// selector and sits in a long running action.
+
+#include <utility>
+#include <vector>
+#include "BehaviorTrees/behavior_tree.hpp"
+#include "BehaviorTrees/behavior_tree_builder.hpp"
+#include "BehaviorTrees/static_behavior_tree.hpp"
+#include "benchmark_utilities.hpp"
+
+namespace
+{
+    constexpr int branches = 8;
+    const fluczakAI::BlackboardKey branchKey("branch");
+
+    class SucceedingAction : public fluczakAI::BehaviorTreeAction
+    {
+    public:
+        fluczakAI::Status Tick(fluczakAI::BehaviorTreeContext& context) override { return fluczakAI::Status::SUCCESS; }
+    };
+
+    class RunningAction : public fluczakAI::BehaviorTreeAction
+    {
+    public:
+        fluczakAI::Status Tick(fluczakAI::BehaviorTreeContext& context) override { return fluczakAI::Status::RUNNING; }
+    };
+
+    template <int Branch>
+    struct IsBranch
+    {
+        static fluczakAI::Comparator<int> Create() { return {branchKey, fluczakAI::ComparisonType::EQUAL, Branch}; }
+    };
+
+    template <int Branch>
+    using StaticBranch = fluczakAI::StaticComparison<IsBranch<Branch>,
+        fluczakAI::StaticSequence<SucceedingAction, SucceedingAction, SucceedingAction, RunningAction>>;
+
+    template <int... Branches>
+    fluczakAI::StaticSelector<StaticBranch<Branches>...> MakeSelector(std::integer_sequence<int, Branches...>);
+
+    using StaticTree = fluczakAI::StaticBehaviorTree<decltype(MakeSelector(std::make_integer_sequence<int, branches>()))>;
+
+    /**
+     * \brief The same tree as StaticTree
+     */
+    std::unique_ptr<fluczakAI::BehaviorTree> BuildTree()
+    {
+        fluczakAI::BehaviorTreeBuilder builder;
+        builder.Selector();
+        for (int branch = 0; branch < branches; branch++)
+        {
+            builder.Comparison(fluczakAI::Comparator<int>(branchKey, fluczakAI::ComparisonType::EQUAL, branch));
+            builder.Sequence();
+            for (int i = 0; i < 3; i++)
+            {
+                builder.Action<SucceedingAction>().Back();
+            }
+            builder.Action<RunningAction>().Back();
+            builder.Back();
+            builder.Back();
+        }
+        return builder.End();
+    }
+}
+
+int main()
+{
+    constexpr size_t agentCount = 10000;
+    constexpr int ticks = 20;
+    constexpr int runs = 5;
+
+    const auto tree = BuildTree();
+    StaticTree staticTree;
+    static_assert(StaticTree::NodeCount == 1 + branches * 6);
+
+    std::vector<fluczakAI::BehaviorTreeContext> contexts(agentCount);
+    for (size_t i = 0; i < contexts.size(); i++)
+    {
+        contexts[i].blackboard->SetData(branchKey, static_cast<int>(i % branches));
+    }
+    const auto resetContexts = [&contexts, &tree]()
+    {
+        for (auto& context : contexts) tree->InitializeContext(context);
+    };
+
+    const size_t items = agentCount * ticks;
+    std::printf("%zu agents, %d ticks, %zu behaviors\n", agentCount, ticks, tree->GetNodeCount());
+
+    const double runtime = MeasureNanoseconds(runs, resetContexts, [&]()
+    {
+        for (int tick = 0; tick < ticks; tick++)
+        {
+            for (auto& context : contexts) tree->Execute(context);
+        }
+    });
+    PrintResult("BehaviorTree::Execute", runtime, items);
+
+    const double compiled = MeasureNanoseconds(runs, resetContexts, [&]()
+    {
+        for (int tick = 0; tick < ticks; tick++)
+        {
+            for (auto& context : contexts) staticTree.Execute(context);
+        }
+    });
+    PrintResult("StaticBehaviorTree::Execute", compiled, items, runtime);
+
+    return 0;
+}
@@ -0,0 +1,137 @@
+// Scales ThreadPool and AgentScheduler from one thread up to the number of cores, or the number of threads given
+// as the first argument. A single thread is the serial loop every other count is compared against. The agents tick
+// the tree of flat_behavior_tree_benchmark, the fine grained loop runs one task per element of uneven cost, so it
+// mostly measures pushing to and stealing from the deques.
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+#include "BehaviorTrees/behavior_tree.hpp"
+#include "BehaviorTrees/behavior_tree_builder.hpp"
+#include "BehaviorTrees/flat_behavior_tree.hpp"
+#include "Scheduling/agent_scheduler.hpp"
+#include "benchmark_utilities.hpp"
+
+namespace
+{
+    constexpr int branches = 8;
+    const fluczakAI::BlackboardKey branchKey("branch");
+
+    class SucceedingAction : public fluczakAI::BehaviorTreeAction
+    {
+    public:
+        fluczakAI::Status Tick(fluczakAI::BehaviorTreeContext& context) override { return fluczakAI::Status::SUCCESS; }
+    };
+
+    class RunningAction : public fluczakAI::BehaviorTreeAction
+    {
+    public:
+        fluczakAI::Status Tick(fluczakAI::BehaviorTreeContext& context) override { return fluczakAI::Status::RUNNING; }
+    };
+
+    std::unique_ptr<fluczakAI::BehaviorTree> BuildTree()
+    {
+        fluczakAI::BehaviorTreeBuilder builder;
+        builder.Selector();
+        for (int branch = 0; branch < branches; branch++)
+        {
+            builder.Comparison(fluczakAI::Comparator<int>(branchKey, fluczakAI::ComparisonType::EQUAL, branch));
+            builder.Sequence();
+            for (int i = 0; i < 3; i++)
+            {
+                builder.Action<SucceedingAction>().Back();
+            }
+            builder.Action<RunningAction>().Back();
+            builder.Back();
+            builder.Back();
+        }
+        return builder.End();
+    }
+
+    /**
+     * \brief Work that grows with the index, so later chunks cost more than earlier ones
+     */
+    void UnevenWork(size_t index, std::vector<double>& results)
+    {
+        double sum = 0.0;
+        for (size_t i = 0; i < 64 + index % 512; i++) sum += static_cast<double>(i) * 0.5;
+        results[index] = sum;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    constexpr size_t agentCount = 100000;
+    constexpr size_t elementCount = 20000;
+    constexpr int ticks = 10;
+    constexpr int runs = 5;
+
+    size_t maxThreads = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : std::thread::hardware_concurrency();
+    maxThreads = std::max<size_t>(1, maxThreads);
+
+    const auto tree = BuildTree();
+    const fluczakAI::FlatBehaviorTree flat(*tree);
+    std::vector<fluczakAI::BehaviorTreeContext> contexts(agentCount);
+    const auto resetContexts = [&contexts, &tree]()
+    {
+        for (size_t i = 0; i < contexts.size(); i++)
+        {
+            contexts[i].blackboard->SetData(branchKey, static_cast<int>(i % branches));
+            tree->InitializeContext(contexts[i]);
+        }
+    };
+    std::vector<double> results(elementCount);
+
+    std::printf("%zu agents, %d ticks, %zu elements, up to %zu threads\n", agentCount, ticks, elementCount, maxThreads);
+
+    const double serialTicks = MeasureNanoseconds(runs, resetContexts, [&]()
+    {
+        for (int tick = 0; tick < ticks; tick++)
+        {
+            for (auto& context : contexts) flat.Execute(context);
+        }
+    });
+    const double serialLoop = MeasureNanoseconds(runs, [&]()
+    {
+        for (size_t i = 0; i < elementCount; i++) UnevenWork(i, results);
+    });
+
+    char name[64];
+    for (size_t threads = 1; threads <= maxThreads; threads++)
+    {
+        if (threads == 1)
+        {
+            PrintResult("AgentScheduler::Tick, 1 thread", serialTicks, agentCount * ticks, serialTicks);
+            PrintResult("ParallelFor chunks of 1, 1 thread", serialLoop, elementCount, serialLoop);
+            continue;
+        }
+
+        // The calling thread is the last worker
+        fluczakAI::ThreadPool pool(threads - 1);
+        fluczakAI::AgentScheduler scheduler(pool);
+
+        const double scheduled = MeasureNanoseconds(runs, resetContexts, [&]()
+        {
+            for (int tick = 0; tick < ticks; tick++)
+            {
+                scheduler.Tick(flat, contexts.data(), contexts.size());
+            }
+        });
+        std::snprintf(name, sizeof(name), "AgentScheduler::Tick, %zu threads", threads);
+        PrintResult(name, scheduled, agentCount * ticks, serialTicks);
+
+        const double parallel = MeasureNanoseconds(runs, [&]()
+        {
+            pool.ParallelFor(elementCount, 1, [&results](size_t begin, size_t end, fluczakAI::WorkerContext&)
+            {
+                for (size_t i = begin; i < end; i++) UnevenWork(i, results);
+            });
+        });
+        std::snprintf(name, sizeof(name), "ParallelFor chunks of 1, %zu threads", threads);
+        PrintResult(name, parallel, elementCount, serialLoop);
+    }
+
+    return 0;
+}
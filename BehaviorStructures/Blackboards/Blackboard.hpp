@@ -1,12 +1,22 @@
 #pragma once
 
+#include <algorithm>
 #include <memory>
 #include <optional>
 #include <string>
-#include <unordered_map>
+#include <string_view>
+#include <type_traits>
+#include <vector>
 #include <cassert>
+#include <cstring>
+#include <limits>
 #include <sstream>
+#include <utility>
 
+#include "BlackboardArena.hpp"
+#include "BlackboardKey.hpp"
+#include "BlackboardLayout.hpp"
+#include "BlackboardTypeId.hpp"
 
 namespace fluczakAI
 {
@@ -36,51 +46,233 @@ namespace fluczakAI
         static constexpr bool value = decltype(Test<T>(0))::value;
     };
 
+    template <typename TSchema>
+    class BlackboardSchema;
+
+    /**
+     * \brief A key-value store shared by the behaviors of a single agent. Values are kept in a flat
+     * open-addressing table: small trivially copyable values (float, int, bool...) are stored inline in
+     * the table, everything else lives in an arena owned by the blackboard. Pointers and references to
+     * inline values are invalidated when a new key is added.
+     * A blackboard can additionally use a schema (see BlackboardSchema), keys of the schema are then stored
+     * at constant offsets of a single block instead of the table.
+     * Blackboards can be layered: keys missing in a blackboard are looked up in its parent, which can be
+     * shared by many agents. Writes always go to the blackboard they are made on, shadowing the value
+     * of the parent, unless they are made with SetSharedData.
+     */
     class Blackboard
     {
     public:
+        Blackboard() = default;
+        Blackboard(const Blackboard&) = delete;
+        Blackboard& operator=(const Blackboard&) = delete;
+
+        Blackboard(Blackboard&& other) noexcept { *this = std::move(other); }
+        ~Blackboard() { UnsubscribeFromParent(); }
+
+        Blackboard& operator=(Blackboard&& other) noexcept
+        {
+            if (this == &other) return *this;
+
+            // The subscriptions replaced below were forwarded to the old parent, which can outlive this blackboard
+            UnsubscribeFromParent();
+
+            m_slots = std::move(other.m_slots);
+            m_capacityLog2 = std::exchange(other.m_capacityLog2, 0);
+            m_size = std::exchange(other.m_size, 0);
+            m_generation = std::exchange(other.m_generation, 1);
+            m_layout = std::exchange(other.m_layout, nullptr);
+            m_layoutData = std::exchange(other.m_layoutData, nullptr);
+            m_layoutRow = std::exchange(other.m_layoutRow, 0);
+            m_ownsLayoutData = std::exchange(other.m_ownsLayoutData, false);
+            m_layoutVersions = std::exchange(other.m_layoutVersions, nullptr);
+            m_epoch = std::exchange(other.m_epoch, 0);
+            m_clearEpoch = std::exchange(other.m_clearEpoch, 0);
+            m_subscriptions = std::move(other.m_subscriptions);
+            m_nextSubscriptionId = other.m_nextSubscriptionId;
+            m_parent = std::move(other.m_parent);
+            m_arena = std::move(other.m_arena);
+            other.m_slots.clear();
+            other.m_subscriptions.clear();
+            return *this;
+        }
+
+        /**
+         * \brief A function called when the value of a subscribed key changes
+         * \param userData - the pointer passed to Subscribe
+         * \param key - the key that changed
+         */
+        using ChangeCallback = void (*)(void* userData, const BlackboardKey& key);
+        using SubscriptionId = uint32_t;
+        static constexpr SubscriptionId InvalidSubscription = std::numeric_limits<SubscriptionId>::max();
+
         /**
          * \brief Sets the data at given key to a given value of TVAlueType. If the value is already there, replace it with
-         * a new value.
-         * \tparam TValueType - the type of the value that is going to be set
+         * a new value. The value is forwarded, so rvalues are moved into the blackboard and updating an existing key
+         * assigns to the stored value in place without allocating.
+         * \tparam TValueType - the type of the value that is going to be set, deduced from the value if omitted
          * \param key - the key where the value is located in the blackboard.
          * \param value - the value of type TValueType
          */
-        template <typename TValueType>
-        void SetData(const std::string& key, TValueType value)
+        template <typename TValueType = void, typename TArg>
+        void SetData(const BlackboardKey& key, TArg&& value)
         {
-            assert(!std::is_reference<TValueType>());
+            using TStoredType = std::conditional_t<std::is_void_v<TValueType>, std::decay_t<TArg>, TValueType>;
+            Emplace<TStoredType>(key, std::forward<TArg>(value));
+        }
 
-            if (m_Map.find(key) != m_Map.end())
+        /**
+         * \brief A convenience overload of SetData that interns the key on every call. Interning an existing key
+         * doesn't allocate, but prefer keeping a BlackboardKey around in code that runs every tick.
+         */
+        template <typename TValueType = void, typename TArg>
+        void SetData(std::string_view key, TArg&& value)
+        {
+            SetData<TValueType>(BlackboardKey(key), std::forward<TArg>(value));
+        }
+
+        /**
+         * \brief Construct a value of TValueType at given key from 'args'. The key is looked up once, if it's already
+         * set the stored value is assigned to instead.
+         * \tparam TValueType - the type of the value that is going to be set
+         * \param key - the key where the value is located in the blackboard.
+         * \param args - arguments of the constructor of TValueType
+         * \return - a reference to the value inside the blackboard
+         */
+        template <typename TValueType, typename... TArgs>
+        TValueType& Emplace(const BlackboardKey& key, TArgs&&... args)
+        {
+            static_assert(!std::is_reference_v<TValueType>);
+
+            TValueType* value = nullptr;
+            if (const auto* layoutSlot = FindLayoutSlot(key))
             {
-                static_cast<Handle<TValueType>*>(m_Map[key].get())->SetData(value);
+                // A key of the schema can't be set to a value of a different type
+                assert(layoutSlot->typeId == GetBlackboardTypeId<TValueType>());
+                value = GetLayoutValue<TValueType>(layoutSlot->offset, layoutSlot->stride);
+                AssignValue(*value, std::forward<TArgs>(args)...);
+                LayoutVersion(layoutSlot) = ++m_epoch;
             }
             else
             {
-                m_Map[key] = std::make_unique<Handle<TValueType>>(Handle<TValueType>(std::move(value)));
+                bool inserted = false;
+                Slot& slot = FindOrInsertSlot(key, GetBlackboardTypeId<TValueType>(), inserted);
+                if (inserted)
+                {
+                    slot.isInline = IsStoredInline<TValueType>();
+                    if constexpr (IsStoredInline<TValueType>())
+                    {
+                        new (slot.inlineData) TValueType(std::forward<TArgs>(args)...);
+                    }
+                    else
+                    {
+                        slot.external = m_arena.Create<TValueType>(std::forward<TArgs>(args)...);
+                    }
+                }
+                else
+                {
+                    // A key can't change the type of its value once it has been set
+                    assert(slot.typeId == GetBlackboardTypeId<TValueType>());
+                    AssignValue(*SlotValue<TValueType>(slot), std::forward<TArgs>(args)...);
+                }
+
+                slot.version = ++m_epoch;
+                value = SlotValue<TValueType>(slot);
             }
+
+            if (!m_subscriptions.empty())
+            {
+                Notify(key);
+            }
+
+            return *value;
+        }
+
+        /**
+         * \brief A string overload of Emplace, the key is interned on every call
+         */
+        template <typename TValueType, typename... TArgs>
+        TValueType& Emplace(std::string_view key, TArgs&&... args)
+        {
+            return Emplace<TValueType>(BlackboardKey(key), std::forward<TArgs>(args)...);
+        }
+
+        /**
+         * \brief Set the value of a key in a shared layer instead of this blackboard. The value is written to the
+         * closest parent that already has the key, or to the direct parent if none of them do.
+         * \tparam TValueType - the type of the value that is going to be set
+         * \param key - the key where the value is located in the blackboard.
+         * \param value - the value of type TValueType
+         */
+        template <typename TValueType = void, typename TArg>
+        void SetSharedData(const BlackboardKey& key, TArg&& value)
+        {
+            assert(m_parent != nullptr);
+
+            Blackboard* layer = m_parent.get();
+            while (!layer->HasLocalKey(key) && layer->m_parent != nullptr)
+            {
+                layer = layer->m_parent.get();
+            }
+
+            if (!layer->HasLocalKey(key)) layer = m_parent.get();
+            layer->SetData<TValueType>(key, std::forward<TArg>(value));
         }
 
         /**
          * \brief Get reference to an element of a key 'key'
          * \tparam TValueType - The type of value that is set for the key
          * \param key - key of the value
-         * \return - a reference to the element inside the blackboard.
+         * \return - a reference to the element inside the blackboard. It can belong to a parent blackboard,
+         * use GetMutableData to modify a value without affecting the other users of the parent.
          */
         template <typename TValueType>
-        TValueType& GetData(const std::string& key) const
+        TValueType& GetData(const BlackboardKey& key) const
         {
-            const auto it = m_Map.find(key);
+            if (const auto* layoutSlot = FindLayoutSlot(key))
+            {
+                assert(layoutSlot->typeId == GetBlackboardTypeId<TValueType>());
+                return *GetLayoutValue<TValueType>(layoutSlot->offset, layoutSlot->stride);
+            }
+
+            Slot* slot = FindSlot(key);
 
-            assert(it != m_Map.end());
+            if (slot == nullptr && m_parent != nullptr) return m_parent->GetData<TValueType>(key);
 
-            auto* handle = dynamic_cast<Handle<TValueType>*>(it->second.get());
+            assert(slot != nullptr);
 
             // TValueType needs to be of the same type as the value in the blackboard
-            assert(handle != nullptr);
+            assert(slot->typeId == GetBlackboardTypeId<TValueType>());
+
+            return *SlotValue<TValueType>(*slot);
+        }
 
+        /**
+         * \brief A string overload of GetData, the key is interned on every call
+         */
+        template <typename TValueType>
+        TValueType& GetData(std::string_view key) const
+        {
+            return GetData<TValueType>(BlackboardKey(key));
+        }
 
-            return *handle->get();
+        /**
+         * \brief Get a reference to a value that belongs to this blackboard. If the value is only set in a
+         * parent blackboard, it is copied into this one first. Like GetData, the key has to be set in this
+         * blackboard or one of its parents.
+         * \tparam TValueType - The type of value that is set for the key
+         * \param key - key of the value
+         * \return - a reference to the element inside this blackboard
+         */
+        template <typename TValueType>
+        TValueType& GetMutableData(const BlackboardKey& key)
+        {
+            if (!HasLocalKey(key) && m_parent != nullptr)
+            {
+                SetData(key, m_parent->GetData<TValueType>(key));
+            }
+
+            return GetData<TValueType>(key);
         }
 
         /**
@@ -91,17 +283,30 @@ namespace fluczakAI
          * \return - a pointer to element or nullptr
          */
         template <typename TValueType>
-        TValueType* const TryGet(const std::string& key) const
+        TValueType* const TryGet(const BlackboardKey& key) const
         {
-            const auto it = m_Map.find(key);
+            if (const auto* layoutSlot = FindLayoutSlot(key))
+            {
+                if (layoutSlot->typeId != GetBlackboardTypeId<TValueType>()) return nullptr;
+                return GetLayoutValue<TValueType>(layoutSlot->offset, layoutSlot->stride);
+            }
+
+            Slot* slot = FindSlot(key);
 
-            if (it == m_Map.end()) return nullptr;
+            if (slot == nullptr) return m_parent != nullptr ? m_parent->TryGet<TValueType>(key) : nullptr;
 
-            auto* handle = dynamic_cast<Handle<TValueType>*>(it->second.get());
+            if (slot->typeId != GetBlackboardTypeId<TValueType>()) return nullptr;
 
-            if (handle == nullptr) return nullptr;
+            return SlotValue<TValueType>(*slot);
+        }
 
-            return handle->get();
+        /**
+         * \brief A string overload of TryGet, the key is interned on every call
+         */
+        template <typename TValueType>
+        TValueType* const TryGet(std::string_view key) const
+        {
+            return TryGet<TValueType>(BlackboardKey(key));
         }
 
         /**
@@ -110,44 +315,509 @@ namespace fluczakAI
          * \return - whether or not the key has a value set inside the blackboard
          */
         template <typename TValueType>
-        bool HasKey(const std::string& key) const
+        bool HasKey(const BlackboardKey& key) const
         {
-            const auto it = m_Map.find(key);
+            if (const auto* layoutSlot = FindLayoutSlot(key))
+            {
+                return layoutSlot->typeId == GetBlackboardTypeId<TValueType>();
+            }
 
-            if (it == m_Map.end()) return false;
+            const Slot* slot = FindSlot(key);
 
-            auto* handle = dynamic_cast<Handle<TValueType>*>(it->second.get());
+            if (slot == nullptr) return m_parent != nullptr && m_parent->HasKey<TValueType>(key);
 
-            if (handle == nullptr) return false;
+            return slot->typeId == GetBlackboardTypeId<TValueType>();
+        }
 
-            return true;
+        /**
+         * \brief A string overload of HasKey, the key is interned on every call
+         */
+        template <typename TValueType>
+        bool HasKey(std::string_view key) const
+        {
+            return HasKey<TValueType>(BlackboardKey(key));
         }
 
         /**
-         * \brief Clear all of the values of the blackboard
+         * \brief Clear all of the values of the blackboard. The table and the arena keep their memory, so
+         * this is O(1) unless the blackboard holds values that need their destructor called. Values of a
+         * layout bound with BindLayout belong to their owner and are left untouched, see ResetLayoutValues.
          */
         void Clear()
         {
-            m_Map.clear();
+            m_arena.Reset();
+            m_size = 0;
+            m_generation++;
+            m_clearEpoch = ++m_epoch;
+
+            if (m_layout != nullptr)
+            {
+                AllocateLayoutData();
+            }
+
+            // Once in four billion clears the generation wraps around and stale slots would look alive again
+            if (m_generation == 0)
+            {
+                for (auto& slot : m_slots) slot.generation = 0;
+                m_generation = 1;
+            }
+
+            for (size_t i = 0; i < m_subscriptions.size(); i++)
+            {
+                const Subscription subscription = m_subscriptions[i];
+                subscription.callback(subscription.userData, subscription.key);
+            }
+        }
+
+        /**
+         * \brief Get the number of values set in the blackboard
+         */
+        size_t Size() const { return m_size; }
+
+        /**
+         * \brief Get the version of a value. Every write to a key gives it a version higher than any version
+         * handed out by the blackboard before, so a caller can store the version of a value it has read and
+         * skip its work while the version stays the same.
+         * For layered blackboards the versions of the key in every layer are added up, so writes to the
+         * parents are noticed as well.
+         * \param key - the key of the value
+         * \return - version of the value, a key that isn't set reports the epoch of the last Clear()
+         */
+        uint64_t GetVersion(const BlackboardKey& key) const
+        {
+            const uint64_t parentVersion = m_parent != nullptr ? m_parent->GetVersion(key) : 0;
+            if (const auto* layoutSlot = FindLayoutSlot(key)) return LayoutVersion(layoutSlot) + parentVersion;
+            if (const Slot* slot = FindSlot(key)) return slot->version + parentVersion;
+            return m_clearEpoch + parentVersion;
+        }
+
+        /**
+         * \brief Get the epoch of the blackboard. It grows on every write to any key of this blackboard or
+         * its parents, so an unchanged epoch means that nothing in the blackboard has changed.
+         */
+        uint64_t GetEpoch() const { return m_parent != nullptr ? m_epoch + m_parent->GetEpoch() : m_epoch; }
+
+        /**
+         * \brief Bump the version of a key without setting it. Needs to be called after a value is modified
+         * through a reference (GetData, TryGet or GetSchemaData) for observers to notice the change.
+         * \param key - the key that was modified
+         */
+        void MarkChanged(const BlackboardKey& key)
+        {
+            if (const auto* layoutSlot = FindLayoutSlot(key))
+            {
+                LayoutVersion(layoutSlot) = ++m_epoch;
+            }
+            else if (Slot* slot = FindSlot(key))
+            {
+                slot->version = ++m_epoch;
+            }
+            else
+            {
+                return;
+            }
+
+            if (!m_subscriptions.empty())
+            {
+                Notify(key);
+            }
+        }
+
+        /**
+         * \brief Register a callback called every time the value of a key changes. Callbacks are called from
+         * within SetData, so they should be cheap, e.g. flag the subscriber as dirty. A callback can't
+         * subscribe, unsubscribe or write to the blackboard. The subscription also observes the key in the parents of the blackboard.
+         * \param key - the key to observe
+         * \param callback - a function called with userData and the key
+         * \param userData - a pointer passed back to the callback
+         * \return - an id used to unsubscribe
+         */
+        SubscriptionId Subscribe(const BlackboardKey& key, ChangeCallback callback, void* userData)
+        {
+            const SubscriptionId id = m_nextSubscriptionId++;
+            const SubscriptionId parentId = m_parent != nullptr ? m_parent->Subscribe(key, callback, userData) : InvalidSubscription;
+            m_subscriptions.push_back({id, key, callback, userData, parentId});
+            return id;
+        }
+
+        /**
+         * \brief Remove a subscription created with Subscribe
+         * \param id - id of the subscription
+         */
+        void Unsubscribe(SubscriptionId id)
+        {
+            for (size_t i = 0; i < m_subscriptions.size(); i++)
+            {
+                if (m_subscriptions[i].id != id) continue;
+                if (m_parent != nullptr) m_parent->Unsubscribe(m_subscriptions[i].parentId);
+                m_subscriptions[i] = m_subscriptions.back();
+                m_subscriptions.pop_back();
+                return;
+            }
+        }
+
+        /**
+         * \brief Set the blackboard keys are looked up in when they are not set in this blackboard. The parent
+         * can be shared by many blackboards and have a parent of its own. Existing subscriptions are moved
+         * over to the new parent.
+         * \param parent - the parent blackboard, nullptr to remove the parent
+         */
+        void SetParent(std::shared_ptr<Blackboard> parent)
+        {
+            for (auto& subscription : m_subscriptions)
+            {
+                if (m_parent != nullptr) m_parent->Unsubscribe(subscription.parentId);
+                subscription.parentId = parent != nullptr ? parent->Subscribe(subscription.key, subscription.callback, subscription.userData) : InvalidSubscription;
+            }
+
+            m_parent = std::move(parent);
+        }
+
+        /**
+         * \brief A getter for the parent of the blackboard, nullptr if it doesn't have one
+         */
+        const std::shared_ptr<Blackboard>& GetParent() const { return m_parent; }
+
+        /**
+         * \brief Whether or not a key is set in this blackboard itself, ignoring its parents
+         * \param key - the key to check
+         */
+        bool HasLocalKey(const BlackboardKey& key) const
+        {
+            return FindLayoutSlot(key) != nullptr || FindSlot(key) != nullptr;
+        }
+
+        /**
+         * \brief Start storing the keys of schema TSchema at constant offsets. The values of the schema are
+         * initialized to the values of a default constructed TSchema. Has to be called before any of the
+         * keys of the schema are set.
+         * \tparam TSchema - a visitable struct describing the schema
+         * \return - a reference to the values of the schema
+         */
+        template <typename TSchema>
+        TSchema& UseSchema()
+        {
+            m_layout = &BlackboardSchema<TSchema>::Instance();
+            m_layoutRow = 0;
+            m_ownsLayoutData = true;
+            AllocateLayoutData();
+            return GetSchemaData<TSchema>();
+        }
+
+        /**
+         * \brief Get the values of the schema the blackboard uses. Accessing a member of the returned struct
+         * is a constant offset read. Writes through the struct don't bump versions, see MarkChanged.
+         * \tparam TSchema - the schema passed to UseSchema
+         * \return - a reference to the values of the schema
+         */
+        template <typename TSchema>
+        TSchema& GetSchemaData() const
+        {
+            assert(m_layout == &BlackboardSchema<TSchema>::Instance());
+            return *std::launder(reinterpret_cast<TSchema*>(m_layoutData));
+        }
+
+        /**
+         * \brief Make the blackboard a view of values stored outside of it, e.g. a row of a
+         * BlackboardColumnStore. Keys of the layout are read and written at
+         * data + slot offset + row * slot stride, the rest of the keys are stored in the blackboard as usual.
+         * \param layout - the layout of the external values
+         * \param data - the memory the layout offsets are relative to, it has to outlive the binding
+         * \param row - the row of the values that belongs to this blackboard
+         */
+        void BindLayout(const BlackboardLayout& layout, unsigned char* data, size_t row)
+        {
+            m_layout = &layout;
+            m_layoutData = data;
+            m_layoutRow = row;
+            m_ownsLayoutData = false;
+            AllocateLayoutData();
+        }
+
+        /**
+         * \brief Set the values of the layout back to the defaults of the layout, e.g. the row of a recycled agent
+         * bound with BindLayout, which Clear leaves to its owner. The values get new versions.
+         */
+        void ResetLayoutValues()
+        {
+            if (m_layout == nullptr) return;
+
+            m_layout->WriteDefaults(m_layoutData, m_layoutRow);
+            std::fill_n(m_layoutVersions, m_layout->GetSlotCount(), ++m_epoch);
+
+            for (size_t i = 0; i < m_subscriptions.size(); i++)
+            {
+                const Subscription subscription = m_subscriptions[i];
+                if (FindLayoutSlot(subscription.key) == nullptr) continue;
+                subscription.callback(subscription.userData, subscription.key);
+            }
+        }
+
+        /**
+         * \brief A getter for the layout the blackboard uses, nullptr if it doesn't use one
+         */
+        const BlackboardLayout* GetLayout() const { return m_layout; }
+
+        /**
+         * \brief Get a value stored in the layout of the blackboard by its offset. This is the fast path for
+         * callers that have resolved a key to a layout slot in advance.
+         * \tparam TValueType - type of the value in the slot
+         * \param offset - offset of the slot
+         * \param stride - stride of the slot
+         * \return - a pointer to the value
+         */
+        template <typename TValueType>
+        TValueType* GetLayoutValue(size_t offset, size_t stride) const
+        {
+            return std::launder(reinterpret_cast<TValueType*>(m_layoutData + offset + m_layoutRow * stride));
+        }
+
+        /**
+         * \brief Call a function for every value set in this blackboard, ignoring its parents. Used to save the
+         * values without knowing their types in advance.
+         * \param callback - called with the key, the type id and a pointer to each value
+         */
+        template <typename TCallback>
+        void ForEachLocalValue(TCallback&& callback) const
+        {
+            if (m_layout != nullptr)
+            {
+                for (size_t i = 0; i < m_layout->GetSlotCount(); i++)
+                {
+                    const auto& layoutSlot = m_layout->GetSlot(static_cast<int>(i));
+                    callback(layoutSlot.key, layoutSlot.typeId, static_cast<const void*>(m_layoutData + layoutSlot.offset + m_layoutRow * layoutSlot.stride));
+                }
+            }
+
+            if (m_size == 0) return;
+
+            for (const auto& slot : m_slots)
+            {
+                if (slot.generation != m_generation) continue;
+                const void* value = slot.isInline ? static_cast<const void*>(slot.inlineData) : slot.external;
+                callback(BlackboardKey::FromId(slot.key), slot.typeId, value);
+            }
         }
 
         std::vector<std::pair<std::string, std::string>> PreviewToString();
     private:
-        struct IHandle
+        static constexpr size_t InlineSize = 16;
+        static constexpr size_t MinCapacity = 16;
+
+        struct Subscription
         {
-            virtual ~IHandle() = default;
+            SubscriptionId id;
+            BlackboardKey key;
+            ChangeCallback callback;
+            void* userData;
+            SubscriptionId parentId;
         };
 
-        template <typename T>
-        struct Handle : IHandle
+        struct Slot
         {
-            Handle(T data) : m_Data(std::move(data)) {}
-            T* get() { return &(m_Data); }
-        	void SetData(T& t) { m_Data = t; }
-        private:
-            T m_Data;
+            uint32_t key = BlackboardKeyRegistry::InvalidId;
+            BlackboardTypeId typeId = 0;
+            // A slot is only occupied when its generation matches the generation of the blackboard
+            uint32_t generation = 0;
+            bool isInline = false;
+            uint64_t version = 0;
+            union
+            {
+                alignas(8) unsigned char inlineData[InlineSize];
+                void* external;
+            };
         };
 
-        std::unordered_map<std::string, std::unique_ptr<IHandle>> m_Map;
+        /**
+         * \brief Whether or not values of type T are stored directly inside of the table
+         */
+        template <typename T>
+        static constexpr bool IsStoredInline()
+        {
+            return std::is_trivially_copyable_v<T> && sizeof(T) <= InlineSize && alignof(T) <= 8;
+        }
+
+        template <typename T>
+        static T* SlotValue(Slot& slot)
+        {
+            if constexpr (IsStoredInline<T>())
+            {
+                return std::launder(reinterpret_cast<T*>(slot.inlineData));
+            }
+            else
+            {
+                return static_cast<T*>(slot.external);
+            }
+        }
+
+        size_t SlotIndex(uint32_t key) const
+        {
+            // Fibonacci hashing spreads the sequential key ids over the table
+            return static_cast<size_t>((key * 2654435769u) >> (32 - m_capacityLog2));
+        }
+
+        Slot* FindSlot(const BlackboardKey& key) const
+        {
+            if (m_size == 0) return nullptr;
+
+            size_t index = SlotIndex(key.GetId());
+            while (true)
+            {
+                Slot& slot = m_slots[index];
+                if (slot.generation != m_generation) return nullptr;
+                if (slot.key == key.GetId()) return &slot;
+                index = (index + 1) & (m_slots.size() - 1);
+            }
+        }
+
+        const BlackboardLayout::Slot* FindLayoutSlot(const BlackboardKey& key) const
+        {
+            if (m_layout == nullptr) return nullptr;
+
+            const int index = m_layout->FindSlot(key);
+            if (index == BlackboardLayout::InvalidSlot) return nullptr;
+
+            return &m_layout->GetSlot(index);
+        }
+
+        uint64_t& LayoutVersion(const BlackboardLayout::Slot* layoutSlot) const
+        {
+            return m_layoutVersions[layoutSlot - &m_layout->GetSlot(0)];
+        }
+
+        void AllocateLayoutData()
+        {
+            if (m_ownsLayoutData)
+            {
+                m_layoutData = static_cast<unsigned char*>(m_arena.Allocate(m_layout->GetBlockSize(), m_layout->GetBlockAlignment()));
+                std::memcpy(m_layoutData, m_layout->GetDefaultBlock(), m_layout->GetBlockSize());
+            }
+
+            m_layoutVersions = static_cast<uint64_t*>(m_arena.Allocate(sizeof(uint64_t) * m_layout->GetSlotCount(), alignof(uint64_t)));
+            std::fill_n(m_layoutVersions, m_layout->GetSlotCount(), m_epoch);
+        }
+
+        void Notify(const BlackboardKey& key) const
+        {
+            for (size_t i = 0; i < m_subscriptions.size(); i++)
+            {
+                const Subscription& subscription = m_subscriptions[i];
+                if (subscription.key != key) continue;
+                subscription.callback(subscription.userData, key);
+            }
+        }
+
+        /**
+         * \brief Remove the subscriptions forwarded to the parent, before the ones of this blackboard are dropped
+         */
+        void UnsubscribeFromParent()
+        {
+            if (m_parent == nullptr) return;
+            for (const Subscription& subscription : m_subscriptions)
+            {
+                m_parent->Unsubscribe(subscription.parentId);
+            }
+        }
+
+        /**
+         * \brief Find the slot of a key, claiming an empty slot for it if the key isn't in the table yet.
+         * The table is probed once, unless it has to grow to fit the new key.
+         * \param inserted - set to whether or not the slot was claimed and still needs a value constructed in it
+         */
+        Slot& FindOrInsertSlot(const BlackboardKey& key, BlackboardTypeId typeId, bool& inserted)
+        {
+            inserted = false;
+            if (!m_slots.empty())
+            {
+                size_t index = SlotIndex(key.GetId());
+                while (m_slots[index].generation == m_generation)
+                {
+                    if (m_slots[index].key == key.GetId()) return m_slots[index];
+                    index = (index + 1) & (m_slots.size() - 1);
+                }
+
+                if ((m_size + 1) * 4 <= m_slots.size() * 3)
+                {
+                    inserted = true;
+                    return ClaimSlot(m_slots[index], key, typeId);
+                }
+            }
+
+            Grow();
+
+            size_t index = SlotIndex(key.GetId());
+            while (m_slots[index].generation == m_generation)
+            {
+                index = (index + 1) & (m_slots.size() - 1);
+            }
+
+            inserted = true;
+            return ClaimSlot(m_slots[index], key, typeId);
+        }
+
+        Slot& ClaimSlot(Slot& slot, const BlackboardKey& key, BlackboardTypeId typeId)
+        {
+            slot.key = key.GetId();
+            slot.typeId = typeId;
+            slot.generation = m_generation;
+            m_size++;
+            return slot;
+        }
+
+        /**
+         * \brief Assign a new value to a stored one. A single argument is assigned directly, so e.g. a string
+         * can reuse its buffer instead of being replaced by a newly constructed one.
+         */
+        template <typename TValueType, typename... TArgs>
+        static void AssignValue(TValueType& value, TArgs&&... args)
+        {
+            if constexpr (sizeof...(TArgs) == 1 && (std::is_assignable_v<TValueType&, TArgs&&> && ...))
+            {
+                ((value = std::forward<TArgs>(args)), ...);
+            }
+            else
+            {
+                value = TValueType(std::forward<TArgs>(args)...);
+            }
+        }
+
+        void Grow()
+        {
+            std::vector<Slot> oldSlots(std::max(m_slots.size() * 2, MinCapacity));
+            oldSlots.swap(m_slots);
+            m_capacityLog2 = 0;
+            while ((size_t{1} << m_capacityLog2) < m_slots.size()) m_capacityLog2++;
+
+            for (const auto& oldSlot : oldSlots)
+            {
+                if (oldSlot.generation != m_generation) continue;
+
+                size_t index = SlotIndex(oldSlot.key);
+                while (m_slots[index].generation == m_generation)
+                {
+                    index = (index + 1) & (m_slots.size() - 1);
+                }
+
+                // Inline values are trivially copyable and out of line values are owned by the arena,
+                // so a slot can be moved with a plain copy
+                m_slots[index] = oldSlot;
+            }
+        }
+
+        mutable std::vector<Slot> m_slots{};
+        uint32_t m_capacityLog2 = 0;
+        size_t m_size = 0;
+        uint32_t m_generation = 1;
+        const BlackboardLayout* m_layout = nullptr;
+        unsigned char* m_layoutData = nullptr;
+        size_t m_layoutRow = 0;
+        bool m_ownsLayoutData = false;
+        uint64_t* m_layoutVersions = nullptr;
+        uint64_t m_epoch = 0;
+        uint64_t m_clearEpoch = 0;
+        std::vector<Subscription> m_subscriptions{};
+        SubscriptionId m_nextSubscriptionId = 0;
+        std::shared_ptr<Blackboard> m_parent = nullptr;
+        BlackboardArena m_arena{};
     };
 }
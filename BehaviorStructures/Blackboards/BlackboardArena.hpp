@@ -0,0 +1,166 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace fluczakAI
+{
+    /**
+     * \brief A bump allocator that owns all out-of-line values of a single blackboard. Memory is
+     * handed out from a list of blocks that are kept alive between resets, so once a blackboard has
+     * been filled, clearing and refilling it does not touch the heap.
+     */
+    class BlackboardArena
+    {
+    public:
+        BlackboardArena() = default;
+        BlackboardArena(const BlackboardArena&) = delete;
+        BlackboardArena& operator=(const BlackboardArena&) = delete;
+
+        BlackboardArena(BlackboardArena&& other) noexcept { *this = std::move(other); }
+
+        BlackboardArena& operator=(BlackboardArena&& other) noexcept
+        {
+            if (this == &other) return *this;
+            Reset();
+            m_blocks = std::move(other.m_blocks);
+            m_currentBlock = std::exchange(other.m_currentBlock, 0);
+            m_offset = std::exchange(other.m_offset, 0);
+            m_destructors = std::exchange(other.m_destructors, nullptr);
+            other.m_blocks.clear();
+            return *this;
+        }
+
+        ~BlackboardArena() { Reset(); }
+
+        /**
+         * \brief Construct an object of type T inside the arena. If T is not trivially destructible
+         * its destructor is going to be called on Reset()
+         * \tparam T - type of the object
+         * \param args - arguments passed to the constructor of T
+         * \return - a pointer to the object, it stays valid until Reset()
+         */
+        template <typename T, typename... Args>
+        T* Create(Args&&... args)
+        {
+            void* memory = Allocate(sizeof(T), alignof(T));
+            T* object = new (memory) T(std::forward<Args>(args)...);
+
+            if constexpr (!std::is_trivially_destructible_v<T>)
+            {
+                void* nodeMemory = Allocate(sizeof(DestructorNode), alignof(DestructorNode));
+                m_destructors = new (nodeMemory) DestructorNode{[](void* toDestroy) { static_cast<T*>(toDestroy)->~T(); }, object, m_destructors};
+            }
+
+            return object;
+        }
+
+        /**
+         * \brief Allocate raw memory inside the arena
+         * \param size - size of the allocation in bytes
+         * \param alignment - alignment of the allocation, has to be a power of two
+         * \return - a pointer to the memory, it stays valid until Reset()
+         */
+        void* Allocate(size_t size, size_t alignment)
+        {
+            while (m_currentBlock < m_blocks.size())
+            {
+                Block& block = m_blocks[m_currentBlock];
+                // The blocks are only aligned for std::max_align_t, so the address is aligned, not the offset
+                const auto base = reinterpret_cast<uintptr_t>(block.data.get());
+                const size_t aligned = ((base + m_offset + alignment - 1) & ~(alignment - 1)) - base;
+                if (aligned + size <= block.size)
+                {
+                    m_offset = aligned + size;
+                    return block.data.get() + aligned;
+                }
+
+                m_currentBlock++;
+                m_offset = 0;
+            }
+
+            const size_t previousSize = m_blocks.empty() ? 0 : m_blocks.back().size;
+            // Room for the padding up to any alignment, so the allocation fits a new block
+            const size_t blockSize = std::max({BaseBlockSize, previousSize * 2, size + alignment});
+            m_blocks.push_back({std::make_unique<std::byte[]>(blockSize), blockSize});
+            m_currentBlock = m_blocks.size() - 1;
+            m_offset = 0;
+            return Allocate(size, alignment);
+        }
+
+        /**
+         * \brief Destroy all objects created in the arena and make its memory available again. The blocks
+         * themselves are kept, so this is O(1) when the arena only holds trivially destructible objects.
+         */
+        void Reset()
+        {
+            while (m_destructors != nullptr)
+            {
+                m_destructors->destroy(m_destructors->object);
+                m_destructors = m_destructors->next;
+            }
+
+            m_currentBlock = 0;
+            m_offset = 0;
+        }
+
+        /**
+         * \brief A position in the arena that it can be rewound to
+         */
+        struct Marker
+        {
+            size_t block;
+            size_t offset;
+            const void* destructors;
+        };
+
+        /**
+         * \brief Get the current position of the arena
+         */
+        Marker GetMarker() const { return {m_currentBlock, m_offset, m_destructors}; }
+
+        /**
+         * \brief Destroy the objects created since the marker was taken and make their memory available again,
+         * the objects created before stay valid
+         * \param marker - a marker taken from this arena since its last Reset()
+         */
+        void Rewind(const Marker& marker)
+        {
+            while (m_destructors != nullptr && m_destructors != marker.destructors)
+            {
+                m_destructors->destroy(m_destructors->object);
+                m_destructors = m_destructors->next;
+            }
+
+            m_currentBlock = marker.block;
+            m_offset = marker.offset;
+        }
+
+    private:
+        static constexpr size_t BaseBlockSize = 512;
+
+        struct Block
+        {
+            std::unique_ptr<std::byte[]> data;
+            size_t size;
+        };
+
+        struct DestructorNode
+        {
+            void (*destroy)(void*);
+            void* object;
+            DestructorNode* next;
+        };
+
+        std::vector<Block> m_blocks{};
+        size_t m_currentBlock = 0;
+        size_t m_offset = 0;
+        DestructorNode* m_destructors = nullptr;
+    };
+}
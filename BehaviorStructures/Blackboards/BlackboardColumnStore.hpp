@@ -0,0 +1,108 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstring>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+#include "Blackboard.hpp"
+#include "BlackboardLayout.hpp"
+
+namespace fluczakAI
+{
+    /**
+     * \brief Blackboard values of many agents stored column by column: every key has one contiguous array
+     * holding its value for each agent. Reading one key for the whole population is then a linear scan.
+     * Every agent still gets a regular Blackboard that is bound to its row with BindView, so FSMs and
+     * behavior trees use it like any other blackboard.
+     */
+    class BlackboardColumnStore : public BlackboardLayout
+    {
+    public:
+        BlackboardColumnStore(size_t agentCount) : m_agentCount(agentCount) {}
+
+        /**
+         * \brief Add a column for a given key. Columns have to be added before views are bound, since adding a
+         * column can move the values of all columns.
+         * \tparam T - a trivially copyable type of the values in the column
+         * \param key - the key of the column
+         * \param defaultValue - the value every agent starts with, and is reset to with Blackboard::ResetLayoutValues
+         */
+        template <typename T>
+        void AddColumn(const BlackboardKey& key, const T& defaultValue = T{})
+        {
+            static_assert(std::is_trivially_copyable_v<T>, "Columns can only store trivially copyable values");
+            static_assert(alignof(T) <= alignof(std::max_align_t));
+            assert(FindSlot(key) == InvalidSlot);
+
+            const size_t offset = (m_blockSize + alignof(T) - 1) & ~(alignof(T) - 1);
+            const size_t newSize = offset + sizeof(T) * m_agentCount;
+
+            std::vector<std::max_align_t> storage((newSize + sizeof(std::max_align_t) - 1) / sizeof(std::max_align_t));
+            if (!m_storage.empty())
+            {
+                std::memcpy(storage.data(), m_storage.data(), m_blockSize);
+            }
+            m_storage.swap(storage);
+
+            auto* column = reinterpret_cast<T*>(GetData() + offset);
+            for (size_t i = 0; i < m_agentCount; i++)
+            {
+                new (column + i) T(defaultValue);
+            }
+
+            // The default block holds one row, the defaults are only ever copied from it
+            const size_t defaultOffset = m_defaultBlock.size();
+            m_defaultBlock.resize(defaultOffset + sizeof(T));
+            std::memcpy(m_defaultBlock.data() + defaultOffset, &defaultValue, sizeof(T));
+
+            m_blockSize = newSize;
+            m_blockAlignment = std::max(m_blockAlignment, alignof(T));
+            AddSlot(key, GetBlackboardTypeId<T>(), offset, sizeof(T), sizeof(T), defaultOffset);
+        }
+
+        /**
+         * \brief Get the values of a key for all agents
+         * \tparam T - type of the values in the column
+         * \param key - the key of the column
+         * \return - a pointer to GetAgentCount() values, nullptr if there's no column of type T for the key
+         */
+        template <typename T>
+        T* GetColumn(const BlackboardKey& key)
+        {
+            const int index = FindSlot(key);
+            if (index == InvalidSlot) return nullptr;
+            if (GetSlot(index).typeId != GetBlackboardTypeId<T>()) return nullptr;
+            return std::launder(reinterpret_cast<T*>(GetData() + GetSlot(index).offset));
+        }
+
+        template <typename T>
+        const T* GetColumn(const BlackboardKey& key) const
+        {
+            return const_cast<BlackboardColumnStore*>(this)->GetColumn<T>(key);
+        }
+
+        /**
+         * \brief Bind a blackboard to the values of a single agent. Keys of the store are then read and written
+         * in the columns, other keys are stored in the blackboard itself.
+         * \param blackboard - the blackboard of the agent
+         * \param agent - index of the agent
+         */
+        void BindView(Blackboard& blackboard, size_t agent)
+        {
+            assert(agent < m_agentCount);
+            blackboard.BindLayout(*this, GetData(), agent);
+        }
+
+        size_t GetAgentCount() const { return m_agentCount; }
+
+    private:
+        unsigned char* GetData() { return reinterpret_cast<unsigned char*>(m_storage.data()); }
+
+        size_t m_agentCount = 0;
+        std::vector<std::max_align_t> m_storage{};
+    };
+}
@@ -0,0 +1,178 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+
+namespace fluczakAI
+{
+    /**
+     * \brief A process-wide table of interned blackboard key names. Every distinct name gets a
+     * compact id the first time it is interned, so the name is only hashed once.
+     * Looking up a name that is already interned only takes a shared lock, and getting the name of
+     * an id takes none, so many threads can create keys and print them at once.
+     */
+    class BlackboardKeyRegistry
+    {
+    public:
+        static constexpr uint32_t InvalidId = std::numeric_limits<uint32_t>::max();
+
+        static BlackboardKeyRegistry& Instance()
+        {
+            static BlackboardKeyRegistry registry;
+            return registry;
+        }
+
+        ~BlackboardKeyRegistry()
+        {
+            for (auto& chunk : m_chunks) delete[] chunk.load(std::memory_order_relaxed);
+        }
+
+        BlackboardKeyRegistry(const BlackboardKeyRegistry&) = delete;
+        BlackboardKeyRegistry& operator=(const BlackboardKeyRegistry&) = delete;
+
+        /**
+         * \brief Get the id of a given name, registering the name if it has not been seen before
+         * \param name - the name of the key
+         * \return - the id of the key
+         */
+        uint32_t Intern(std::string_view name)
+        {
+            {
+                std::shared_lock<std::shared_mutex> lock(m_mutex);
+                const auto it = m_ids.find(name);
+                if (it != m_ids.end()) return it->second;
+            }
+
+            std::unique_lock<std::shared_mutex> lock(m_mutex);
+            // Another thread may have interned the name between the locks
+            const auto it = m_ids.find(name);
+            if (it != m_ids.end()) return it->second;
+
+            const uint32_t id = m_size.load(std::memory_order_relaxed);
+            const auto [chunk, offset] = Locate(id);
+            std::string* names = m_chunks[chunk].load(std::memory_order_relaxed);
+            if (names == nullptr)
+            {
+                names = new std::string[ChunkSize(chunk)];
+                m_chunks[chunk].store(names, std::memory_order_release);
+            }
+
+            // Names never move once stored, so the views used as map keys stay valid
+            names[offset] = name;
+            m_ids.emplace(std::string_view(names[offset]), id);
+            m_size.store(id + 1, std::memory_order_release);
+            return id;
+        }
+
+        /**
+         * \brief Get the name a given id was interned from
+         * \param id - id of the key
+         * \return - the name of the key
+         */
+        const std::string& GetName(uint32_t id) const
+        {
+            static const std::string empty{};
+            if (id >= m_size.load(std::memory_order_acquire)) return empty;
+            const auto [chunk, offset] = Locate(id);
+            return m_chunks[chunk].load(std::memory_order_acquire)[offset];
+        }
+
+        /**
+         * \brief Get the number of keys interned so far
+         */
+        size_t Size() const { return m_size.load(std::memory_order_acquire); }
+
+    private:
+        BlackboardKeyRegistry() = default;
+
+        // The names are stored in chunks that double in size, so a name is found without a lock
+        static constexpr uint32_t FirstChunkSize = 64;
+        static constexpr uint32_t ChunkCount = 27;
+
+        static constexpr size_t ChunkSize(uint32_t chunk) { return size_t{FirstChunkSize} << chunk; }
+
+        /**
+         * \brief Get the chunk an id is stored in and its index in the chunk
+         */
+        static std::pair<uint32_t, uint32_t> Locate(uint32_t id)
+        {
+            const uint64_t position = uint64_t{id} / FirstChunkSize + 1;
+            const auto chunk = static_cast<uint32_t>(std::bit_width(position) - 1);
+            const uint64_t first = (uint64_t{FirstChunkSize} << chunk) - FirstChunkSize;
+            return {chunk, static_cast<uint32_t>(id - first)};
+        }
+
+        mutable std::shared_mutex m_mutex;
+        std::atomic<uint32_t> m_size{0};
+        std::array<std::atomic<std::string*>, ChunkCount> m_chunks{};
+        std::unordered_map<std::string_view, uint32_t> m_ids{};
+    };
+
+    /**
+     * \brief A handle to an interned blackboard key. Constructing it from a name hashes the name once,
+     * after that comparing and hashing a key is a single integer operation. Keys should be created
+     * when building or deserializing a structure, not while executing it.
+     */
+    class BlackboardKey
+    {
+    public:
+        BlackboardKey() = default;
+        explicit BlackboardKey(std::string_view name) : m_id(BlackboardKeyRegistry::Instance().Intern(name)) {}
+        explicit BlackboardKey(const std::string& name) : BlackboardKey(std::string_view(name)) {}
+        explicit BlackboardKey(const char* name) : BlackboardKey(std::string_view(name)) {}
+
+        /**
+         * \brief Get the key of an id returned by GetId(), e.g. when iterating the keys of a blackboard
+         * \param id - an interned id
+         * \return - the key with the given id
+         */
+        static BlackboardKey FromId(uint32_t id)
+        {
+            BlackboardKey key;
+            key.m_id = id;
+            return key;
+        }
+
+        /**
+         * \brief A getter for the interned id of the key
+         * \return - the id of the key
+         */
+        uint32_t GetId() const { return m_id; }
+
+        /**
+         * \brief A getter for the name the key was interned from
+         * \return - name of the key
+         */
+        const std::string& GetName() const { return BlackboardKeyRegistry::Instance().GetName(m_id); }
+
+        /**
+         * \brief Whether or not the key was interned from a name
+         */
+        bool IsValid() const { return m_id != BlackboardKeyRegistry::InvalidId; }
+
+        bool operator==(const BlackboardKey& other) const { return m_id == other.m_id; }
+        bool operator!=(const BlackboardKey& other) const { return m_id != other.m_id; }
+
+    private:
+        uint32_t m_id = BlackboardKeyRegistry::InvalidId;
+    };
+}
+
+namespace std
+{
+    template <>
+    struct hash<fluczakAI::BlackboardKey>
+    {
+        size_t operator()(const fluczakAI::BlackboardKey& key) const noexcept { return key.GetId(); }
+    };
+}
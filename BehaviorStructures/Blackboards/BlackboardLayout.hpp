@@ -0,0 +1,96 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "BlackboardKey.hpp"
+#include "BlackboardTypeId.hpp"
+
+namespace fluczakAI
+{
+    /**
+     * \brief A description of a fixed set of blackboard keys that are stored at constant offsets inside
+     * of a single block of memory. A layout is created once per schema and shared by every blackboard
+     * that uses it.
+     */
+    class BlackboardLayout
+    {
+    public:
+        static constexpr int InvalidSlot = -1;
+
+        /**
+         * \brief A single key of the layout. The value of the key for row r is located at offset + r * stride,
+         * its default value at defaultOffset in the default block.
+         */
+        struct Slot
+        {
+            BlackboardKey key;
+            BlackboardTypeId typeId;
+            size_t offset;
+            size_t stride;
+            size_t size;
+            size_t defaultOffset;
+        };
+
+        /**
+         * \brief Find the slot of a given key
+         * \param key - the key to look for
+         * \return - index of the slot or InvalidSlot if the key is not a part of the layout
+         */
+        int FindSlot(const BlackboardKey& key) const
+        {
+            if (key.GetId() >= m_slotByKey.size()) return InvalidSlot;
+            return m_slotByKey[key.GetId()];
+        }
+
+        const Slot& GetSlot(int index) const { return m_slots[index]; }
+        size_t GetSlotCount() const { return m_slots.size(); }
+
+        /**
+         * \brief A getter for the size of the memory block holding all of the values of the layout
+         */
+        size_t GetBlockSize() const { return m_blockSize; }
+        size_t GetBlockAlignment() const { return m_blockAlignment; }
+
+        /**
+         * \brief A getter for the default values of the keys, see Slot::defaultOffset. A blackboard that owns its
+         * block, see Blackboard::UseSchema, copies it when it starts using the layout or is cleared.
+         */
+        const unsigned char* GetDefaultBlock() const { return m_defaultBlock.data(); }
+
+        /**
+         * \brief Write the default values of all of the keys to a single row
+         * \param data - the memory the slot offsets are relative to
+         * \param row - the row to write
+         */
+        void WriteDefaults(unsigned char* data, size_t row) const
+        {
+            for (const Slot& slot : m_slots)
+            {
+                std::memcpy(data + slot.offset + row * slot.stride, m_defaultBlock.data() + slot.defaultOffset, slot.size);
+            }
+        }
+
+    protected:
+        void AddSlot(const BlackboardKey& key, BlackboardTypeId typeId, size_t offset, size_t stride, size_t size, size_t defaultOffset)
+        {
+            if (key.GetId() >= m_slotByKey.size())
+            {
+                m_slotByKey.resize(key.GetId() + 1, InvalidSlot);
+            }
+
+            m_slotByKey[key.GetId()] = static_cast<int>(m_slots.size());
+            m_slots.push_back({key, typeId, offset, stride, size, defaultOffset});
+        }
+
+        size_t m_blockSize = 0;
+        size_t m_blockAlignment = 1;
+        std::vector<unsigned char> m_defaultBlock{};
+
+    private:
+        std::vector<Slot> m_slots{};
+        std::vector<int> m_slotByKey{};
+    };
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstring>
+#include <type_traits>
+
+#include "BlackboardLayout.hpp"
+#include "../Serialization/visit_struct/include/visit_struct/visit_struct.hpp"
+
+namespace fluczakAI
+{
+    /**
+     * \brief A blackboard layout generated from a struct reflected with VISITABLE_STRUCT. Every member of the
+     * struct becomes a blackboard key with the name of the member, e.g.
+     *
+     *   struct SoldierData { float health; int ammo; bool alerted; };
+     *   VISITABLE_STRUCT(SoldierData, health, ammo, alerted);
+     *
+     *   blackboard.UseSchema<SoldierData>().health = 100.0f;
+     *
+     * Values of the struct are read and written at a constant offset, keys the struct doesn't have are
+     * still stored dynamically in the blackboard.
+     * \tparam TSchema - a trivially copyable, visitable struct
+     */
+    template <typename TSchema>
+    class BlackboardSchema : public BlackboardLayout
+    {
+        static_assert(visit_struct::traits::is_visitable<TSchema>::value, "A blackboard schema has to be a visitable struct");
+        static_assert(std::is_trivially_copyable_v<TSchema>, "A blackboard schema has to be trivially copyable");
+
+    public:
+        static const BlackboardSchema& Instance()
+        {
+            static const BlackboardSchema schema;
+            return schema;
+        }
+
+    private:
+        BlackboardSchema()
+        {
+            const TSchema defaults{};
+            const auto* base = reinterpret_cast<const unsigned char*>(&defaults);
+
+            visit_struct::for_each(defaults, [this, base](const char* name, const auto& field)
+            {
+                using FieldType = std::decay_t<decltype(field)>;
+                const auto offset = static_cast<size_t>(reinterpret_cast<const unsigned char*>(&field) - base);
+                AddSlot(BlackboardKey(name), GetBlackboardTypeId<FieldType>(), offset, 0, sizeof(FieldType), offset);
+            });
+
+            m_blockSize = sizeof(TSchema);
+            m_blockAlignment = alignof(TSchema);
+            m_defaultBlock.resize(sizeof(TSchema));
+            std::memcpy(m_defaultBlock.data(), &defaults, sizeof(TSchema));
+        }
+    };
+}
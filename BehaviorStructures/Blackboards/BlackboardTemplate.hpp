@@ -0,0 +1,80 @@
+#pragma once
+
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "Blackboard.hpp"
+#include "BlackboardArena.hpp"
+#include "BlackboardKey.hpp"
+
+namespace fluczakAI
+{
+    /**
+     * \brief A set of default values a blackboard is filled with, e.g. when a pooled context is recycled. The
+     * values are written with SetData, so applying a template to a cleared blackboard reuses its slots and
+     * doesn't allocate, unless a value allocates when copied.
+     * Keys of a layout don't need to be in the template: Clear() resets the keys of a schema to its defaults, and
+     * Blackboard::ResetLayoutValues the keys of a row bound with BindLayout, as ContextPool does.
+     */
+    class BlackboardTemplate
+    {
+    public:
+        BlackboardTemplate() = default;
+        BlackboardTemplate(BlackboardTemplate&&) noexcept = default;
+        BlackboardTemplate& operator=(BlackboardTemplate&&) noexcept = default;
+
+        /**
+         * \brief Add a default value
+         * \tparam T - type of the value
+         * \param key - the key of the value
+         * \param value - the value
+         * \return - the template
+         */
+        template <typename T>
+        BlackboardTemplate& Set(const BlackboardKey& key, T value)
+        {
+            const T* stored = m_values.Create<T>(std::move(value));
+            m_entries.push_back({key, stored, [](Blackboard& blackboard, const BlackboardKey& entryKey, const void* entryValue)
+            {
+                blackboard.SetData<T>(entryKey, *static_cast<const T*>(entryValue));
+            }});
+            return *this;
+        }
+
+        /**
+         * \brief A string overload of Set
+         */
+        template <typename T>
+        BlackboardTemplate& Set(std::string_view key, T value)
+        {
+            return Set<T>(BlackboardKey(key), std::move(value));
+        }
+
+        /**
+         * \brief Write all of the default values to a blackboard, in the order they were added
+         * \param blackboard - the blackboard to write to
+         */
+        void Apply(Blackboard& blackboard) const
+        {
+            for (const Entry& entry : m_entries)
+            {
+                entry.apply(blackboard, entry.key, entry.value);
+            }
+        }
+
+        size_t Size() const { return m_entries.size(); }
+
+    private:
+        struct Entry
+        {
+            BlackboardKey key;
+            const void* value;
+            void (*apply)(Blackboard& blackboard, const BlackboardKey& key, const void* value);
+        };
+
+        // The values stay at the same address when the template is moved
+        BlackboardArena m_values{};
+        std::vector<Entry> m_entries{};
+    };
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+namespace fluczakAI
+{
+    /**
+     * \brief A compact id of a type stored in a blackboard. Ids are handed out in the order types
+     * are first used, so they are only meaningful within one run of the program.
+     */
+    using BlackboardTypeId = uint32_t;
+
+    namespace detail
+    {
+        inline BlackboardTypeId NextBlackboardTypeId()
+        {
+            static std::atomic<BlackboardTypeId> counter{0};
+            return counter.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * \brief Get the compact id of type T. Checking whether two values have the same type is then
+     * a single integer compare instead of a dynamic_cast.
+     * \tparam T - the type to get the id of
+     * \return - the id of the type
+     */
+    template <typename T>
+    BlackboardTypeId GetBlackboardTypeId()
+    {
+        static const BlackboardTypeId id = detail::NextBlackboardTypeId();
+        return id;
+    }
+}
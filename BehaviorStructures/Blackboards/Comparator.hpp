@@ -1,9 +1,17 @@
 #pragma once
 
+#include <algorithm>
+#include <cstdint>
 #include <sstream>
 #include <string>
 #include <type_traits>
 
+#include "Blackboard.hpp"
+#include "BlackboardColumnStore.hpp"
+#include "BlackboardKey.hpp"
+#include "ComparatorBatch.hpp"
+#include "ComparisonType.hpp"
+
 template <typename T>
 struct OperatorTests
 {
@@ -55,22 +63,35 @@ namespace fluczakAI
 {
 class Blackboard;
 
-enum class ComparisonType
-{
-    EQUAL = 0,
-    NOT_EQUAL = 1,
-    LESS = 2,
-    LESS_EQUAL = 3,
-    GREATER = 4,
-    GREATER_EQUAL = 5
-};
-
 class IComparator
 {
 public:
     virtual bool Evaluate(const Blackboard& blackboard) const { return false; }
     virtual ~IComparator() = default;
     virtual std::string ToString() const { return {}; }
+
+    /**
+     * \brief Resolve the key of the comparator to a slot of a given layout. Blackboards using that layout are
+     * then evaluated with a constant offset read instead of a key lookup.
+     * \param layout - the layout to resolve the key against
+     */
+    virtual void BindLayout(const BlackboardLayout& layout) {}
+
+    /**
+     * \brief Evaluate the comparator for many blackboards at once, e.g. for the agents that reach a comparison
+     * together in a BatchBehaviorTreeExecutor. The default evaluates the blackboards one by one.
+     * \param blackboards - the blackboards to evaluate
+     * \param count - number of blackboards
+     * \param results - a bitmask of (count + 63) / 64 words, bit i is set when blackboards[i] passes the comparison
+     */
+    virtual void EvaluateBatch(const Blackboard* const* blackboards, size_t count, uint64_t* results) const
+    {
+        std::fill_n(results, (count + 63) / 64, uint64_t{0});
+        for (size_t i = 0; i < count; i++)
+        {
+            if (Evaluate(*blackboards[i])) results[i >> 6] |= uint64_t{1} << (i & 63);
+        }
+    }
 };
 
 template <typename T>
@@ -82,24 +103,67 @@ public:
     {
     }
 
+    Comparator(const BlackboardKey& comparison_key, const ComparisonType comparison_type, const T& value)
+        : m_comparisonKey(comparison_key), m_comparisonType(comparison_type), m_value(value)
+    {
+    }
+
     std::string ToString() const override;
 
     bool Evaluate(const Blackboard& blackboard) const override;
 
-    std::string GetComparisonKey() const { return m_comparisonKey; }
+    /**
+     * \brief Compare a given value against the value of the comparator
+     * \param query - the value to compare
+     * \return - the result of the comparison
+     */
+    bool Compare(const T& query) const;
+
+    /**
+     * \brief Compare many values at once. Float, double, int and bool values are compared with SSE2 or AVX2
+     * instructions when the build targets them, other types fall back to Compare.
+     * \param values - a contiguous array of values, e.g. a column of a BlackboardColumnStore
+     * \param count - number of values
+     * \param results - a bitmask of (count + 63) / 64 words, bit i is set when values[i] passes the comparison
+     */
+    void EvaluateBatch(const T* values, size_t count, uint64_t* results) const;
+
+    /**
+     * \brief Evaluate the comparator for every agent of a column store
+     * \param store - the store holding the column of the comparator key
+     * \param results - a bitmask of (store.GetAgentCount() + 63) / 64 words, bit i is set when agent i passes the
+     * comparison. If the store has no column of type T for the key, no bits are set.
+     */
+    void EvaluateBatch(const BlackboardColumnStore& store, uint64_t* results) const;
+
+    /**
+     * \brief Evaluate the comparator for many blackboards at once. Arithmetic values are gathered from the
+     * blackboards and compared with the SIMD kernels of EvaluateBatch, a blackboard without the value fails.
+     */
+    void EvaluateBatch(const Blackboard* const* blackboards, size_t count, uint64_t* results) const override;
+
+    void BindLayout(const BlackboardLayout& layout) override;
+
+    std::string GetComparisonKey() const { return m_comparisonKey.GetName(); }
+    const BlackboardKey& GetKey() const { return m_comparisonKey; }
     ComparisonType GetComparisonType() const { return m_comparisonType; }
     T GetValue() const { return m_value; }
 private:
-    std::string m_comparisonKey; 
+    const T* FindValue(const Blackboard& blackboard) const;
+
+    BlackboardKey m_comparisonKey;
     ComparisonType m_comparisonType; 
     T m_value;
+    const BlackboardLayout* m_layout = nullptr;
+    size_t m_layoutOffset = 0;
+    size_t m_layoutStride = 0;
 };
 
 template <typename T>
 std::string Comparator<T>::ToString() const
 {
     std::stringstream toReturn;
-    toReturn << m_comparisonKey << " ";
+    toReturn << m_comparisonKey.GetName() << " ";
 
     if constexpr (std::is_same_v<T, std::string>)
     {
@@ -116,17 +180,113 @@ std::string Comparator<T>::ToString() const
     return toReturn.str();
 }
 
+template <typename T>
+void Comparator<T>::BindLayout(const BlackboardLayout& layout)
+{
+    const int slot = layout.FindSlot(m_comparisonKey);
+    if (slot == BlackboardLayout::InvalidSlot || layout.GetSlot(slot).typeId != GetBlackboardTypeId<T>())
+    {
+        m_layout = nullptr;
+        return;
+    }
+
+    m_layout = &layout;
+    m_layoutOffset = layout.GetSlot(slot).offset;
+    m_layoutStride = layout.GetSlot(slot).stride;
+}
+
+template <typename T>
+const T* Comparator<T>::FindValue(const Blackboard& blackboard) const
+{
+    if (m_layout != nullptr && blackboard.GetLayout() == m_layout)
+    {
+        return blackboard.GetLayoutValue<T>(m_layoutOffset, m_layoutStride);
+    }
+    return blackboard.TryGet<T>(m_comparisonKey);
+}
+
 template <typename T>
 bool Comparator<T>::Evaluate(const Blackboard& blackboard) const
+{
+    const T* query = FindValue(blackboard);
+    if (query == nullptr) return false;
+    return Compare(*query);
+}
+
+template <typename T>
+void Comparator<T>::EvaluateBatch(const Blackboard* const* blackboards, size_t count, uint64_t* results) const
+{
+    if constexpr (std::is_arithmetic_v<T>)
+    {
+        // Gathered a chunk at a time on the stack, so a comparator shared by many threads needs no scratch memory
+        constexpr size_t chunkSize = 256;
+        T values[chunkSize];
+        uint64_t found[chunkSize / 64];
+
+        for (size_t begin = 0; begin < count; begin += chunkSize)
+        {
+            const size_t chunk = std::min(chunkSize, count - begin);
+            const size_t words = (chunk + 63) / 64;
+            std::fill_n(found, words, uint64_t{0});
+            for (size_t i = 0; i < chunk; i++)
+            {
+                const T* value = FindValue(*blackboards[begin + i]);
+                values[i] = value != nullptr ? *value : T{};
+                if (value != nullptr) found[i >> 6] |= uint64_t{1} << (i & 63);
+            }
+
+            uint64_t* chunkResults = results + begin / 64;
+            EvaluateBatch(values, chunk, chunkResults);
+            for (size_t word = 0; word < words; word++)
+            {
+                chunkResults[word] &= found[word];
+            }
+        }
+    }
+    else
+    {
+        IComparator::EvaluateBatch(blackboards, count, results);
+    }
+}
+
+template <typename T>
+void Comparator<T>::EvaluateBatch(const T* values, size_t count, uint64_t* results) const
+{
+    std::fill_n(results, (count + 63) / 64, uint64_t{0});
+
+    const size_t compared = detail::BatchCompareSimd(values, count, m_value, m_comparisonType, results);
+
+    for (size_t i = compared; i < count; i++)
+    {
+        if (Compare(values[i]))
+        {
+            results[i >> 6] |= uint64_t{1} << (i & 63);
+        }
+    }
+}
+
+template <typename T>
+void Comparator<T>::EvaluateBatch(const BlackboardColumnStore& store, uint64_t* results) const
+{
+    const T* column = store.GetColumn<T>(m_comparisonKey);
+    if (column == nullptr)
+    {
+        std::fill_n(results, (store.GetAgentCount() + 63) / 64, uint64_t{0});
+        return;
+    }
+
+    EvaluateBatch(column, store.GetAgentCount(), results);
+}
+
+template <typename T>
+bool Comparator<T>::Compare(const T& query) const
 {
     switch (m_comparisonType)
     {
         case ComparisonType::EQUAL:
             if constexpr (OperatorTests<T>::equality)
             {
-                    auto query = blackboard.TryGet<T>(m_comparisonKey);
-                    if (query == nullptr) return false;
-                    return *query == m_value;
+                return query == m_value;
             }
             else
             {
@@ -135,9 +295,7 @@ bool Comparator<T>::Evaluate(const Blackboard& blackboard) const
         case ComparisonType::NOT_EQUAL:
             if constexpr (OperatorTests<T>::inequality)
             {
-                auto query = blackboard.TryGet<T>(m_comparisonKey);
-                if (query == nullptr) return false;
-                return *query != m_value;
+                return query != m_value;
             }
             else
             {
@@ -146,9 +304,7 @@ bool Comparator<T>::Evaluate(const Blackboard& blackboard) const
         case ComparisonType::LESS:
             if constexpr (OperatorTests<T>::less)
             {
-                auto query = blackboard.TryGet<T>(m_comparisonKey);
-                if (query == nullptr) return false;
-                return *query < m_value;
+                return query < m_value;
             }
             else
             {
@@ -157,9 +313,7 @@ bool Comparator<T>::Evaluate(const Blackboard& blackboard) const
         case ComparisonType::LESS_EQUAL:
             if constexpr (OperatorTests<T>::lessEqual)
             {
-                auto query = blackboard.TryGet<T>(m_comparisonKey);
-                if (query == nullptr) return false;
-                return *query <= m_value;
+                return query <= m_value;
             }
             else
             {
@@ -168,9 +322,7 @@ bool Comparator<T>::Evaluate(const Blackboard& blackboard) const
         case ComparisonType::GREATER:
             if constexpr (OperatorTests<T>::greater)
             {
-                auto query = blackboard.TryGet<T>(m_comparisonKey);
-                if (query == nullptr) return false;
-                return *query > m_value;
+                return query > m_value;
             }
             else
             {
@@ -179,9 +331,7 @@ bool Comparator<T>::Evaluate(const Blackboard& blackboard) const
         case ComparisonType::GREATER_EQUAL:
             if constexpr (OperatorTests<T>::greaterEqual)
             {
-                auto query = blackboard.TryGet<T>(m_comparisonKey);
-                if (query == nullptr) return false;
-                return *query >= m_value;
+                return query >= m_value;
             }
             else
             {
@@ -0,0 +1,231 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#include "ComparisonType.hpp"
+
+#if defined(__AVX2__) || defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <immintrin.h>
+#define FLUCZAKAI_BATCH_SSE2 1
+#endif
+
+#if defined(__AVX2__)
+#define FLUCZAKAI_BATCH_AVX2 1
+#endif
+
+namespace fluczakAI
+{
+namespace detail
+{
+    /**
+     * \brief Write the comparison results of a group of lanes starting at element 'index' into a result bitmask
+     */
+    inline void SetBatchResultBits(uint64_t* results, size_t index, uint64_t laneMask)
+    {
+        results[index >> 6] |= laneMask << (index & 63);
+    }
+
+    /**
+     * \brief Run a kernel comparing 'Lanes' elements at a time for as long as there are full groups of lanes left.
+     * Lanes always divides 64, so a group never spans two words of the bitmask.
+     * \return - the number of elements compared, the rest has to be compared by the caller
+     */
+    template <size_t Lanes, typename TKernel>
+    inline size_t RunBatchKernel(size_t count, uint64_t* results, TKernel kernel)
+    {
+        static_assert(64 % Lanes == 0);
+
+        size_t i = 0;
+        for (; i + Lanes <= count; i += Lanes)
+        {
+            SetBatchResultBits(results, i, kernel(i));
+        }
+        return i;
+    }
+
+    /**
+     * \brief Dispatch integer comparisons, for integers every comparison can be derived from
+     * equal, greater and less by inverting the lane mask
+     */
+    template <size_t Lanes, typename TEqual, typename TGreater, typename TLess>
+    inline size_t RunIntegerBatchKernels(ComparisonType type, size_t count, uint64_t* results, TEqual equal, TGreater greater, TLess less)
+    {
+        constexpr uint64_t allLanes = Lanes == 64 ? ~uint64_t{0} : (uint64_t{1} << Lanes) - 1;
+
+        switch (type)
+        {
+            case ComparisonType::EQUAL:
+                return RunBatchKernel<Lanes>(count, results, equal);
+            case ComparisonType::NOT_EQUAL:
+                return RunBatchKernel<Lanes>(count, results, [&](size_t i) { return equal(i) ^ allLanes; });
+            case ComparisonType::LESS:
+                return RunBatchKernel<Lanes>(count, results, less);
+            case ComparisonType::LESS_EQUAL:
+                return RunBatchKernel<Lanes>(count, results, [&](size_t i) { return greater(i) ^ allLanes; });
+            case ComparisonType::GREATER:
+                return RunBatchKernel<Lanes>(count, results, greater);
+            case ComparisonType::GREATER_EQUAL:
+                return RunBatchKernel<Lanes>(count, results, [&](size_t i) { return less(i) ^ allLanes; });
+            default:
+                return 0;
+        }
+    }
+
+    /**
+     * \brief Compare the leading elements of 'values' against 'constant' with SIMD instructions.
+     * The overloads that aren't specialized for a type don't compare anything.
+     * \return - the number of elements compared, the rest has to be compared by the caller
+     */
+    template <typename T>
+    inline size_t BatchCompareSimd(const T* values, size_t count, const T& constant, ComparisonType type, uint64_t* results)
+    {
+        return 0;
+    }
+
+#if defined(FLUCZAKAI_BATCH_AVX2)
+
+    inline size_t BatchCompareSimd(const float* values, size_t count, float constant, ComparisonType type, uint64_t* results)
+    {
+        const __m256 c = _mm256_set1_ps(constant);
+        // Floats can't be derived from each other like integers, NaN compares false with everything but NOT_EQUAL
+        const auto run = [&](auto predicate)
+        {
+            return RunBatchKernel<8>(count, results, [&](size_t i)
+            {
+                const __m256 v = _mm256_loadu_ps(values + i);
+                return static_cast<uint64_t>(_mm256_movemask_ps(_mm256_cmp_ps(v, c, decltype(predicate)::value)));
+            });
+        };
+
+        switch (type)
+        {
+            case ComparisonType::EQUAL: return run(std::integral_constant<int, _CMP_EQ_OQ>{});
+            case ComparisonType::NOT_EQUAL: return run(std::integral_constant<int, _CMP_NEQ_UQ>{});
+            case ComparisonType::LESS: return run(std::integral_constant<int, _CMP_LT_OQ>{});
+            case ComparisonType::LESS_EQUAL: return run(std::integral_constant<int, _CMP_LE_OQ>{});
+            case ComparisonType::GREATER: return run(std::integral_constant<int, _CMP_GT_OQ>{});
+            case ComparisonType::GREATER_EQUAL: return run(std::integral_constant<int, _CMP_GE_OQ>{});
+            default: return 0;
+        }
+    }
+
+    inline size_t BatchCompareSimd(const double* values, size_t count, double constant, ComparisonType type, uint64_t* results)
+    {
+        const __m256d c = _mm256_set1_pd(constant);
+        const auto run = [&](auto predicate)
+        {
+            return RunBatchKernel<4>(count, results, [&](size_t i)
+            {
+                const __m256d v = _mm256_loadu_pd(values + i);
+                return static_cast<uint64_t>(_mm256_movemask_pd(_mm256_cmp_pd(v, c, decltype(predicate)::value)));
+            });
+        };
+
+        switch (type)
+        {
+            case ComparisonType::EQUAL: return run(std::integral_constant<int, _CMP_EQ_OQ>{});
+            case ComparisonType::NOT_EQUAL: return run(std::integral_constant<int, _CMP_NEQ_UQ>{});
+            case ComparisonType::LESS: return run(std::integral_constant<int, _CMP_LT_OQ>{});
+            case ComparisonType::LESS_EQUAL: return run(std::integral_constant<int, _CMP_LE_OQ>{});
+            case ComparisonType::GREATER: return run(std::integral_constant<int, _CMP_GT_OQ>{});
+            case ComparisonType::GREATER_EQUAL: return run(std::integral_constant<int, _CMP_GE_OQ>{});
+            default: return 0;
+        }
+    }
+
+    inline size_t BatchCompareSimd(const int* values, size_t count, int constant, ComparisonType type, uint64_t* results)
+    {
+        static_assert(sizeof(int) == 4);
+        const __m256i c = _mm256_set1_epi32(constant);
+        const auto load = [values](size_t i) { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + i)); };
+        const auto mask = [](__m256i m) { return static_cast<uint64_t>(_mm256_movemask_ps(_mm256_castsi256_ps(m))); };
+
+        return RunIntegerBatchKernels<8>(type, count, results,
+            [&](size_t i) { return mask(_mm256_cmpeq_epi32(load(i), c)); },
+            [&](size_t i) { return mask(_mm256_cmpgt_epi32(load(i), c)); },
+            [&](size_t i) { return mask(_mm256_cmpgt_epi32(c, load(i))); });
+    }
+
+    inline size_t BatchCompareSimd(const bool* values, size_t count, bool constant, ComparisonType type, uint64_t* results)
+    {
+        static_assert(sizeof(bool) == 1);
+        // A bool is stored as 0 or 1, so it can be compared as a signed byte
+        const __m256i c = _mm256_set1_epi8(static_cast<char>(constant));
+        const auto load = [values](size_t i) { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + i)); };
+        const auto mask = [](__m256i m) { return static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(m))); };
+
+        return RunIntegerBatchKernels<32>(type, count, results,
+            [&](size_t i) { return mask(_mm256_cmpeq_epi8(load(i), c)); },
+            [&](size_t i) { return mask(_mm256_cmpgt_epi8(load(i), c)); },
+            [&](size_t i) { return mask(_mm256_cmpgt_epi8(c, load(i))); });
+    }
+
+#elif defined(FLUCZAKAI_BATCH_SSE2)
+
+    inline size_t BatchCompareSimd(const float* values, size_t count, float constant, ComparisonType type, uint64_t* results)
+    {
+        const __m128 c = _mm_set1_ps(constant);
+        const auto load = [values](size_t i) { return _mm_loadu_ps(values + i); };
+        const auto mask = [](__m128 m) { return static_cast<uint64_t>(_mm_movemask_ps(m)); };
+
+        switch (type)
+        {
+            case ComparisonType::EQUAL: return RunBatchKernel<4>(count, results, [&](size_t i) { return mask(_mm_cmpeq_ps(load(i), c)); });
+            case ComparisonType::NOT_EQUAL: return RunBatchKernel<4>(count, results, [&](size_t i) { return mask(_mm_cmpneq_ps(load(i), c)); });
+            case ComparisonType::LESS: return RunBatchKernel<4>(count, results, [&](size_t i) { return mask(_mm_cmplt_ps(load(i), c)); });
+            case ComparisonType::LESS_EQUAL: return RunBatchKernel<4>(count, results, [&](size_t i) { return mask(_mm_cmple_ps(load(i), c)); });
+            case ComparisonType::GREATER: return RunBatchKernel<4>(count, results, [&](size_t i) { return mask(_mm_cmpgt_ps(load(i), c)); });
+            case ComparisonType::GREATER_EQUAL: return RunBatchKernel<4>(count, results, [&](size_t i) { return mask(_mm_cmpge_ps(load(i), c)); });
+            default: return 0;
+        }
+    }
+
+    inline size_t BatchCompareSimd(const double* values, size_t count, double constant, ComparisonType type, uint64_t* results)
+    {
+        const __m128d c = _mm_set1_pd(constant);
+        const auto load = [values](size_t i) { return _mm_loadu_pd(values + i); };
+        const auto mask = [](__m128d m) { return static_cast<uint64_t>(_mm_movemask_pd(m)); };
+
+        switch (type)
+        {
+            case ComparisonType::EQUAL: return RunBatchKernel<2>(count, results, [&](size_t i) { return mask(_mm_cmpeq_pd(load(i), c)); });
+            case ComparisonType::NOT_EQUAL: return RunBatchKernel<2>(count, results, [&](size_t i) { return mask(_mm_cmpneq_pd(load(i), c)); });
+            case ComparisonType::LESS: return RunBatchKernel<2>(count, results, [&](size_t i) { return mask(_mm_cmplt_pd(load(i), c)); });
+            case ComparisonType::LESS_EQUAL: return RunBatchKernel<2>(count, results, [&](size_t i) { return mask(_mm_cmple_pd(load(i), c)); });
+            case ComparisonType::GREATER: return RunBatchKernel<2>(count, results, [&](size_t i) { return mask(_mm_cmpgt_pd(load(i), c)); });
+            case ComparisonType::GREATER_EQUAL: return RunBatchKernel<2>(count, results, [&](size_t i) { return mask(_mm_cmpge_pd(load(i), c)); });
+            default: return 0;
+        }
+    }
+
+    inline size_t BatchCompareSimd(const int* values, size_t count, int constant, ComparisonType type, uint64_t* results)
+    {
+        static_assert(sizeof(int) == 4);
+        const __m128i c = _mm_set1_epi32(constant);
+        const auto load = [values](size_t i) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(values + i)); };
+        const auto mask = [](__m128i m) { return static_cast<uint64_t>(_mm_movemask_ps(_mm_castsi128_ps(m))); };
+
+        return RunIntegerBatchKernels<4>(type, count, results,
+            [&](size_t i) { return mask(_mm_cmpeq_epi32(load(i), c)); },
+            [&](size_t i) { return mask(_mm_cmpgt_epi32(load(i), c)); },
+            [&](size_t i) { return mask(_mm_cmplt_epi32(load(i), c)); });
+    }
+
+    inline size_t BatchCompareSimd(const bool* values, size_t count, bool constant, ComparisonType type, uint64_t* results)
+    {
+        static_assert(sizeof(bool) == 1);
+        const __m128i c = _mm_set1_epi8(static_cast<char>(constant));
+        const auto load = [values](size_t i) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(values + i)); };
+        const auto mask = [](__m128i m) { return static_cast<uint64_t>(static_cast<uint32_t>(_mm_movemask_epi8(m))); };
+
+        return RunIntegerBatchKernels<16>(type, count, results,
+            [&](size_t i) { return mask(_mm_cmpeq_epi8(load(i), c)); },
+            [&](size_t i) { return mask(_mm_cmpgt_epi8(load(i), c)); },
+            [&](size_t i) { return mask(_mm_cmplt_epi8(load(i), c)); });
+    }
+
+#endif
+}
+}
@@ -0,0 +1,14 @@
+#pragma once
+
+namespace fluczakAI
+{
+enum class ComparisonType
+{
+    EQUAL = 0,
+    NOT_EQUAL = 1,
+    LESS = 2,
+    LESS_EQUAL = 3,
+    GREATER = 4,
+    GREATER_EQUAL = 5
+};
+}
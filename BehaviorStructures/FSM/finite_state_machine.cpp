@@ -1,7 +1,7 @@
 #include "finite_state_machine.hpp"
 
 #include <sstream>
-#include "../Blackboards/comparator.hpp"
+#include "../Blackboards/Comparator.hpp"
 #include "../Serialization/editor_variables.hpp"
 #include "../Serialization/generic_factory.hpp"
 
@@ -29,7 +29,11 @@ void fluczakAI::FiniteStateMachine::Execute(StateMachineContext& context)
 
     const auto currentStateIndex = context.currentState.value();
 
-    for (const auto& transitionData : m_transitions[currentStateIndex])
+    // A lookup that doesn't insert, so contexts can be executed by multiple threads at once
+    static const std::vector<TransitionData> noTransitions{};
+    const auto transitions = m_transitions.find(currentStateIndex);
+
+    for (const auto& transitionData : transitions != m_transitions.end() ? transitions->second : noTransitions)
     {
         if (!transitionData.CanTransition(context))
         {
@@ -52,6 +56,25 @@ void fluczakAI::FiniteStateMachine::Execute(StateMachineContext& context)
     m_states[currentStateIndex]->Update(context);
 }
 
+void fluczakAI::FiniteStateMachine::BindLayout(const BlackboardLayout& layout)
+{
+    for (auto& pair : m_transitions)
+    {
+        for (auto& transitionData : pair.second)
+        {
+            for (auto& comparator : transitionData.comparators)
+            {
+                comparator->BindLayout(layout);
+            }
+        }
+    }
+}
+
+void fluczakAI::FiniteStateMachine::InitializeContext(StateMachineContext& context) const
+{
+    context.currentState.reset();
+}
+
 void fluczakAI::FiniteStateMachine::SetCurrentState(size_t stateToSet, StateMachineContext& context) const
 {
     if (context.currentState.has_value())
@@ -179,6 +202,12 @@ void fluczakAI::FiniteStateMachine::Deserialize(nlohmann::json& json)
     DeserializeTransitionData(json["transition-data"]);
 }
 
+void fluczakAI::FiniteStateMachine::Deserialize(nlohmann::json& json, const BlackboardLayout& layout)
+{
+    Deserialize(json);
+    BindLayout(layout);
+}
+
 void fluczakAI::FiniteStateMachine::SerializeTransitions(nlohmann::json& transitions) const
 {
 	for (auto& pair : m_transitions)
@@ -8,7 +8,7 @@
 
 #include "../Serialization/iserializable.hpp"
 #include "../Blackboards/Blackboard.hpp"
-#include "../Blackboards/comparator.hpp"
+#include "../Blackboards/Comparator.hpp"
 #include "../execution_context.hpp"
 
 
@@ -28,6 +28,8 @@ struct StateMachineContext : AIExecutionContext
 private:
     std::optional<size_t> currentState;
     friend class FiniteStateMachine;
+    friend class CheckpointReader;
+    friend class StaticStateMachine;
 };
 
 struct TransitionData
@@ -247,6 +249,13 @@ public:
      */
     void SetCurrentState(size_t stateToSet,StateMachineContext& context) const;
 
+    /**
+     * \brief Reset a context to its state before its first execution, without ending its current state. The next
+     * Execute starts from the default state.
+     * \param context - StateMachineContext
+     */
+    void InitializeContext(StateMachineContext& context) const;
+
     /**
      * \brief Get a vector of IDs of states of a given type. If no states like this exist,
      * an empty vector is returned.
@@ -282,11 +291,19 @@ public:
         return typeid(*m_states[index]);
     }
 
+    /**
+     * \brief Resolve the blackboard keys of all transitions to the slots of a given layout, so blackboards
+     * using that layout are read at constant offsets
+     * \param layout - the layout of the blackboards the state machine is going to be executed with
+     */
+    void BindLayout(const BlackboardLayout& layout);
+
     #if defined(NLOHMANN_JSON_VERSION_MAJOR)
 		void DeserializeStates(const nlohmann::json& json);
 		void DeserializeTransitions(const nlohmann::json& json, TransitionData& tempData) const;
 		void DeserializeTransitionData(const nlohmann::json& json);
 	    void Deserialize(nlohmann::json& json) override;
+	    void Deserialize(nlohmann::json& json, const BlackboardLayout& layout);
 
         void SerializeTransitions(nlohmann::json& transitions) const;
         void SerializeStates(nlohmann::json& states)const;
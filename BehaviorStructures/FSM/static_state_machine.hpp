@@ -0,0 +1,27 @@
+#pragma once
+#include <cstddef>
+#include <optional>
+#include "finite_state_machine.hpp"
+
+namespace fluczakAI
+{
+/**
+ * \brief The base of the state machines generated by CodeGenerator. A generated machine keeps its states as
+ * members and has an Execute that switches on the current state and evaluates the comparators of its transitions
+ * inline, so it doesn't call states virtually or look its transitions up. It executes a StateMachineContext the
+ * same way FiniteStateMachine::Execute does.
+ */
+class StaticStateMachine
+{
+public:
+    /**
+     * \brief Reset a context to its state before its first execution, without ending its current state. The next
+     * Execute starts from the default state.
+     * \param context - StateMachineContext
+     */
+    void InitializeContext(StateMachineContext& context) const { context.currentState.reset(); }
+
+protected:
+    static std::optional<size_t>& CurrentState(StateMachineContext& context) { return context.currentState; }
+};
+}
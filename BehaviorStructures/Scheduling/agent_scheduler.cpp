@@ -0,0 +1,102 @@
+#include "agent_scheduler.hpp"
+
+template <typename TFunction>
+void fluczakAI::AgentScheduler::ForEachAwake(size_t count, TFunction&& function)
+{
+    if (m_pendingSleeps.size() != m_pool.GetWorkerCount())
+    {
+        m_pendingSleeps.resize(m_pool.GetWorkerCount());
+    }
+
+    ForEach(count, std::forward<TFunction>(function));
+
+    // Falling asleep and waking up touch the timers and the subscriptions, so it's done on this thread
+    for (auto& pendingSleeps : m_pendingSleeps)
+    {
+        for (const PendingSleep& pending : pendingSleeps)
+        {
+            m_sleepManager.Update(*pending.context, *pending.blackboard);
+        }
+        pendingSleeps.clear();
+    }
+}
+
+void fluczakAI::AgentScheduler::Tick(const BehaviorTree& tree, BehaviorTreeContext* contexts, size_t count)
+{
+    ForEachAwake(count, [this, &tree, contexts](size_t begin, size_t end, WorkerContext& worker)
+    {
+        for (size_t i = begin; i < end; i++)
+        {
+            if (!m_sleepManager.ShouldTick(contexts[i])) continue;
+            tree.Execute(contexts[i]);
+            ReportTicked(contexts[i], worker);
+        }
+    });
+}
+
+void fluczakAI::AgentScheduler::Tick(const FlatBehaviorTree& tree, BehaviorTreeContext* contexts, size_t count, bool resume)
+{
+    ForEachAwake(count, [this, &tree, contexts, resume](size_t begin, size_t end, WorkerContext& worker)
+    {
+        for (size_t i = begin; i < end; i++)
+        {
+            if (!m_sleepManager.ShouldTick(contexts[i])) continue;
+            if (resume) tree.Resume(contexts[i]);
+            else tree.Execute(contexts[i]);
+            ReportTicked(contexts[i], worker);
+        }
+    });
+}
+
+void fluczakAI::AgentScheduler::TickBatched(const FlatBehaviorTree& tree, BehaviorTreeContext* contexts, size_t count)
+{
+    if (m_batchedTree != &tree || m_executors.size() != m_pool.GetWorkerCount())
+    {
+        m_batchedTree = &tree;
+        m_executors.clear();
+        m_executors.resize(m_pool.GetWorkerCount());
+    }
+
+    ForEachAwake(count, [this, &tree, contexts](size_t begin, size_t end, WorkerContext& worker)
+    {
+        // The chunks running on a worker are nested, never interleaved, so the depth picks an executor that
+        // isn't in use
+        WorkerExecutors& workerExecutors = m_executors[worker.index];
+        if (workerExecutors.depth == workerExecutors.executors.size())
+        {
+            workerExecutors.executors.push_back(std::make_unique<BatchBehaviorTreeExecutor>(tree));
+        }
+        BatchBehaviorTreeExecutor& executor = *workerExecutors.executors[workerExecutors.depth++];
+
+        // The executor takes contiguous contexts, so every run of awake contexts is executed on its own
+        size_t i = begin;
+        while (i < end)
+        {
+            while (i < end && !m_sleepManager.ShouldTick(contexts[i])) i++;
+            const size_t runBegin = i;
+            while (i < end && m_sleepManager.ShouldTick(contexts[i])) i++;
+            if (runBegin == i) continue;
+
+            executor.Execute({contexts + runBegin, i - runBegin});
+            for (size_t j = runBegin; j < i; j++)
+            {
+                ReportTicked(contexts[j], worker);
+            }
+        }
+
+        workerExecutors.depth--;
+    });
+}
+
+void fluczakAI::AgentScheduler::Tick(FiniteStateMachine& stateMachine, StateMachineContext* contexts, size_t count)
+{
+    ForEachAwake(count, [this, &stateMachine, contexts](size_t begin, size_t end, WorkerContext& worker)
+    {
+        for (size_t i = begin; i < end; i++)
+        {
+            if (!m_sleepManager.ShouldTick(contexts[i])) continue;
+            stateMachine.Execute(contexts[i]);
+            ReportTicked(contexts[i], worker);
+        }
+    });
+}
@@ -0,0 +1,132 @@
+#pragma once
+#include <memory>
+#include <vector>
+#include "sleep_manager.hpp"
+#include "thread_pool.hpp"
+#include "../BehaviorTrees/batch_behavior_tree_executor.hpp"
+#include "../BehaviorTrees/behavior_tree.hpp"
+#include "../BehaviorTrees/flat_behavior_tree.hpp"
+#include "../FSM/finite_state_machine.hpp"
+
+namespace fluczakAI
+{
+/**
+ * \brief Ticks large populations of agents on all cores. The contexts are split into chunks of agents that are
+ * executed by the workers of a ThreadPool, and idle workers steal chunks from the busy ones.
+ * Agents are ticked in parallel, so their contexts must not share anything the behaviors and states write to,
+ * the blackboards included. Shared blackboards can only be read.
+ * Contexts that ask to sleep are skipped until AdvanceTime wakes them up or a key they wait for changes, see
+ * SleepManager.
+ */
+class AgentScheduler
+{
+public:
+    /**
+     * \param pool - the threads to tick the agents on, it has to outlive the scheduler
+     * \param chunkSize - number of agents ticked by a single task, 0 to pick one from the number of workers
+     */
+    explicit AgentScheduler(ThreadPool& pool, size_t chunkSize = 0) : m_pool(pool), m_chunkSize(chunkSize) {}
+
+    /**
+     * \brief Execute a behavior tree once for every context
+     * \param tree - the tree to execute
+     * \param contexts - the contexts of the agents
+     * \param count - number of contexts
+     */
+    void Tick(const BehaviorTree& tree, BehaviorTreeContext* contexts, size_t count);
+
+    /**
+     * \brief Execute a flattened behavior tree once for every context
+     * \param tree - the tree to execute
+     * \param contexts - the contexts of the agents
+     * \param count - number of contexts
+     * \param resume - whether to use FlatBehaviorTree::Resume instead of Execute
+     */
+    void Tick(const FlatBehaviorTree& tree, BehaviorTreeContext* contexts, size_t count, bool resume = false);
+
+    /**
+     * \brief Execute a flattened behavior tree once for every context, every chunk of agents is executed
+     * together by a BatchBehaviorTreeExecutor of its worker
+     * \param tree - the tree to execute
+     * \param contexts - the contexts of the agents
+     * \param count - number of contexts
+     */
+    void TickBatched(const FlatBehaviorTree& tree, BehaviorTreeContext* contexts, size_t count);
+
+    /**
+     * \brief Execute a finite state machine once for every context
+     * \param stateMachine - the state machine to execute
+     * \param contexts - the contexts of the agents
+     * \param count - number of contexts
+     */
+    void Tick(FiniteStateMachine& stateMachine, StateMachineContext* contexts, size_t count);
+
+    /**
+     * \brief Call a function for every chunk of agents, for updates that aren't a tree or a state machine
+     * \param count - number of agents
+     * \param function - called as function(begin, end, WorkerContext&) for every chunk
+     */
+    template <typename TFunction>
+    void ForEach(size_t count, TFunction&& function)
+    {
+        m_pool.ParallelFor(count, m_chunkSize, std::forward<TFunction>(function));
+    }
+
+    /**
+     * \brief Advance the time of the sleeping contexts, waking up the ones whose sleep time is over. Called once
+     * per frame, before ticking.
+     * \param deltaTime - time in seconds since the last call
+     */
+    void AdvanceTime(float deltaTime) { m_sleepManager.Advance(deltaTime); }
+
+    ThreadPool& GetPool() const { return m_pool; }
+    SleepManager& GetSleepManager() { return m_sleepManager; }
+
+private:
+    /**
+     * \brief A context that was ticked and has to be passed to SleepManager::Update
+     */
+    struct PendingSleep
+    {
+        AIExecutionContext* context;
+        Blackboard* blackboard;
+    };
+
+    /**
+     * \brief Call a function for every chunk of agents, the function ticks the contexts that are awake and reports
+     * them with ReportTicked
+     */
+    template <typename TFunction>
+    void ForEachAwake(size_t count, TFunction&& function);
+
+    template <typename TContext>
+    void ReportTicked(TContext& context, WorkerContext& worker)
+    {
+        if (m_sleepManager.NeedsUpdate(context))
+        {
+            m_pendingSleeps[worker.index].push_back({&context, context.blackboard.get()});
+        }
+    }
+
+    ThreadPool& m_pool;
+    size_t m_chunkSize = 0;
+    SleepManager m_sleepManager{};
+    // The contexts to update the sleep of after a tick, by worker
+    std::vector<std::vector<PendingSleep>> m_pendingSleeps{};
+
+    /**
+     * \brief The executors of a worker. A behavior that waits for parallel work on the same pool, e.g. a threaded
+     * Parallel, runs other chunks on its worker in the meantime, so a chunk started on top of a running one gets
+     * the executor of the next depth.
+     */
+    struct WorkerExecutors
+    {
+        std::vector<std::unique_ptr<BatchBehaviorTreeExecutor>> executors{};
+        size_t depth = 0;
+    };
+
+    // The executors by worker, made for the tree that was last ticked batched
+    const FlatBehaviorTree* m_batchedTree = nullptr;
+    std::vector<WorkerExecutors> m_executors{};
+};
+}
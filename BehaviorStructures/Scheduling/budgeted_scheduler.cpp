@@ -0,0 +1,159 @@
+#include "budgeted_scheduler.hpp"
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+
+fluczakAI::BudgetedScheduler::BudgetedScheduler(float budget, std::vector<uint32_t> bucketIntervals) : m_budget(budget)
+{
+    assert(!bucketIntervals.empty());
+    m_buckets.resize(bucketIntervals.size());
+    for (size_t i = 0; i < bucketIntervals.size(); i++)
+    {
+        m_buckets[i].interval = std::max(1u, bucketIntervals[i]);
+    }
+}
+
+fluczakAI::BudgetedScheduler::AgentId fluczakAI::BudgetedScheduler::Add(BehaviorTreeContext& context, const BehaviorTree& tree, uint32_t bucket)
+{
+    return Add(context, const_cast<BehaviorTree*>(&tree), [](void* structure, AIExecutionContext& agentContext, float deltaTime) -> Blackboard&
+    {
+        auto& treeContext = static_cast<BehaviorTreeContext&>(agentContext);
+        treeContext.deltaTime = deltaTime;
+        static_cast<const BehaviorTree*>(structure)->Execute(treeContext);
+        return *treeContext.blackboard;
+    }, bucket);
+}
+
+fluczakAI::BudgetedScheduler::AgentId fluczakAI::BudgetedScheduler::Add(StateMachineContext& context, FiniteStateMachine& stateMachine, uint32_t bucket)
+{
+    return Add(context, &stateMachine, [](void* structure, AIExecutionContext& agentContext, float deltaTime) -> Blackboard&
+    {
+        auto& stateMachineContext = static_cast<StateMachineContext&>(agentContext);
+        stateMachineContext.deltaTime = deltaTime;
+        static_cast<FiniteStateMachine*>(structure)->Execute(stateMachineContext);
+        return *stateMachineContext.blackboard;
+    }, bucket);
+}
+
+fluczakAI::BudgetedScheduler::AgentId fluczakAI::BudgetedScheduler::Add(AIExecutionContext& context, void* structure, Blackboard& (*tick)(void*, AIExecutionContext&, float), uint32_t bucket)
+{
+    AgentId agent;
+    if (!m_freeAgents.empty())
+    {
+        agent = m_freeAgents.back();
+        m_freeAgents.pop_back();
+    }
+    else
+    {
+        agent = static_cast<AgentId>(m_agents.size());
+        m_agents.emplace_back();
+    }
+
+    m_agents[agent] = {&context, structure, tick, m_time, 0, 0};
+    Insert(agent, bucket);
+    return agent;
+}
+
+void fluczakAI::BudgetedScheduler::Remove(AgentId agent)
+{
+    assert(agent < m_agents.size() && m_agents[agent].context != nullptr);
+    m_sleepManager.Wake(*m_agents[agent].context);
+    Erase(agent);
+    m_agents[agent] = {};
+    m_freeAgents.push_back(agent);
+}
+
+void fluczakAI::BudgetedScheduler::SetBucket(AgentId agent, uint32_t bucket)
+{
+    assert(agent < m_agents.size() && m_agents[agent].context != nullptr);
+    if (m_agents[agent].bucket == bucket) return;
+    Erase(agent);
+    Insert(agent, bucket);
+}
+
+fluczakAI::BudgetedScheduler::FrameStats fluczakAI::BudgetedScheduler::Update(float deltaTime)
+{
+    using Clock = std::chrono::steady_clock;
+    m_time += deltaTime;
+    m_sleepManager.Advance(deltaTime);
+
+    FrameStats stats;
+    const Clock::time_point start = Clock::now();
+    float elapsed = 0.0f;
+
+    for (Bucket& bucket : m_buckets)
+    {
+        const auto size = static_cast<uint64_t>(bucket.agents.size());
+        // Agents deferred for longer than a whole round are ticked once, not once per missed round
+        bucket.owed = std::min(bucket.owed + size, size * bucket.interval);
+
+        while (bucket.owed >= bucket.interval && (elapsed < m_budget || stats.ticked == 0))
+        {
+            Agent& agent = m_agents[bucket.agents[bucket.cursor]];
+            bucket.cursor = (bucket.cursor + 1) % bucket.agents.size();
+            bucket.owed -= bucket.interval;
+
+            // A sleeping agent keeps the time since its last tick for when it wakes up
+            if (!m_sleepManager.ShouldTick(*agent.context))
+            {
+                stats.asleep++;
+                continue;
+            }
+
+            Blackboard& blackboard = agent.tick(agent.structure, *agent.context, static_cast<float>(m_time - agent.lastTick));
+            agent.lastTick = m_time;
+            if (m_sleepManager.NeedsUpdate(*agent.context))
+            {
+                m_sleepManager.Update(*agent.context, blackboard);
+            }
+
+            stats.ticked++;
+            elapsed = std::chrono::duration<float>(Clock::now() - start).count();
+        }
+
+        stats.deferred += static_cast<size_t>(bucket.owed / bucket.interval);
+    }
+
+    stats.elapsed = elapsed;
+    stats.overrun = std::max(0.0f, elapsed - m_budget);
+    m_lastFrame = stats;
+
+    if (stats.overrun > 0.0f && m_onOverrun)
+    {
+        m_onOverrun(stats);
+    }
+
+    return stats;
+}
+
+void fluczakAI::BudgetedScheduler::Insert(AgentId agent, uint32_t bucket)
+{
+    assert(bucket < m_buckets.size());
+    m_agents[agent].bucket = bucket;
+    m_agents[agent].position = static_cast<uint32_t>(m_buckets[bucket].agents.size());
+    m_buckets[bucket].agents.push_back(agent);
+}
+
+void fluczakAI::BudgetedScheduler::Erase(AgentId agent)
+{
+    Bucket& bucket = m_buckets[m_agents[agent].bucket];
+    uint32_t position = m_agents[agent].position;
+
+    // The last agent takes the place of the removed one. It hasn't been ticked this round, so if the removed one
+    // has, the last ticked agent fills the hole and the last agent takes its place at the cursor instead. That way
+    // no agent is skipped or ticked twice in the round.
+    if (position < bucket.cursor)
+    {
+        bucket.cursor--;
+        const AgentId lastTicked = bucket.agents[bucket.cursor];
+        bucket.agents[position] = lastTicked;
+        m_agents[lastTicked].position = position;
+        position = static_cast<uint32_t>(bucket.cursor);
+    }
+    bucket.agents[position] = bucket.agents.back();
+    m_agents[bucket.agents[position]].position = position;
+    bucket.agents.pop_back();
+
+    if (bucket.cursor >= bucket.agents.size()) bucket.cursor = 0;
+    bucket.owed = std::min<uint64_t>(bucket.owed, bucket.agents.size() * bucket.interval);
+}
@@ -0,0 +1,136 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <vector>
+#include "../BehaviorTrees/behavior_tree.hpp"
+#include "../FSM/finite_state_machine.hpp"
+#include "sleep_manager.hpp"
+
+namespace fluczakAI
+{
+/**
+ * \brief Ticks agents within a time budget per frame. Every agent is in a LOD bucket, and every bucket has an
+ * interval of frames: the agents of a bucket with an interval of 4 are ticked round robin, a quarter of them
+ * per frame. Buckets are ticked in order, bucket 0 first, until the budget runs out. Agents that don't fit are
+ * ticked on a later frame, and an agent's deltaTime is always the time since its last tick.
+ * Agents that ask to sleep with AIExecutionContext::Sleep or SleepUntilChanged keep their place in the round, but
+ * are skipped without using the budget until they wake up.
+ * The contexts, trees and state machines are stored by address, so they must not move while registered.
+ */
+class BudgetedScheduler
+{
+public:
+    using AgentId = uint32_t;
+
+    /**
+     * \brief What happened during a frame
+     */
+    struct FrameStats
+    {
+        // Number of agents ticked
+        size_t ticked = 0;
+        // Number of agents that were due but didn't fit into the budget
+        size_t deferred = 0;
+        // Number of agents that were due but asleep
+        size_t asleep = 0;
+        // Time spent ticking in seconds
+        float elapsed = 0.0f;
+        // Time spent over the budget in seconds, 0 if the frame was within the budget
+        float overrun = 0.0f;
+    };
+
+    /**
+     * \param budget - time in seconds the agents can be ticked for every frame
+     * \param bucketIntervals - the number of frames it takes to tick every agent of a bucket once, by bucket
+     */
+    explicit BudgetedScheduler(float budget, std::vector<uint32_t> bucketIntervals = {1, 2, 4, 8});
+
+    /**
+     * \brief Register an agent with a behavior tree
+     * \param context - the context of the agent
+     * \param tree - the tree to tick the agent with
+     * \param bucket - the LOD bucket of the agent
+     * \return - an id of the agent
+     */
+    AgentId Add(BehaviorTreeContext& context, const BehaviorTree& tree, uint32_t bucket);
+
+    /**
+     * \brief Register an agent with a state machine
+     * \param context - the context of the agent
+     * \param stateMachine - the state machine to tick the agent with
+     * \param bucket - the LOD bucket of the agent
+     * \return - an id of the agent
+     */
+    AgentId Add(StateMachineContext& context, FiniteStateMachine& stateMachine, uint32_t bucket);
+
+    /**
+     * \brief Unregister an agent, its id can be reused. The agent is woken up if it sleeps.
+     */
+    void Remove(AgentId agent);
+
+    /**
+     * \brief Move an agent to a different LOD bucket, e.g. when it gets further away from the camera
+     */
+    void SetBucket(AgentId agent, uint32_t bucket);
+
+    /**
+     * \brief Change the time the agents can be ticked for every frame
+     */
+    void SetBudget(float budget) { m_budget = budget; }
+
+    /**
+     * \brief Register a function called at the end of every frame that goes over the budget
+     */
+    void SetOverrunCallback(std::function<void(const FrameStats&)> callback) { m_onOverrun = std::move(callback); }
+
+    /**
+     * \brief Advance the time and tick the agents that are due, for as long as the budget allows. At least one
+     * agent is ticked every frame, so the agents keep going even with no budget. The time also wakes up the
+     * agents whose sleep time is over.
+     * \param deltaTime - time in seconds since the last frame
+     * \return - what happened during the frame
+     */
+    FrameStats Update(float deltaTime);
+
+    const FrameStats& GetLastFrameStats() const { return m_lastFrame; }
+    size_t GetAgentCount() const { return m_agents.size() - m_freeAgents.size(); }
+    SleepManager& GetSleepManager() { return m_sleepManager; }
+
+private:
+    struct Agent
+    {
+        AIExecutionContext* context = nullptr;
+        void* structure = nullptr;
+        // Ticks the agent and returns its blackboard, where the keys it waits for are observed
+        Blackboard& (*tick)(void* structure, AIExecutionContext& context, float deltaTime) = nullptr;
+        // The time of the last tick, or of the registration
+        double lastTick = 0.0;
+        uint32_t bucket = 0;
+        // The index of the agent in its bucket
+        uint32_t position = 0;
+    };
+
+    struct Bucket
+    {
+        uint32_t interval = 1;
+        std::vector<AgentId> agents{};
+        // The next agent to tick, the agents before it were ticked this round
+        size_t cursor = 0;
+        // The number of agents that are due times the interval, including the ones deferred by earlier frames
+        uint64_t owed = 0;
+    };
+
+    AgentId Add(AIExecutionContext& context, void* structure, Blackboard& (*tick)(void*, AIExecutionContext&, float), uint32_t bucket);
+    void Insert(AgentId agent, uint32_t bucket);
+    void Erase(AgentId agent);
+
+    float m_budget;
+    double m_time = 0.0;
+    std::vector<Agent> m_agents{};
+    std::vector<AgentId> m_freeAgents{};
+    std::vector<Bucket> m_buckets{};
+    FrameStats m_lastFrame{};
+    std::function<void(const FrameStats&)> m_onOverrun{};
+    SleepManager m_sleepManager{};
+};
+}
@@ -0,0 +1,87 @@
+#include "sleep_manager.hpp"
+#include <cmath>
+#include <utility>
+
+fluczakAI::SleepManager::~SleepManager()
+{
+    for (size_t i = 0; i < m_records.size(); i++)
+    {
+        if (m_records[i].blackboard != nullptr) Release(static_cast<uint32_t>(i));
+    }
+}
+
+void fluczakAI::SleepManager::Update(AIExecutionContext& context, Blackboard& blackboard)
+{
+    if (context.m_sleepRecord != AIExecutionContext::NotSleeping)
+    {
+        // A context that is still asleep wasn't ticked, so it has nothing new to ask for
+        if (!m_records[context.m_sleepRecord].isAwake.load(std::memory_order_relaxed)) return;
+        Release(std::exchange(context.m_sleepRecord, AIExecutionContext::NotSleeping));
+    }
+
+    if (!context.m_isSleepRequested) return;
+
+    uint32_t index;
+    if (!m_freeRecords.empty())
+    {
+        index = m_freeRecords.back();
+        m_freeRecords.pop_back();
+    }
+    else
+    {
+        index = static_cast<uint32_t>(m_records.size());
+        m_records.emplace_back();
+    }
+
+    Record& record = m_records[index];
+    record.isAwake.store(false, std::memory_order_relaxed);
+    record.blackboard = &blackboard;
+
+    if (std::isfinite(context.m_sleepSeconds))
+    {
+        record.timer = m_timers.Schedule(context.m_sleepSeconds, index);
+    }
+
+    for (const BlackboardKey& key : context.m_wakeKeys)
+    {
+        record.subscriptions.push_back(blackboard.Subscribe(key, [](void* userData, const BlackboardKey&)
+        {
+            static_cast<Record*>(userData)->isAwake.store(true, std::memory_order_relaxed);
+        }, &record));
+    }
+
+    context.m_sleepRecord = index;
+    context.ClearSleepRequest();
+}
+
+void fluczakAI::SleepManager::Wake(AIExecutionContext& context)
+{
+    if (context.m_sleepRecord == AIExecutionContext::NotSleeping) return;
+    Release(std::exchange(context.m_sleepRecord, AIExecutionContext::NotSleeping));
+}
+
+void fluczakAI::SleepManager::Advance(float deltaTime)
+{
+    m_timers.Advance(deltaTime, [this](uint32_t index)
+    {
+        Record& record = m_records[index];
+        record.timer = TimerWheel::InvalidTimer;
+        record.isAwake.store(true, std::memory_order_relaxed);
+    });
+}
+
+void fluczakAI::SleepManager::Release(uint32_t index)
+{
+    Record& record = m_records[index];
+    m_timers.Cancel(record.timer);
+    record.timer = TimerWheel::InvalidTimer;
+
+    for (const Blackboard::SubscriptionId subscription : record.subscriptions)
+    {
+        record.blackboard->Unsubscribe(subscription);
+    }
+    record.subscriptions.clear();
+    record.blackboard = nullptr;
+
+    m_freeRecords.push_back(index);
+}
@@ -0,0 +1,87 @@
+#pragma once
+#include <atomic>
+#include <deque>
+#include <vector>
+#include "timer_wheel.hpp"
+#include "../execution_context.hpp"
+#include "../Blackboards/Blackboard.hpp"
+
+namespace fluczakAI
+{
+/**
+ * \brief Keeps track of the contexts that asked to sleep with AIExecutionContext::Sleep and SleepUntilChanged.
+ * A sleeping context is woken up by a timer wheel or by a change of one of its keys, and until then checking
+ * whether to tick it is a single load.
+ * Every tick goes: ShouldTick, tick the context if it should, then Update if NeedsUpdate. ShouldTick and
+ * NeedsUpdate can be called from many threads at once, the other functions can't.
+ */
+class SleepManager
+{
+public:
+    /**
+     * \param resolution - the precision of sleep times in seconds
+     */
+    explicit SleepManager(float resolution = 1.0f / 60.0f) : m_timers(resolution) {}
+    ~SleepManager();
+
+    SleepManager(const SleepManager&) = delete;
+    SleepManager& operator=(const SleepManager&) = delete;
+
+    /**
+     * \brief Whether or not a context should be ticked, that is it is awake or was woken up
+     */
+    bool ShouldTick(const AIExecutionContext& context) const
+    {
+        return context.m_sleepRecord == AIExecutionContext::NotSleeping || m_records[context.m_sleepRecord].isAwake.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * \brief Whether or not Update has anything to do for a context that was just ticked
+     */
+    bool NeedsUpdate(const AIExecutionContext& context) const
+    {
+        return context.m_isSleepRequested || context.m_sleepRecord != AIExecutionContext::NotSleeping;
+    }
+
+    /**
+     * \brief Called after a context was ticked. Forgets the context if it was woken up and puts it to sleep if it
+     * asked to.
+     * \param context - the context
+     * \param blackboard - the blackboard of the context, the keys it waits for are observed there
+     */
+    void Update(AIExecutionContext& context, Blackboard& blackboard);
+
+    /**
+     * \brief Wake a context up right away. A sleeping context has to be woken before it or its blackboard is
+     * destroyed.
+     */
+    void Wake(AIExecutionContext& context);
+
+    /**
+     * \brief Advance the time, waking the contexts whose sleep time is over
+     * \param deltaTime - time in seconds to advance by
+     */
+    void Advance(float deltaTime);
+
+    /**
+     * \brief Get the number of contexts that are asleep or were woken up and not ticked since
+     */
+    size_t GetSleepingCount() const { return m_records.size() - m_freeRecords.size(); }
+
+private:
+    struct Record
+    {
+        std::atomic<bool> isAwake{false};
+        TimerWheel::TimerId timer = TimerWheel::InvalidTimer;
+        Blackboard* blackboard = nullptr;
+        std::vector<Blackboard::SubscriptionId> subscriptions{};
+    };
+
+    void Release(uint32_t index);
+
+    // A deque, so records don't move while blackboards hold pointers to them
+    std::deque<Record> m_records{};
+    std::vector<uint32_t> m_freeRecords{};
+    TimerWheel m_timers;
+};
+}
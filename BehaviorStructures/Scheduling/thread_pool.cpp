@@ -0,0 +1,98 @@
+#include "thread_pool.hpp"
+
+namespace
+{
+    // The pool the calling thread works for and its index in it
+    thread_local const fluczakAI::ThreadPool* currentPool = nullptr;
+    thread_local size_t currentIndex = 0;
+}
+
+fluczakAI::ThreadPool::ThreadPool(size_t threadCount)
+{
+    if (threadCount == 0)
+    {
+        const size_t cores = std::thread::hardware_concurrency();
+        threadCount = cores > 1 ? cores - 1 : 0;
+    }
+
+    // One more worker for the threads outside of the pool
+    m_workers.resize(threadCount + 1);
+    for (size_t i = 0; i < m_workers.size(); i++)
+    {
+        m_workers[i] = std::make_unique<Worker>();
+        m_workers[i]->context.index = i;
+    }
+
+    m_threads.reserve(threadCount);
+    for (size_t i = 0; i < threadCount; i++)
+    {
+        m_threads.emplace_back(&ThreadPool::WorkerLoop, this, i);
+    }
+}
+
+fluczakAI::ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_sleepMutex);
+        m_stopping = true;
+    }
+    m_wake.notify_all();
+
+    for (auto& thread : m_threads)
+    {
+        thread.join();
+    }
+}
+
+size_t fluczakAI::ThreadPool::CurrentWorker() const
+{
+    return currentPool == this ? currentIndex : m_workers.size() - 1;
+}
+
+void fluczakAI::ThreadPool::PushTask(const Task& task, size_t queue)
+{
+    // Counted before it can be taken, so the count never drops below zero
+    m_queuedTasks.fetch_add(1, std::memory_order_release);
+    m_workers[queue]->tasks.Push(task);
+}
+
+void fluczakAI::ThreadPool::WakeWorkers()
+{
+    // Taking the lock orders the wake up after the check of a worker that is about to sleep
+    {
+        std::lock_guard<std::mutex> lock(m_sleepMutex);
+    }
+    m_wake.notify_all();
+}
+
+bool fluczakAI::ThreadPool::TryRunTask(size_t self)
+{
+    std::optional<Task> task = m_workers[self]->tasks.Pop();
+
+    // Steal from the other workers, starting with the next one so thieves spread over the victims
+    for (size_t i = 1; !task.has_value() && i < m_workers.size(); i++)
+    {
+        task = m_workers[(self + i) % m_workers.size()]->tasks.Steal();
+    }
+
+    if (!task.has_value()) return false;
+
+    m_queuedTasks.fetch_sub(1, std::memory_order_relaxed);
+    task->run(task->job, task->begin, task->end, m_workers[self]->context);
+    return true;
+}
+
+void fluczakAI::ThreadPool::WorkerLoop(size_t index)
+{
+    currentPool = this;
+    currentIndex = index;
+
+    while (true)
+    {
+        if (TryRunTask(index)) continue;
+
+        std::unique_lock<std::mutex> lock(m_sleepMutex);
+        m_wake.wait(lock, [this] { return m_stopping || m_queuedTasks.load(std::memory_order_acquire) != 0; });
+        if (m_stopping) return;
+    }
+}
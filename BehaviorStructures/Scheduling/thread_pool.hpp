@@ -0,0 +1,162 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+#include "work_stealing_deque.hpp"
+#include "../Blackboards/BlackboardArena.hpp"
+
+namespace fluczakAI
+{
+/**
+ * \brief The state of a thread executing tasks of a ThreadPool
+ */
+struct WorkerContext
+{
+    /**
+     * \brief Index of the worker, 0..ThreadPool::GetWorkerCount()-1. Threads outside of the pool that wait
+     * for their tasks help with the work as the last worker.
+     */
+    size_t index = 0;
+
+    /**
+     * \brief Memory for temporary allocations of a task. Everything allocated by a chunk of work is freed once it is done.
+     */
+    BlackboardArena scratch{};
+};
+
+/**
+ * \brief A pool of threads that execute chunks of ranges with work stealing. Every worker has its own deque
+ * of tasks and steals from the other workers once it runs out, so a range of very uneven work still keeps
+ * all of the threads busy. A thread that waits for its tasks executes tasks itself in the meantime, which
+ * also makes it safe to start parallel work from within a task.
+ */
+class ThreadPool
+{
+public:
+    /**
+     * \brief Start the worker threads
+     * \param threadCount - number of threads to start, 0 for one less than the number of cores since the
+     * calling thread helps as well
+     */
+    explicit ThreadPool(size_t threadCount = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /**
+     * \brief Get the number of workers, the threads of the pool plus the one used by outside threads
+     */
+    size_t GetWorkerCount() const { return m_workers.size(); }
+
+    /**
+     * \brief Call a function for the range 0..count split into chunks, in parallel, and wait until all of
+     * the chunks are done. Outside of the pool it should be called by one thread at a time, since all outside
+     * threads share a single worker context.
+     * \param count - size of the range
+     * \param chunkSize - number of elements in a chunk, 0 to pick one from the number of workers
+     * \param function - called as function(begin, end, WorkerContext&) for every chunk
+     */
+    template <typename TFunction>
+    void ParallelFor(size_t count, size_t chunkSize, TFunction&& function)
+    {
+        if (count == 0) return;
+
+        if (chunkSize == 0)
+        {
+            // A few chunks per worker leave room for stealing when the chunks differ in cost
+            chunkSize = std::max<size_t>(1, count / (GetWorkerCount() * 8));
+        }
+
+        using TJob = Job<std::remove_reference_t<TFunction>>;
+        TJob job{&function, this, {(count + chunkSize - 1) / chunkSize}};
+
+        // Only the owner of a deque pushes to it, the other workers get the chunks by stealing them
+        const size_t self = CurrentWorker();
+        for (size_t begin = 0; begin < count; begin += chunkSize)
+        {
+            PushTask({&TJob::Run, &job, begin, std::min(count, begin + chunkSize)}, self);
+        }
+
+        WakeWorkers();
+
+        while (job.remaining.load(std::memory_order_acquire) != 0)
+        {
+            if (TryRunTask(self)) continue;
+
+            // Nothing left to take, the remaining chunks run on other threads. Sleep until the last of them
+            // is done or new tasks show up to help with.
+            std::unique_lock<std::mutex> lock(m_sleepMutex);
+            m_wake.wait(lock, [this, &job]
+            {
+                return job.remaining.load(std::memory_order_acquire) == 0
+                    || m_queuedTasks.load(std::memory_order_acquire) != 0;
+            });
+        }
+    }
+
+private:
+    struct Task
+    {
+        void (*run)(void* job, size_t begin, size_t end, WorkerContext& worker);
+        void* job;
+        size_t begin;
+        size_t end;
+    };
+
+    template <typename TFunction>
+    struct Job
+    {
+        TFunction* function;
+        ThreadPool* pool;
+        std::atomic<size_t> remaining;
+
+        static void Run(void* data, size_t begin, size_t end, WorkerContext& worker)
+        {
+            auto* job = static_cast<Job*>(data);
+            // Chunks of nested loops run on top of the chunk that started them, so only their own memory is freed
+            const BlackboardArena::Marker marker = worker.scratch.GetMarker();
+            (*job->function)(begin, end, worker);
+            worker.scratch.Rewind(marker);
+            // The waiting thread can return as soon as the count reaches zero, the job mustn't be touched after
+            ThreadPool* pool = job->pool;
+            if (job->remaining.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            {
+                pool->WakeWorkers();
+            }
+        }
+    };
+
+    struct Worker
+    {
+        WorkStealingDeque<Task> tasks{};
+        WorkerContext context{};
+    };
+
+    /**
+     * \brief The index of the worker of the calling thread, the last index for threads outside of the pool
+     */
+    size_t CurrentWorker() const;
+
+    void PushTask(const Task& task, size_t queue);
+    /**
+     * \brief Wake up the sleeping workers and the threads waiting for their jobs to finish
+     */
+    void WakeWorkers();
+    bool TryRunTask(size_t self);
+    void WorkerLoop(size_t index);
+
+    std::vector<std::unique_ptr<Worker>> m_workers{};
+    std::vector<std::thread> m_threads{};
+    std::atomic<size_t> m_queuedTasks{0};
+    std::atomic<bool> m_stopping{false};
+    std::mutex m_sleepMutex;
+    std::condition_variable m_wake;
+};
+}
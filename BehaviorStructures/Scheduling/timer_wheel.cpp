@@ -0,0 +1,99 @@
+#include "timer_wheel.hpp"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <utility>
+
+fluczakAI::TimerWheel::TimerWheel(float resolution) : m_resolution(resolution)
+{
+    assert(resolution > 0.0f);
+}
+
+fluczakAI::TimerWheel::TimerId fluczakAI::TimerWheel::Schedule(float delay, uint32_t payload)
+{
+    uint32_t index;
+    if (!m_freeTimers.empty())
+    {
+        index = m_freeTimers.back();
+        m_freeTimers.pop_back();
+    }
+    else
+    {
+        index = static_cast<uint32_t>(m_timers.size());
+        m_timers.emplace_back();
+    }
+
+    // The time already accumulated towards the next tick counts towards the delay
+    const double ticks = std::ceil(std::max(0.0, (static_cast<double>(delay) + m_remainder) / m_resolution));
+    Timer& timer = m_timers[index];
+    timer.deadline = m_now + std::max<uint64_t>(1, static_cast<uint64_t>(std::min(ticks, 1e18)));
+    timer.payload = payload;
+    Insert(index);
+    m_timerCount++;
+
+    return static_cast<TimerId>(timer.generation) << 32 | index;
+}
+
+void fluczakAI::TimerWheel::Cancel(TimerId id)
+{
+    const auto index = static_cast<uint32_t>(id);
+    if (id == InvalidTimer || index >= m_timers.size()) return;
+
+    const Timer& timer = m_timers[index];
+    if (timer.slot == None || timer.generation != static_cast<uint32_t>(id >> 32)) return;
+
+    Unlink(index);
+    Free(index);
+}
+
+void fluczakAI::TimerWheel::Insert(uint32_t index)
+{
+    Timer& timer = m_timers[index];
+    const uint64_t delta = timer.deadline > m_now ? timer.deadline - m_now : 0;
+
+    // The finest level whose range covers the timer, timers past the last level wait in its furthest slot and
+    // are placed again when it comes up
+    uint32_t level = 0;
+    while (level + 1 < LevelCount && delta >= uint64_t{1} << (SlotBits * (level + 1))) level++;
+
+    uint64_t deadline = timer.deadline;
+    if (delta >= uint64_t{1} << (SlotBits * LevelCount))
+    {
+        deadline = m_now + (uint64_t{SlotMask} << (SlotBits * level));
+    }
+
+    const uint32_t slot = level * SlotCount + static_cast<uint32_t>((deadline >> (SlotBits * level)) & SlotMask);
+    timer.slot = slot;
+    timer.previous = None;
+    timer.next = m_slots[slot];
+    if (timer.next != None) m_timers[timer.next].previous = index;
+    m_slots[slot] = index;
+}
+
+void fluczakAI::TimerWheel::Cascade(uint32_t slot)
+{
+    uint32_t index = std::exchange(m_slots[slot], None);
+    while (index != None)
+    {
+        const uint32_t next = m_timers[index].next;
+        Insert(index);
+        index = next;
+    }
+}
+
+void fluczakAI::TimerWheel::Unlink(uint32_t index)
+{
+    Timer& timer = m_timers[index];
+    if (timer.previous != None) m_timers[timer.previous].next = timer.next;
+    else m_slots[timer.slot] = timer.next;
+    if (timer.next != None) m_timers[timer.next].previous = timer.previous;
+    timer.slot = None;
+}
+
+void fluczakAI::TimerWheel::Free(uint32_t index)
+{
+    // A new generation makes the ids of the expired timer stale
+    m_timers[index].generation++;
+    m_freeTimers.push_back(index);
+    m_timerCount--;
+}
@@ -0,0 +1,118 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace fluczakAI
+{
+/**
+ * \brief A hierarchical timer wheel. Time is counted in ticks of a fixed resolution, and timers are kept in
+ * levels of 64 slots, each level 64 times coarser than the one below. Scheduling and cancelling a timer is O(1),
+ * and advancing the wheel only touches the timers that expire, plus the ones moved to a finer level once their
+ * slot comes up.
+ */
+class TimerWheel
+{
+public:
+    using TimerId = uint64_t;
+    static constexpr TimerId InvalidTimer = ~TimerId{0};
+
+    /**
+     * \param resolution - length of a tick in seconds, timers expire on the first tick at or after their time
+     */
+    explicit TimerWheel(float resolution = 1.0f / 60.0f);
+
+    /**
+     * \brief Schedule a timer
+     * \param delay - time in seconds until the timer expires, at least one tick
+     * \param payload - value passed to the callback of Advance
+     * \return - an id used to cancel the timer
+     */
+    TimerId Schedule(float delay, uint32_t payload);
+
+    /**
+     * \brief Cancel a timer that hasn't expired yet, does nothing if it has
+     */
+    void Cancel(TimerId id);
+
+    /**
+     * \brief Advance the time and call a callback for every timer that expires, in order of expiry. The callback
+     * can schedule and cancel timers.
+     * \param deltaTime - time in seconds to advance by
+     * \param onExpired - called as onExpired(payload)
+     */
+    template <typename TCallback>
+    void Advance(float deltaTime, TCallback&& onExpired)
+    {
+        // The time not stepped through yet hasn't passed for the timers the callback schedules
+        float remainder = m_remainder + deltaTime;
+        m_remainder = 0.0f;
+        while (remainder >= m_resolution)
+        {
+            remainder -= m_resolution;
+            Step(onExpired);
+        }
+        m_remainder = remainder;
+    }
+
+    /**
+     * \brief Get the number of timers that haven't expired
+     */
+    size_t GetTimerCount() const { return m_timerCount; }
+
+private:
+    static constexpr uint32_t SlotBits = 6;
+    static constexpr uint32_t SlotCount = 1u << SlotBits;
+    static constexpr uint32_t SlotMask = SlotCount - 1;
+    static constexpr uint32_t LevelCount = 4;
+    static constexpr uint32_t None = ~0u;
+
+    struct Timer
+    {
+        uint64_t deadline = 0;
+        uint32_t payload = 0;
+        uint32_t generation = 0;
+        uint32_t previous = None;
+        uint32_t next = None;
+        // The slot the timer is linked into, None while it is free
+        uint32_t slot = None;
+    };
+
+    template <typename TCallback>
+    void Step(TCallback& onExpired)
+    {
+        m_now++;
+
+        // Whenever a level wraps around, the next slot of the level above is spread over the levels below
+        for (uint32_t level = 1; level < LevelCount; level++)
+        {
+            if (((m_now >> (SlotBits * (level - 1))) & SlotMask) != 0) break;
+            Cascade(level * SlotCount + static_cast<uint32_t>((m_now >> (SlotBits * level)) & SlotMask));
+        }
+
+        const uint32_t slot = static_cast<uint32_t>(m_now & SlotMask);
+        while (m_slots[slot] != None)
+        {
+            const uint32_t index = m_slots[slot];
+            const uint32_t payload = m_timers[index].payload;
+            Unlink(index);
+            Free(index);
+            onExpired(payload);
+        }
+    }
+
+    void Insert(uint32_t index);
+    void Cascade(uint32_t slot);
+    void Unlink(uint32_t index);
+    void Free(uint32_t index);
+
+    float m_resolution;
+    float m_remainder = 0.0f;
+    uint64_t m_now = 0;
+    size_t m_timerCount = 0;
+    std::vector<Timer> m_timers{};
+    std::vector<uint32_t> m_freeTimers{};
+    // The first timer of every slot of every level
+    std::vector<uint32_t> m_slots = std::vector<uint32_t>(LevelCount * SlotCount, None);
+};
+}
@@ -0,0 +1,169 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <optional>
+#include <type_traits>
+#include <vector>
+
+namespace fluczakAI
+{
+/**
+ * \brief A double ended queue of tasks owned by a single worker. The owner pushes and pops tasks at the bottom,
+ * so it works on the tasks it created most recently, while other workers steal the oldest tasks from the top.
+ * It's the lock-free deque of Chase and Lev: the tasks live in a ring buffer that the owner doubles when it's
+ * full, and only taking the last task, by the owner or a thief, needs a compare and swap. Old buffers are kept
+ * until the deque is destroyed, since a thief can still be reading from one.
+ * \tparam T - type of the tasks, trivially copyable so a thief can copy a task that is being overwritten and
+ * throw it away when its compare and swap fails
+ */
+template <typename T>
+class WorkStealingDeque
+{
+    static_assert(std::is_trivially_copyable_v<T>, "The tasks of a WorkStealingDeque are copied word by word");
+
+public:
+    /**
+     * \param capacity - number of tasks the deque holds before it grows, rounded up to a power of two
+     */
+    explicit WorkStealingDeque(size_t capacity = 64)
+    {
+        size_t size = 1;
+        while (size < capacity) size *= 2;
+        m_buffers.push_back(std::make_unique<Buffer>(size));
+        m_buffer.store(m_buffers.back().get(), std::memory_order_relaxed);
+    }
+
+    WorkStealingDeque(const WorkStealingDeque&) = delete;
+    WorkStealingDeque& operator=(const WorkStealingDeque&) = delete;
+
+    /**
+     * \brief Add a task at the bottom of the deque, only called by the owner
+     */
+    void Push(const T& task)
+    {
+        const int64_t bottom = m_bottom.load(std::memory_order_relaxed);
+        const int64_t top = m_top.load(std::memory_order_acquire);
+        Buffer* buffer = m_buffer.load(std::memory_order_relaxed);
+        if (bottom - top >= static_cast<int64_t>(buffer->capacity))
+        {
+            buffer = Grow(buffer, top, bottom);
+        }
+
+        buffer->Store(bottom, task);
+        // Publishes the task to the thieves that read the new bottom
+        m_bottom.store(bottom + 1, std::memory_order_release);
+    }
+
+    /**
+     * \brief Take the most recently pushed task, only called by the owner
+     * \return - the task or nullopt if the deque is empty
+     */
+    std::optional<T> Pop()
+    {
+        const int64_t bottom = m_bottom.load(std::memory_order_relaxed) - 1;
+        Buffer* buffer = m_buffer.load(std::memory_order_relaxed);
+        // Claims the task before looking at the top, thieves that haven't read the bottom yet won't take it
+        m_bottom.store(bottom, std::memory_order_seq_cst);
+        int64_t top = m_top.load(std::memory_order_seq_cst);
+
+        if (top > bottom)
+        {
+            m_bottom.store(bottom + 1, std::memory_order_relaxed);
+            return std::nullopt;
+        }
+
+        std::optional<T> task = buffer->Load(bottom);
+        if (top == bottom)
+        {
+            // The last task, the owner races the thieves for it
+            if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+            {
+                task.reset();
+            }
+            m_bottom.store(bottom + 1, std::memory_order_relaxed);
+        }
+        return task;
+    }
+
+    /**
+     * \brief Take the oldest task, called by the other workers
+     * \return - the task or nullopt if the deque is empty or another thread took the task first
+     */
+    std::optional<T> Steal()
+    {
+        int64_t top = m_top.load(std::memory_order_seq_cst);
+        const int64_t bottom = m_bottom.load(std::memory_order_seq_cst);
+        if (top >= bottom) return std::nullopt;
+
+        const T task = m_buffer.load(std::memory_order_acquire)->Load(top);
+        if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+        {
+            return std::nullopt;
+        }
+        return task;
+    }
+
+private:
+    struct Buffer
+    {
+        static constexpr size_t WordCount = (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+        // The words of a task are atomic, so a task that is overwritten while a thief copies it is a torn value
+        // the thief throws away and not a data race
+        struct Slot
+        {
+            std::atomic<uint64_t> words[WordCount];
+        };
+
+        explicit Buffer(size_t size) : capacity(size), mask(size - 1), slots(std::make_unique<Slot[]>(size)) {}
+
+        void Store(int64_t index, const T& task)
+        {
+            uint64_t words[WordCount] = {};
+            std::memcpy(words, &task, sizeof(T));
+            Slot& slot = slots[static_cast<size_t>(index) & mask];
+            for (size_t i = 0; i < WordCount; i++)
+            {
+                slot.words[i].store(words[i], std::memory_order_relaxed);
+            }
+        }
+
+        T Load(int64_t index) const
+        {
+            uint64_t words[WordCount];
+            const Slot& slot = slots[static_cast<size_t>(index) & mask];
+            for (size_t i = 0; i < WordCount; i++)
+            {
+                words[i] = slot.words[i].load(std::memory_order_relaxed);
+            }
+            T task;
+            std::memcpy(&task, words, sizeof(T));
+            return task;
+        }
+
+        size_t capacity;
+        size_t mask;
+        std::unique_ptr<Slot[]> slots;
+    };
+
+    Buffer* Grow(Buffer* buffer, int64_t top, int64_t bottom)
+    {
+        m_buffers.push_back(std::make_unique<Buffer>(buffer->capacity * 2));
+        Buffer* grown = m_buffers.back().get();
+        for (int64_t i = top; i < bottom; i++)
+        {
+            grown->Store(i, buffer->Load(i));
+        }
+        m_buffer.store(grown, std::memory_order_release);
+        return grown;
+    }
+
+    alignas(64) std::atomic<int64_t> m_top{0};
+    alignas(64) std::atomic<int64_t> m_bottom{0};
+    std::atomic<Buffer*> m_buffer{nullptr};
+    // Every buffer the deque has used, only touched by the owner
+    std::vector<std::unique_ptr<Buffer>> m_buffers{};
+};
+}
@@ -0,0 +1,237 @@
+#include "binary_checkpoint.hpp"
+
+#include <limits>
+#include <optional>
+
+#include "../BehaviorTrees/behaviors.hpp"
+#include "../FSM/finite_state_machine.hpp"
+
+void fluczakAI::CheckpointWriter::WriteBlackboard(const Blackboard& blackboard)
+{
+    const auto& codecs = BlackboardCodecRegistry::Instance();
+
+    // The number of values is patched in once the values have been written
+    const size_t countOffset = m_body.size();
+    Write(uint32_t{0});
+
+    uint32_t count = 0;
+    blackboard.ForEachLocalValue([this, &codecs, &count](const BlackboardKey& key, BlackboardTypeId typeId, const void* value)
+    {
+        const BlackboardValueCodec* codec = codecs.Find(typeId);
+        if (codec == nullptr) return;
+
+        Write(KeyIndex(key));
+        Write(StringIndex(codec->name));
+        codec->write(*this, value);
+        count++;
+    });
+
+    std::memcpy(m_body.data() + countOffset, &count, sizeof(count));
+}
+
+void fluczakAI::CheckpointWriter::WriteContext(const BehaviorTreeContext& context)
+{
+    Write(context.deltaTime);
+
+    static_assert(sizeof(Status) == 1);
+    Write(static_cast<uint32_t>(context.statuses.Size()));
+    WriteBytes(context.statuses.Data(), context.statuses.Size());
+    // Without the pending resets, the outdated statuses below a reset behavior would count again once restored
+    WriteBytes(context.statuses.PendingResets(), context.statuses.Size());
+
+    WriteBlackboard(*context.blackboard);
+}
+
+void fluczakAI::CheckpointWriter::WriteContext(const StateMachineContext& context)
+{
+    Write(context.deltaTime);
+
+    const auto currentState = context.GetCurrentState();
+    Write(static_cast<uint64_t>(currentState.has_value() ? *currentState + 1 : 0));
+
+    WriteBlackboard(*context.blackboard);
+}
+
+std::vector<unsigned char> fluczakAI::CheckpointWriter::Finish()
+{
+    size_t tableSize = 0;
+    for (const auto& string : m_strings) tableSize += sizeof(uint32_t) + string.size();
+
+    std::vector<unsigned char> checkpoint;
+    checkpoint.reserve(sizeof(uint32_t) * 3 + tableSize + m_body.size());
+
+    const auto append = [&checkpoint](const void* data, size_t size)
+    {
+        const auto* bytes = static_cast<const unsigned char*>(data);
+        checkpoint.insert(checkpoint.end(), bytes, bytes + size);
+    };
+
+    const uint32_t header[] = {Magic, FormatVersion, static_cast<uint32_t>(m_strings.size())};
+    append(header, sizeof(header));
+
+    for (const auto& string : m_strings)
+    {
+        const auto size = static_cast<uint32_t>(string.size());
+        append(&size, sizeof(size));
+        append(string.data(), string.size());
+    }
+
+    append(m_body.data(), m_body.size());
+
+    Clear();
+    return checkpoint;
+}
+
+void fluczakAI::CheckpointWriter::Clear()
+{
+    m_body.clear();
+    m_strings.clear();
+    m_stringIndices.clear();
+    m_keyIndices.clear();
+}
+
+uint32_t fluczakAI::CheckpointWriter::StringIndex(std::string_view string)
+{
+    const auto it = m_stringIndices.find(string);
+    if (it != m_stringIndices.end()) return it->second;
+
+    const auto index = static_cast<uint32_t>(m_strings.size());
+    m_stringIndices.emplace(std::string_view(m_strings.emplace_back(string)), index);
+    return index;
+}
+
+uint32_t fluczakAI::CheckpointWriter::KeyIndex(const BlackboardKey& key)
+{
+    constexpr uint32_t unassigned = std::numeric_limits<uint32_t>::max();
+
+    if (key.GetId() >= m_keyIndices.size())
+    {
+        m_keyIndices.resize(key.GetId() + 1, unassigned);
+    }
+
+    // Looking the name up in the key registry takes a lock, so it's only done once per key
+    uint32_t& index = m_keyIndices[key.GetId()];
+    if (index == unassigned) index = StringIndex(key.GetName());
+    return index;
+}
+
+fluczakAI::CheckpointReader::CheckpointReader(const unsigned char* data, size_t size) : m_data(data), m_size(size)
+{
+    m_valid = true;
+
+    uint32_t header[3];
+    if (!ReadBytes(header, sizeof(header)) || header[0] != CheckpointWriter::Magic || header[1] != CheckpointWriter::FormatVersion)
+    {
+        m_valid = false;
+        return;
+    }
+
+    // Every string takes at least its length, a larger count can't be right and mustn't be reserved
+    if (!CanRead(static_cast<size_t>(header[2]) * sizeof(uint32_t))) return;
+
+    m_strings.reserve(header[2]);
+    for (uint32_t i = 0; i < header[2] && m_valid; i++)
+    {
+        m_strings.push_back(ReadString());
+    }
+
+    m_keys.resize(m_strings.size());
+    m_codecs.resize(m_strings.size(), nullptr);
+}
+
+bool fluczakAI::CheckpointReader::ReadBlackboard(Blackboard& blackboard)
+{
+    blackboard.Clear();
+
+    const auto count = Read<uint32_t>();
+    for (uint32_t i = 0; i < count && m_valid; i++)
+    {
+        const auto keyIndex = Read<uint32_t>();
+        const auto typeIndex = Read<uint32_t>();
+        if (!IsStringIndex(keyIndex) || !IsStringIndex(typeIndex)) break;
+
+        if (m_codecs[typeIndex] == nullptr)
+        {
+            m_codecs[typeIndex] = BlackboardCodecRegistry::Instance().Find(m_strings[typeIndex]);
+        }
+
+        // Values don't store their size, so a value of an unknown type can't be skipped
+        if (m_codecs[typeIndex] == nullptr)
+        {
+            m_valid = false;
+            break;
+        }
+        m_codecs[typeIndex]->read(*this, blackboard, KeyAt(keyIndex));
+    }
+    return m_valid;
+}
+
+bool fluczakAI::CheckpointReader::ReadContext(BehaviorTreeContext& context)
+{
+    context.deltaTime = Read<float>();
+
+    // A status and a pending reset per behavior, checked before resizing so a corrupted count doesn't allocate
+    const auto count = Read<uint32_t>();
+    if (!CanRead(static_cast<size_t>(count) * 2)) return false;
+    context.statuses.Resize(count);
+    ReadBytes(context.statuses.Data(), count);
+    ReadBytes(context.statuses.PendingResets(), count);
+    // The running path isn't saved, the next Resume executes the tree from the root
+    context.runningPath.clear();
+    // Neither are coroutine frames, running coroutine actions start over
+    context.coroutines.Clear();
+
+    return ReadBlackboard(*context.blackboard);
+}
+
+bool fluczakAI::CheckpointReader::ReadContext(StateMachineContext& context)
+{
+    context.deltaTime = Read<float>();
+
+    const auto currentState = Read<uint64_t>();
+    context.currentState = currentState != 0 ? std::optional<size_t>(static_cast<size_t>(currentState - 1)) : std::nullopt;
+
+    return ReadBlackboard(*context.blackboard);
+}
+
+const fluczakAI::BlackboardKey& fluczakAI::CheckpointReader::KeyAt(uint32_t index)
+{
+    assert(index < m_keys.size());
+    if (!m_keys[index].IsValid())
+    {
+        m_keys[index] = BlackboardKey(m_strings[index]);
+    }
+    return m_keys[index];
+}
+
+fluczakAI::BlackboardCodecRegistry& fluczakAI::BlackboardCodecRegistry::Instance()
+{
+    static BlackboardCodecRegistry registry;
+    return registry;
+}
+
+fluczakAI::BlackboardCodecRegistry::BlackboardCodecRegistry()
+{
+    Register<bool>("bool");
+    Register<int>("int");
+    Register<float>("float");
+    Register<double>("double");
+    Register<uint32_t>("uint32");
+    Register<uint64_t>("uint64");
+    Register<std::string>("string");
+}
+
+void fluczakAI::BlackboardCodecRegistry::Register(std::string_view name, BlackboardTypeId typeId, BlackboardValueCodec::WriteFunction write, BlackboardValueCodec::ReadFunction read)
+{
+    m_codecs.push_back({std::string(name), typeId, write, read});
+    const BlackboardValueCodec& codec = m_codecs.back();
+
+    if (typeId >= m_codecsByType.size())
+    {
+        m_codecsByType.resize(typeId + 1, nullptr);
+    }
+
+    // Registering a type or a name again replaces its codec
+    m_codecsByType[typeId] = &codec;
+    m_codecsByName[codec.name] = &codec;
+}
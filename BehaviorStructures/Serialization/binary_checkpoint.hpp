@@ -0,0 +1,345 @@
+#pragma once
+
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <new>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+#include "../Blackboards/Blackboard.hpp"
+
+namespace fluczakAI
+{
+    struct BehaviorTreeContext;
+    struct StateMachineContext;
+    class CheckpointWriter;
+    class CheckpointReader;
+    struct BlackboardValueCodec;
+
+    /**
+     * \brief Writes the execution state of agents (contexts and their blackboards) into a compact binary
+     * checkpoint. Key names and value type names are stored once per checkpoint in a string table, the values
+     * themselves are written by the codecs of BlackboardCodecRegistry. A single writer is meant to be used for
+     * a whole population of agents:
+     *
+     *   CheckpointWriter writer;
+     *   for (auto& context : contexts) writer.WriteContext(context);
+     *   std::vector<unsigned char> checkpoint = writer.Finish();
+     *
+     * Values of types without a registered codec are skipped. Parent blackboards are not written, they are
+     * usually shared and can be checkpointed on their own with WriteBlackboard.
+     */
+    class CheckpointWriter
+    {
+    public:
+        static constexpr uint32_t Magic = 0x50434246; // "FBCP"
+        static constexpr uint32_t FormatVersion = 2;
+
+        /**
+         * \brief Write the values of a blackboard
+         * \param blackboard - the blackboard to write
+         */
+        void WriteBlackboard(const Blackboard& blackboard);
+
+        /**
+         * \brief Write the delta time, the statuses with their pending resets and the blackboard of a behavior tree context
+         */
+        void WriteContext(const BehaviorTreeContext& context);
+
+        /**
+         * \brief Write the delta time, the current state and the blackboard of a state machine context
+         */
+        void WriteContext(const StateMachineContext& context);
+
+        /**
+         * \brief Write the bytes of a trivially copyable value
+         */
+        template <typename T>
+        void Write(const T& value)
+        {
+            static_assert(std::is_trivially_copyable_v<T>);
+            WriteBytes(&value, sizeof(T));
+        }
+
+        void WriteBytes(const void* data, size_t size)
+        {
+            const size_t offset = m_body.size();
+            m_body.resize(offset + size);
+            std::memcpy(m_body.data() + offset, data, size);
+        }
+
+        /**
+         * \brief Write a string prefixed by its length
+         */
+        void WriteString(std::string_view string)
+        {
+            Write(static_cast<uint32_t>(string.size()));
+            WriteBytes(string.data(), string.size());
+        }
+
+        /**
+         * \brief Write a string as an index into the string table of the checkpoint. Strings repeated many times,
+         * like key names, only take four bytes per use.
+         */
+        void WriteTableString(std::string_view string) { Write(StringIndex(string)); }
+
+        /**
+         * \brief Get the finished checkpoint: the header, the string table and everything written so far.
+         * The writer is cleared and can be reused, keeping its memory.
+         */
+        std::vector<unsigned char> Finish();
+
+        /**
+         * \brief Discard everything written so far
+         */
+        void Clear();
+
+    private:
+        uint32_t StringIndex(std::string_view string);
+        uint32_t KeyIndex(const BlackboardKey& key);
+
+        std::vector<unsigned char> m_body{};
+        std::deque<std::string> m_strings{};
+        std::unordered_map<std::string_view, uint32_t> m_stringIndices{};
+        // The string table index of every key written so far, indexed by key id
+        std::vector<uint32_t> m_keyIndices{};
+    };
+
+    /**
+     * \brief Reads a checkpoint created by CheckpointWriter. Everything has to be read in the order it was
+     * written. Contexts are restored into existing objects, reusing the memory of their blackboards.
+     * Checkpoints usually come from disk or the network, so sizes and indices are checked in release builds too.
+     * The first read that doesn't fit the data makes the reader invalid, every read after it fails as well and
+     * returns zeroed values.
+     */
+    class CheckpointReader
+    {
+    public:
+        /**
+         * \brief Start reading a checkpoint. The data has to outlive the reader.
+         * \param data - the bytes returned by CheckpointWriter::Finish
+         * \param size - the number of bytes
+         */
+        CheckpointReader(const unsigned char* data, size_t size);
+
+        /**
+         * \brief Whether or not the header of the checkpoint is valid and everything read so far fit the data
+         */
+        bool IsValid() const { return m_valid; }
+
+        /**
+         * \brief Whether or not everything in the checkpoint has been read
+         */
+        bool IsAtEnd() const { return m_offset == m_size; }
+
+        /**
+         * \brief Clear a blackboard and read the values written by CheckpointWriter::WriteBlackboard into it
+         * \return - false if the checkpoint is invalid or has a value of a type without a codec, the blackboard
+         * then holds the values read before the failure
+         */
+        bool ReadBlackboard(Blackboard& blackboard);
+
+        /**
+         * \brief Restore a behavior tree context written by CheckpointWriter::WriteContext
+         * \return - false if the checkpoint is invalid, the context is then partially restored
+         */
+        bool ReadContext(BehaviorTreeContext& context);
+
+        /**
+         * \brief Restore a state machine context written by CheckpointWriter::WriteContext
+         * \return - false if the checkpoint is invalid, the context is then partially restored
+         */
+        bool ReadContext(StateMachineContext& context);
+
+        /**
+         * \brief Read a trivially copyable value
+         */
+        template <typename T>
+        T Read()
+        {
+            static_assert(std::is_trivially_copyable_v<T> && std::is_default_constructible_v<T>);
+            T value;
+            ReadBytes(&value, sizeof(T));
+            return value;
+        }
+
+        /**
+         * \brief Read bytes written by CheckpointWriter::WriteBytes
+         * \return - false if there aren't enough bytes left, the data is then zeroed
+         */
+        bool ReadBytes(void* data, size_t size)
+        {
+            if (!CanRead(size))
+            {
+                if (size != 0) std::memset(data, 0, size);
+                return false;
+            }
+            if (size != 0) std::memcpy(data, m_data + m_offset, size);
+            m_offset += size;
+            return true;
+        }
+
+        /**
+         * \brief Read a string written by CheckpointWriter::WriteString
+         * \return - a view into the checkpoint data, empty if the string doesn't fit the data
+         */
+        std::string_view ReadString()
+        {
+            const auto size = Read<uint32_t>();
+            if (!CanRead(size)) return {};
+            const std::string_view string(reinterpret_cast<const char*>(m_data + m_offset), size);
+            m_offset += size;
+            return string;
+        }
+
+        /**
+         * \brief Read a string written by CheckpointWriter::WriteTableString
+         * \return - the string, empty if its index is outside of the string table
+         */
+        std::string_view ReadTableString()
+        {
+            const auto index = Read<uint32_t>();
+            if (!IsStringIndex(index)) return {};
+            return m_strings[index];
+        }
+
+    private:
+        /**
+         * \brief Check that a number of bytes is left to read, the reader becomes invalid if it isn't
+         */
+        bool CanRead(size_t size)
+        {
+            if (m_valid && size <= m_size - m_offset) return true;
+            m_valid = false;
+            return false;
+        }
+
+        /**
+         * \brief Check that an index read from the data is in the string table, the reader becomes invalid if it isn't
+         */
+        bool IsStringIndex(uint32_t index)
+        {
+            if (m_valid && index < m_strings.size()) return true;
+            m_valid = false;
+            return false;
+        }
+
+        const BlackboardKey& KeyAt(uint32_t index);
+
+        const unsigned char* m_data = nullptr;
+        size_t m_size = 0;
+        size_t m_offset = 0;
+        bool m_valid = false;
+        std::vector<std::string_view> m_strings{};
+        // Keys and codecs of the string table, resolved the first time they are used
+        std::vector<BlackboardKey> m_keys{};
+        std::vector<const BlackboardValueCodec*> m_codecs{};
+    };
+
+    /**
+     * \brief The default way of saving a blackboard value of type T: its bytes are copied as they are.
+     * Specialize it for types that aren't trivially copyable or hold pointers, with the same two functions.
+     */
+    template <typename T>
+    struct BlackboardCodec
+    {
+        static_assert(std::is_trivially_copyable_v<T>, "Specialize BlackboardCodec for types that aren't trivially copyable");
+
+        static void Write(CheckpointWriter& writer, const T& value) { writer.WriteBytes(&value, sizeof(T)); }
+
+        static void Read(CheckpointReader& reader, Blackboard& blackboard, const BlackboardKey& key)
+        {
+            alignas(T) unsigned char storage[sizeof(T)];
+            if (!reader.ReadBytes(storage, sizeof(T))) return;
+            blackboard.SetData<T>(key, *std::launder(reinterpret_cast<T*>(storage)));
+        }
+    };
+
+    template <>
+    struct BlackboardCodec<std::string>
+    {
+        static void Write(CheckpointWriter& writer, const std::string& value) { writer.WriteString(value); }
+
+        static void Read(CheckpointReader& reader, Blackboard& blackboard, const BlackboardKey& key)
+        {
+            const std::string_view string = reader.ReadString();
+            if (!reader.IsValid()) return;
+            // Assigning the view reuses the buffer of a string that is already in the blackboard
+            blackboard.Emplace<std::string>(key, string);
+        }
+    };
+
+    /**
+     * \brief A type erased codec of a single blackboard value type
+     */
+    struct BlackboardValueCodec
+    {
+        using WriteFunction = void (*)(CheckpointWriter& writer, const void* value);
+        using ReadFunction = void (*)(CheckpointReader& reader, Blackboard& blackboard, const BlackboardKey& key);
+
+        std::string name;
+        BlackboardTypeId typeId;
+        WriteFunction write;
+        ReadFunction read;
+    };
+
+    /**
+     * \brief The codecs used to save blackboard values. A type is identified in a checkpoint by the name it was
+     * registered with, since blackboard type ids differ between runs of the program. bool, int, float, double,
+     * uint32_t, uint64_t and std::string are registered by default. Codecs have to be registered before any
+     * checkpoints are written or read.
+     */
+    class BlackboardCodecRegistry
+    {
+    public:
+        static BlackboardCodecRegistry& Instance();
+
+        /**
+         * \brief Register BlackboardCodec<T> as the codec of type T
+         * \param name - a name of the type that stays the same between runs of the program
+         */
+        template <typename T>
+        void Register(std::string_view name)
+        {
+            Register(name, GetBlackboardTypeId<T>(),
+                [](CheckpointWriter& writer, const void* value) { BlackboardCodec<T>::Write(writer, *static_cast<const T*>(value)); },
+                &BlackboardCodec<T>::Read);
+        }
+
+        /**
+         * \brief Register a codec made of two functions
+         */
+        void Register(std::string_view name, BlackboardTypeId typeId, BlackboardValueCodec::WriteFunction write, BlackboardValueCodec::ReadFunction read);
+
+        /**
+         * \brief Find the codec of a type
+         * \return - the codec or nullptr if the type doesn't have one
+         */
+        const BlackboardValueCodec* Find(BlackboardTypeId typeId) const
+        {
+            return typeId < m_codecsByType.size() ? m_codecsByType[typeId] : nullptr;
+        }
+
+        /**
+         * \brief Find the codec registered with a given name
+         * \return - the codec or nullptr if there's no codec with the name
+         */
+        const BlackboardValueCodec* Find(std::string_view name) const
+        {
+            const auto it = m_codecsByName.find(name);
+            return it != m_codecsByName.end() ? it->second : nullptr;
+        }
+
+    private:
+        BlackboardCodecRegistry();
+
+        std::deque<BlackboardValueCodec> m_codecs{};
+        std::vector<const BlackboardValueCodec*> m_codecsByType{};
+        std::unordered_map<std::string_view, const BlackboardValueCodec*> m_codecsByName{};
+    };
+}
@@ -0,0 +1,518 @@
+#include "code_generator.hpp"
+
+#if defined(NLOHMANN_JSON_VERSION_MAJOR)
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <iomanip>
+#include <sstream>
+#include <utility>
+
+namespace
+{
+    /**
+     * \brief Write a string as a C++ string literal
+     */
+    std::string Quote(const std::string& string)
+    {
+        std::ostringstream literal;
+        literal << '"';
+        for (const char c : string)
+        {
+            if (c == '"' || c == '\\') literal << '\\' << c;
+            else if (c == '\n') literal << "\\n";
+            else if (c == '\t') literal << "\\t";
+            else if (std::iscntrl(static_cast<unsigned char>(c))) literal << '\\' << std::oct << std::setw(3) << std::setfill('0') << static_cast<int>(static_cast<unsigned char>(c)) << std::dec;
+            else literal << c;
+        }
+        literal << '"';
+        return literal.str();
+    }
+
+    /**
+     * \brief Strip the whitespace and the class or struct keyword from a name written by Serialize
+     */
+    std::string NormalizeName(std::string name)
+    {
+        for (const char* keyword : {"class ", "struct "})
+        {
+            size_t i = 0;
+            while ((i = name.find(keyword)) != std::string::npos)
+            {
+                name.erase(i, std::string(keyword).size());
+            }
+        }
+        name.erase(std::remove_if(name.begin(), name.end(), [](unsigned char c) { return std::isspace(c); }), name.end());
+        return name;
+    }
+
+    /**
+     * \brief Whether a name can be used as a type in the generated source, e.g. Walk or game::Walk
+     */
+    bool IsTypeName(const std::string& name)
+    {
+        bool isStart = true;
+        for (size_t i = 0; i < name.size(); i++)
+        {
+            const auto c = static_cast<unsigned char>(name[i]);
+            if (c == ':' && !isStart && i + 1 < name.size() && name[i + 1] == ':')
+            {
+                isStart = true;
+                i++;
+                continue;
+            }
+            if (!(std::isalpha(c) || c == '_' || (!isStart && std::isdigit(c)))) return false;
+            isStart = false;
+        }
+        return !name.empty() && !isStart;
+    }
+
+    std::string Indent(int depth)
+    {
+        return std::string(static_cast<size_t>(depth) * 4, ' ');
+    }
+
+    /**
+     * \brief Write a floating point value so it reads back exactly
+     */
+    std::string FloatingLiteral(double value, bool isFloat)
+    {
+        const std::string type = isFloat ? "float" : "double";
+        if (std::isnan(value)) return "std::numeric_limits<" + type + ">::quiet_NaN()";
+        if (std::isinf(value)) return std::string(value < 0 ? "-" : "") + "std::numeric_limits<" + type + ">::infinity()";
+
+        std::ostringstream literal;
+        literal << std::setprecision(isFloat ? 9 : 17) << value;
+        std::string text = literal.str();
+        if (text.find_first_of(".e") == std::string::npos) text += ".0";
+        return isFloat ? text + "f" : text;
+    }
+}
+
+fluczakAI::CodeGenerator::CodeGenerator(std::string name, std::string nameSpace) : m_name(std::move(name)), m_nameSpace(std::move(nameSpace))
+{
+}
+
+std::string fluczakAI::CodeGenerator::Generate(const nlohmann::json& json)
+{
+    m_error.clear();
+    m_comparatorCount = 0;
+
+    if (!IsTypeName(m_name) || m_name.find("::") != std::string::npos)
+    {
+        Fail(m_name + " is not a valid name");
+        return {};
+    }
+
+    const std::string type = json.value("behavior-structure-type", "");
+    if (type == "BehaviorTree") return GenerateBehaviorTree(json);
+    if (type == "FSM") return GenerateStateMachine(json);
+
+    Fail("Unknown behavior-structure-type " + type);
+    return {};
+}
+
+std::string fluczakAI::CodeGenerator::GenerateBehaviorTree(const nlohmann::json& json)
+{
+    if (!json.contains("children") || json["children"].empty())
+    {
+        Fail("The tree has no root");
+        return {};
+    }
+
+    int nextId = 0;
+    std::string declarations;
+    std::string variables;
+    const std::string root = GenerateBehavior(json["children"][0], nextId, declarations, variables);
+    if (!m_error.empty()) return {};
+
+    std::ostringstream source;
+    source << "// Generated by fluczakAI::CodeGenerator, do not edit\n";
+    source << "#pragma once\n";
+    source << "#include <limits>\n";
+    source << "#include <string>\n";
+    source << "#include \"" << m_libraryPath << "BehaviorTrees/static_behavior_tree.hpp\"\n";
+    if (!variables.empty()) source << "#include \"" << m_libraryPath << "Serialization/editor_variables.hpp\"\n";
+    for (const auto& include : m_includes) source << "#include \"" << include << "\"\n";
+    source << "\n";
+
+    const std::string indent = m_nameSpace.empty() ? "" : Indent(1);
+    if (!m_nameSpace.empty()) source << "namespace " << m_nameSpace << "\n{\n";
+
+    source << declarations;
+    source << indent << "class " << m_name << " : public fluczakAI::StaticBehaviorTree<" << root << ">\n";
+    source << indent << "{\n";
+    if (!variables.empty())
+    {
+        source << indent << "public:\n";
+        source << indent << "    " << m_name << "()\n";
+        source << indent << "    {\n";
+        source << indent << "        ForEachAction([](fluczakAI::BehaviorTreeAction& action)\n";
+        source << indent << "        {\n";
+        source << indent << "            switch (action.GetId())\n";
+        source << indent << "            {\n";
+        source << variables;
+        source << indent << "            default:\n";
+        source << indent << "                break;\n";
+        source << indent << "            }\n";
+        source << indent << "        });\n";
+        source << indent << "    }\n";
+    }
+    source << indent << "};\n";
+
+    if (!m_nameSpace.empty()) source << "}\n";
+    return source.str();
+}
+
+std::string fluczakAI::CodeGenerator::GenerateBehavior(const nlohmann::json& json, int& nextId, std::string& declarations, std::string& variables)
+{
+    // Ids are handed out in preorder, the same way BehaviorTreeBuilder does when the json is deserialized
+    const int id = nextId++;
+
+    const std::string name = NormalizeName(json.value("name", ""));
+    const nlohmann::json children = json.value("children", nlohmann::json::array());
+    const std::string indent = Indent(m_nameSpace.empty() ? 0 : 1);
+
+    const auto generateChildren = [&]()
+    {
+        std::string list;
+        for (const auto& child : children)
+        {
+            list += ", " + GenerateBehavior(child, nextId, declarations, variables);
+        }
+        return list;
+    };
+
+    const auto generateChild = [&]() -> std::string
+    {
+        if (children.size() != 1)
+        {
+            Fail(name + " has to have exactly one child");
+            return {};
+        }
+        return GenerateBehavior(children[0], nextId, declarations, variables);
+    };
+
+    if (name == "Action")
+    {
+        const std::string type = NormalizeName(json.value("type", ""));
+        if (!IsTypeName(type))
+        {
+            Fail(type + " is not the name of an action class");
+            return {};
+        }
+
+        const nlohmann::json editorVariables = json.value("editor-variables", nlohmann::json());
+        if (editorVariables.is_array() && !editorVariables.empty())
+        {
+            variables += indent + "            case " + std::to_string(id) + ":\n";
+            variables += GenerateEditorVariables(editorVariables, "action", indent + "                ");
+            variables += indent + "                break;\n";
+        }
+        return type;
+    }
+
+    // Names are matched the way DeserializeBehavior matches them: composites and decorators by the exact name and
+    // comparisons and subtree references by a part of it, so the generated tree has the shape of the deserialized one
+    if (name == "Selector" && json.value("interrupting", false))
+    {
+        Fail("An interrupting Selector can't be generated, a static Selector doesn't check its children again");
+        return {};
+    }
+    if (name == "Sequence" || name == "Selector")
+    {
+        const std::string composite = name == "Sequence" ? "StaticSequence" : "StaticSelector";
+        const std::string list = generateChildren();
+        return "fluczakAI::" + composite + "<" + (list.empty() ? "" : list.substr(2)) + ">";
+    }
+    if (name == "Parallel")
+    {
+        const std::string thresholds = std::to_string(json.value("success-threshold", 0)) + ", " + std::to_string(json.value("failure-threshold", 1));
+        return "fluczakAI::StaticParallel<" + thresholds + generateChildren() + ">";
+    }
+    if (name == "Repeater")
+    {
+        if (!json.contains("num-repeats"))
+        {
+            Fail("A Repeater has no num-repeats");
+            return {};
+        }
+        const int numRepeats = json["num-repeats"].get<int>();
+        return "fluczakAI::StaticRepeater<" + std::to_string(numRepeats) + ", " + generateChild() + ">";
+    }
+    if (name == "Inverter") return "fluczakAI::StaticInverter<" + generateChild() + ">";
+    if (name == "AlwaysSucceed") return "fluczakAI::StaticAlwaysSucceed<" + generateChild() + ">";
+    if (name == "UntilFail") return "fluczakAI::StaticUntilFail<" + generateChild() + ">";
+    if (name.find("Comparison") != std::string::npos)
+    {
+        ComparatorSource comparator;
+        if (!ParseComparator(json.value("comparator", ""), true, comparator)) return {};
+
+        const std::string comparatorName = m_name + "Comparator" + std::to_string(m_comparatorCount++);
+        const std::string declarationIndent = Indent(m_nameSpace.empty() ? 0 : 1);
+        declarations += declarationIndent + "struct " + comparatorName + "\n";
+        declarations += declarationIndent + "{\n";
+        declarations += declarationIndent + "    static fluczakAI::Comparator<" + comparator.type + "> Create() { return fluczakAI::Comparator<" + comparator.type + ">(" + comparator.arguments + "); }\n";
+        declarations += declarationIndent + "};\n\n";
+
+        // The negation of a comparison isn't serialized, so like a deserialized tree the comparison isn't negated
+        return "fluczakAI::StaticComparison<" + comparatorName + ", " + generateChild() + ">";
+    }
+
+    if (name.find("SubtreeRef") != std::string::npos)
+    {
+        // A shared subtree lives in a BehaviorTreeCache at runtime, a static tree can't execute it
+        Fail("SubtreeRef " + json.value("subtree", "") + " has to be inlined before the tree is generated");
+        return {};
+    }
+
+    Fail("Unknown behavior " + name);
+    return {};
+}
+
+std::string fluczakAI::CodeGenerator::GenerateEditorVariables(const nlohmann::json& json, const std::string& target, const std::string& indent) const
+{
+    std::string source;
+    for (const auto& variable : json)
+    {
+        const std::string name = Quote(variable.value("name", ""));
+        const std::string value = Quote(variable.value("value", ""));
+
+        // Like the deserializer, variables the class doesn't register are skipped
+        source += indent + "if (const auto variable = " + target + ".editorVariables.find(" + name + "); variable != " + target + ".editorVariables.end()) ";
+        source += "variable->second->Deserialize(" + value + ");\n";
+    }
+    return source;
+}
+
+bool fluczakAI::CodeGenerator::ParseComparator(const std::string& serialized, bool isTreeComparator, ComparatorSource& comparator)
+{
+    std::istringstream stream(serialized);
+    std::string key;
+    std::string typeName;
+    int comparisonType = -1;
+    stream >> key >> typeName >> comparisonType;
+
+    if (isTreeComparator)
+    {
+        // DeserializeBehavior reads the key from the dumped json and keeps only its letters
+        key.erase(std::remove_if(key.begin(), key.end(), [](unsigned char c) { return !std::isalpha(c); }), key.end());
+    }
+
+    static const char* comparisonTypes[] = {"EQUAL", "NOT_EQUAL", "LESS", "LESS_EQUAL", "GREATER", "GREATER_EQUAL"};
+    if (key.empty() || comparisonType < 0 || comparisonType > 5)
+    {
+        Fail("Invalid comparator " + serialized);
+        return false;
+    }
+
+    // Types are written with typeid, so both the MSVC and the Itanium names are accepted
+    std::string value;
+    if (typeName == "float" || typeName == "f")
+    {
+        float number = 0.0f;
+        stream >> number;
+        comparator.type = "float";
+        value = FloatingLiteral(number, true);
+    }
+    else if (typeName == "double" || typeName == "d")
+    {
+        double number = 0.0;
+        stream >> number;
+        comparator.type = "double";
+        value = FloatingLiteral(number, false);
+    }
+    else if (typeName == "int" || typeName == "i")
+    {
+        int number = 0;
+        stream >> number;
+        comparator.type = "int";
+        value = std::to_string(number);
+    }
+    else if (typeName == "bool" || typeName == "b")
+    {
+        bool flag = false;
+        stream >> flag;
+        comparator.type = "bool";
+        value = flag ? "true" : "false";
+    }
+    else if (typeName.find("string") != std::string::npos)
+    {
+        std::string text;
+        stream >> text;
+        comparator.type = "std::string";
+        value = "std::string(" + Quote(text) + ")";
+    }
+    else
+    {
+        Fail("Unsupported comparator type " + typeName);
+        return false;
+    }
+
+    comparator.arguments = "std::string(" + Quote(key) + "), fluczakAI::ComparisonType::" + comparisonTypes[comparisonType] + ", " + value;
+    return true;
+}
+
+std::string fluczakAI::CodeGenerator::GenerateStateMachine(const nlohmann::json& json)
+{
+    const std::string indent = m_nameSpace.empty() ? "" : Indent(1);
+    std::string members;
+    std::string constructor;
+    std::string bindings;
+
+    const nlohmann::json states = json.value("states", nlohmann::json::array());
+    size_t defaultState = 0;
+    for (size_t i = 0; i < states.size(); i++)
+    {
+        const std::string type = NormalizeName(states[i].value("name", ""));
+        if (!IsTypeName(type))
+        {
+            Fail(type + " is not the name of a state class");
+            return {};
+        }
+
+        // Like AddState, the last state marked as default is the default one
+        if (states[i].value("default", false)) defaultState = i;
+
+        const std::string member = "m_state" + std::to_string(i);
+        members += indent + "    " + type + " " + member + "{};\n";
+
+        const nlohmann::json editorVariables = states[i].value("editor-variables", nlohmann::json());
+        if (editorVariables.is_array() && !editorVariables.empty())
+        {
+            constructor += GenerateEditorVariables(editorVariables, member, indent + "        ");
+        }
+    }
+
+    // The transitions of a state in the order they are checked, the comparators of a repeated transition are merged
+    // into the first one like AddTransition does
+    std::vector<std::vector<std::pair<size_t, std::vector<std::string>>>> transitions(states.size());
+    for (const auto& transitionData : json.value("transition-data", nlohmann::json::array()))
+    {
+        const size_t from = transitionData.at("from").get<size_t>();
+        for (const auto& transition : transitionData.value("transitions", nlohmann::json::array()))
+        {
+            const size_t to = transition.at("to").get<size_t>();
+            if (from >= states.size() || to >= states.size())
+            {
+                Fail("A transition refers to a state that doesn't exist");
+                return {};
+            }
+
+            auto existing = std::find_if(transitions[from].begin(), transitions[from].end(), [to](const auto& pair) { return pair.first == to; });
+            if (existing == transitions[from].end())
+            {
+                transitions[from].emplace_back(to, std::vector<std::string>{});
+                existing = transitions[from].end() - 1;
+            }
+
+            for (const auto& serialized : transition.value("comparators", nlohmann::json::array()))
+            {
+                ComparatorSource comparator;
+                if (!ParseComparator(serialized.get<std::string>(), false, comparator)) return {};
+
+                const std::string member = "m_comparator" + std::to_string(m_comparatorCount++);
+                members += indent + "    fluczakAI::Comparator<" + comparator.type + "> " + member + "{" + comparator.arguments + "};\n";
+                bindings += indent + "        " + member + ".BindLayout(layout);\n";
+                existing->second.push_back(member);
+            }
+        }
+    }
+
+    // Mirrors FiniteStateMachine::Execute: every transition of the state the tick started in is checked in order,
+    // each one taken ends that state and initializes its target, and that state is updated last
+    std::string cases;
+    for (size_t i = 0; i < states.size(); i++)
+    {
+        const std::string state = "m_state" + std::to_string(i);
+        cases += indent + "        case " + std::to_string(i) + ":\n";
+        for (const auto& [to, comparators] : transitions[i])
+        {
+            std::string condition;
+            for (const auto& comparator : comparators)
+            {
+                condition += (condition.empty() ? "" : " && ") + comparator + ".Evaluate(*context.blackboard)";
+            }
+
+            const std::string blockIndent = indent + "            ";
+            cases += condition.empty() ? blockIndent + "{\n" : blockIndent + "if (" + condition + ")\n" + blockIndent + "{\n";
+            cases += blockIndent + "    " + state + ".End(context);\n";
+            cases += blockIndent + "    currentState = " + std::to_string(to) + ";\n";
+            cases += blockIndent + "    m_state" + std::to_string(to) + ".Initialize(context);\n";
+            cases += blockIndent + "}\n";
+        }
+        cases += indent + "            " + state + ".Update(context);\n";
+        cases += indent + "            break;\n";
+    }
+
+    std::ostringstream source;
+    source << "// Generated by fluczakAI::CodeGenerator, do not edit\n";
+    source << "#pragma once\n";
+    source << "#include <cstddef>\n";
+    source << "#include <limits>\n";
+    source << "#include <optional>\n";
+    source << "#include <string>\n";
+    source << "#include \"" << m_libraryPath << "FSM/static_state_machine.hpp\"\n";
+    if (!constructor.empty()) source << "#include \"" << m_libraryPath << "Serialization/editor_variables.hpp\"\n";
+    for (const auto& include : m_includes) source << "#include \"" << include << "\"\n";
+    source << "\n";
+
+    if (!m_nameSpace.empty()) source << "namespace " << m_nameSpace << "\n{\n";
+    source << indent << "class " << m_name << " : public fluczakAI::StaticStateMachine\n";
+    source << indent << "{\n";
+    source << indent << "public:\n";
+    source << indent << "    static constexpr size_t StateCount = " << states.size() << ";\n";
+    if (!constructor.empty())
+    {
+        source << "\n";
+        source << indent << "    " << m_name << "()\n";
+        source << indent << "    {\n";
+        source << constructor;
+        source << indent << "    }\n";
+    }
+    source << "\n";
+    if (states.empty())
+    {
+        source << indent << "    void Execute(fluczakAI::StateMachineContext&) {}\n";
+    }
+    else
+    {
+        source << indent << "    void Execute(fluczakAI::StateMachineContext& context)\n";
+        source << indent << "    {\n";
+        source << indent << "        std::optional<size_t>& currentState = CurrentState(context);\n";
+        source << indent << "        if (!currentState.has_value())\n";
+        source << indent << "        {\n";
+        source << indent << "            currentState = " << defaultState << ";\n";
+        source << indent << "            m_state" << defaultState << ".Initialize(context);\n";
+        source << indent << "        }\n";
+        source << "\n";
+        source << indent << "        switch (currentState.value())\n";
+        source << indent << "        {\n";
+        source << cases;
+        source << indent << "        default:\n";
+        source << indent << "            break;\n";
+        source << indent << "        }\n";
+        source << indent << "    }\n";
+    }
+    source << "\n";
+    source << indent << "    void BindLayout(const fluczakAI::BlackboardLayout& layout)\n";
+    source << indent << "    {\n";
+    source << bindings;
+    source << indent << "    }\n";
+    if (!members.empty())
+    {
+        source << "\n";
+        source << indent << "private:\n";
+        source << members;
+    }
+    source << indent << "};\n";
+    if (!m_nameSpace.empty()) source << "}\n";
+    return source.str();
+}
+
+void fluczakAI::CodeGenerator::Fail(const std::string& error)
+{
+    // The first error is kept, the ones after it are usually caused by it
+    if (m_error.empty()) m_error = error;
+}
+#endif
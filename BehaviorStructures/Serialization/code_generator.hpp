@@ -0,0 +1,74 @@
+#pragma once
+#include <string>
+#include <vector>
+#include "json/single_include/nlohmann/json.hpp"
+
+#if defined(NLOHMANN_JSON_VERSION_MAJOR)
+namespace fluczakAI
+{
+/**
+ * \brief Turns behavior trees and state machines serialized with BehaviorTree::Serialize and
+ * FiniteStateMachine::Serialize into C++ source, so shipping builds don't parse json or look actions up in the
+ * GenericFactory.
+ * A behavior tree becomes a StaticBehaviorTree subclass, whose traversal is inlined by the compiler. Its
+ * comparators are created from the keys and constants of the json, and its editor variables are set in the
+ * constructor. A state machine becomes a StaticStateMachine subclass holding its states and comparators as
+ * members, whose Execute switches on the current state and checks its transitions inline.
+ * Action and state names are the names they are registered in the GenericFactory with, which have to be the
+ * C++ names of their classes. The headers declaring them are added with AddInclude.
+ */
+class CodeGenerator
+{
+public:
+    /**
+     * \param name - the name of the generated tree class or state machine function
+     * \param nameSpace - the namespace the code is generated in, none if empty
+     */
+    explicit CodeGenerator(std::string name, std::string nameSpace = {});
+
+    /**
+     * \brief Include a header in the generated source, e.g. the one declaring the actions
+     * \param header - the path as written in the include directive
+     */
+    void AddInclude(std::string header) { m_includes.push_back(std::move(header)); }
+
+    /**
+     * \brief Set the path the headers of the library are included with, e.g. "BehaviorStructures/"
+     */
+    void SetLibraryPath(std::string path) { m_libraryPath = std::move(path); }
+
+    /**
+     * \brief Generate a header from a serialized behavior tree or state machine
+     * \param json - the output of BehaviorTree::Serialize or FiniteStateMachine::Serialize
+     * \return - the source of the header, empty if the json can't be generated, see GetError
+     */
+    std::string Generate(const nlohmann::json& json);
+
+    /**
+     * \brief Get the reason the last Generate failed, empty if it succeeded
+     */
+    const std::string& GetError() const { return m_error; }
+
+private:
+    struct ComparatorSource
+    {
+        std::string type;
+        std::string arguments;
+    };
+
+    std::string GenerateBehaviorTree(const nlohmann::json& json);
+    std::string GenerateStateMachine(const nlohmann::json& json);
+    std::string GenerateBehavior(const nlohmann::json& json, int& nextId, std::string& declarations, std::string& variables);
+    std::string GenerateEditorVariables(const nlohmann::json& json, const std::string& target, const std::string& indent) const;
+    bool ParseComparator(const std::string& serialized, bool isTreeComparator, ComparatorSource& comparator);
+    void Fail(const std::string& error);
+
+    std::string m_name;
+    std::string m_nameSpace;
+    std::string m_libraryPath{};
+    std::vector<std::string> m_includes{};
+    std::string m_error{};
+    int m_comparatorCount = 0;
+};
+}
+#endif
@@ -111,7 +111,7 @@ public:
             return ss.str();
         }
 
-        if constexpr (StructTests<T>::toString)
+        if constexpr (StructTests<T>::iterators)
         {
             std::stringstream ss;
             for (auto element : val)
@@ -176,7 +176,7 @@ public:
 		    // Extract the content inside curly braces
 		    std::string content = element.substr(1, element.size() - 1);
 
-		    using ElementType = typename std::remove_const<std::remove_reference<decltype(*std::begin(std::declval<T>()))>::type>::type;
+		    using ElementType = typename std::remove_const<typename std::remove_reference<decltype(*std::begin(std::declval<T>()))>::type>::type;
 		    ElementType d;
 		    SerializedField<ElementType> temp(d);
 		    temp.Deserialize(content);
@@ -3,6 +3,10 @@
 #include <functional>
 #include <memory>
 #include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 namespace fluczakAI
 {
@@ -21,6 +25,15 @@ public:
     std::function<std::unique_ptr<T>(Args...)> function;
 };
 
+/**
+ * \brief Whether a product type has a static OnCreated(T&), called with every product right after it is created
+ */
+template <typename T, typename = void>
+struct HasOnCreated : std::false_type {};
+
+template <typename T>
+struct HasOnCreated<T, std::void_t<decltype(T::OnCreated(std::declval<T&>()))>> : std::true_type {};
+
 template<typename T>
 class GenericFactory
 {
@@ -44,7 +57,21 @@ public:
     template <typename newType,typename... Args>
     void RegisterProduct(const std::string& name)
     {
-        creators[name] = std::make_unique<CreatorFunction<newType, Args...>>([](Args... args){ return std::make_unique<newType>(args...); });
+        creators[name] = std::make_unique<CreatorFunction<newType, Args...>>([](Args... args)
+        {
+            auto product = std::make_unique<newType>(args...);
+            // Lets the product finish setting up with its own type, e.g. BehaviorTreeAction::OnCreated
+            if constexpr (HasOnCreated<newType>::value)
+            {
+                newType::OnCreated(*product);
+            }
+            return product;
+        });
+    }
+
+    bool HasProduct(const std::string& name) const
+    {
+        return creators.find(name) != creators.end();
     }
 
     template<typename... Args>
@@ -0,0 +1,138 @@
+// Tests of AgentScheduler: the scheduled ticks have to match executing the agents one by one, also when the
+// behaviors start parallel work on the same pool.
+
+#include <vector>
+#include "test_utilities.hpp"
+#include "BehaviorTrees/behavior_tree_builder.hpp"
+#include "Scheduling/agent_scheduler.hpp"
+
+namespace
+{
+    /**
+     * \brief Counts its ticks in the blackboard and derives its status from the count
+     */
+    class CountingAction : public fluczakAI::BehaviorTreeAction
+    {
+    public:
+        fluczakAI::Status Tick(fluczakAI::BehaviorTreeContext& context) override
+        {
+            const int ticks = context.blackboard->GetData<int>("ticks") + 1;
+            context.blackboard->SetData("ticks", ticks);
+            return static_cast<fluczakAI::Status>((ticks * 7 + m_id) % 3 + 1);
+        }
+    };
+
+    /**
+     * \brief Only reads the context, so it can run in a threaded Parallel. Its cost differs between the agents, so
+     * workers run out of chunks and steal children of Parallels while their owners wait for them.
+     */
+    class SlowAction : public fluczakAI::BehaviorTreeAction
+    {
+    public:
+        fluczakAI::Status Tick(fluczakAI::BehaviorTreeContext& context) override
+        {
+            volatile int sum = 0;
+            const int cost = context.blackboard->GetData<int>("cost");
+            for (int i = 0; i < cost; i++) sum = sum + i;
+            return context.blackboard->GetData<int>("ticks") % 2 == 0 ? fluczakAI::Status::SUCCESS : fluczakAI::Status::RUNNING;
+        }
+    };
+
+    bool HaveSameStatuses(const fluczakAI::BehaviorTreeContext& a, const fluczakAI::BehaviorTreeContext& b, size_t nodeCount)
+    {
+        for (size_t i = 0; i < nodeCount; i++)
+        {
+            if (a.statuses.Get(i) != b.statuses.Get(i)) return false;
+        }
+        return true;
+    }
+
+    void TestTicksMatchSerialExecution()
+    {
+        fluczakAI::BehaviorTreeBuilder builder;
+        builder.Selector();
+        builder.Sequence();
+        builder.Action<CountingAction>().Back();
+        builder.Action<CountingAction>().Back();
+        builder.Back();
+        builder.Action<CountingAction>().Back();
+        const auto tree = builder.End();
+        const fluczakAI::FlatBehaviorTree flat(*tree);
+
+        constexpr size_t count = 5000;
+        std::vector<fluczakAI::BehaviorTreeContext> expected(count);
+        std::vector<fluczakAI::BehaviorTreeContext> ticked(count);
+        std::vector<fluczakAI::BehaviorTreeContext> flatTicked(count);
+        std::vector<fluczakAI::BehaviorTreeContext> batched(count);
+        for (auto* contexts : {&expected, &ticked, &flatTicked, &batched})
+        {
+            for (auto& context : *contexts) context.blackboard->SetData("ticks", 0);
+        }
+
+        fluczakAI::ThreadPool pool(4);
+        fluczakAI::AgentScheduler scheduler(pool, 64);
+        for (int tick = 0; tick < 10; tick++)
+        {
+            for (auto& context : expected) tree->Execute(context);
+            scheduler.Tick(*tree, ticked.data(), count);
+            scheduler.Tick(flat, flatTicked.data(), count);
+            scheduler.TickBatched(flat, batched.data(), count);
+        }
+
+        for (size_t i = 0; i < count; i++)
+        {
+            CHECK(HaveSameStatuses(expected[i], ticked[i], tree->GetNodeCount()));
+            CHECK(HaveSameStatuses(expected[i], flatTicked[i], tree->GetNodeCount()));
+            CHECK(HaveSameStatuses(expected[i], batched[i], tree->GetNodeCount()));
+        }
+    }
+
+    void TestBatchedTickWithThreadedParallel()
+    {
+        // The Parallel is a leaf of the flat tree, its wait for its children runs other chunks of the batched
+        // tick on the same worker while that worker's chunk is still being executed
+        fluczakAI::BehaviorTreeBuilder builder;
+        builder.Sequence();
+        builder.Parallel(2, 1);
+        builder.Action<SlowAction>().Back();
+        builder.Action<SlowAction>().Back();
+        builder.Back();
+        builder.Action<CountingAction>().Back();
+        const auto tree = builder.End();
+        const fluczakAI::FlatBehaviorTree flat(*tree);
+
+        fluczakAI::ThreadPool pool(4);
+        constexpr size_t count = 2000;
+        std::vector<fluczakAI::BehaviorTreeContext> expected(count);
+        std::vector<fluczakAI::BehaviorTreeContext> batched(count);
+        for (size_t i = 0; i < count; i++)
+        {
+            for (auto* context : {&expected[i], &batched[i]})
+            {
+                context->blackboard->SetData("ticks", static_cast<int>(i % 2));
+                context->blackboard->SetData("cost", i % 37 == 0 ? 100000 : 500);
+            }
+            batched[i].threadPool = &pool;
+        }
+
+        fluczakAI::AgentScheduler scheduler(pool, 4);
+        for (int tick = 0; tick < 20; tick++)
+        {
+            for (auto& context : expected) tree->Execute(context);
+            scheduler.TickBatched(flat, batched.data(), count);
+        }
+
+        for (size_t i = 0; i < count; i++)
+        {
+            CHECK(HaveSameStatuses(expected[i], batched[i], tree->GetNodeCount()));
+            CHECK(expected[i].blackboard->GetData<int>("ticks") == batched[i].blackboard->GetData<int>("ticks"));
+        }
+    }
+}
+
+int main()
+{
+    TestTicksMatchSerialExecution();
+    TestBatchedTickWithThreadedParallel();
+    return TestFailures() == 0 ? 0 : 1;
+}
@@ -0,0 +1,149 @@
+// Tests that an action overriding Reset is reset as soon as a higher priority branch preempts it, in the runtime,
+// flat and static trees, even though composites reset their children lazily.
+
+#include <cstdio>
+#include "BehaviorTrees/behavior_tree.hpp"
+#include "BehaviorTrees/behavior_tree_builder.hpp"
+#include "BehaviorTrees/flat_behavior_tree.hpp"
+#include "BehaviorTrees/static_behavior_tree.hpp"
+#include "Serialization/generic_factory.hpp"
+#include "test_utilities.hpp"
+
+namespace
+{
+    const fluczakAI::BlackboardKey preemptKey("preempt");
+    // Ids in preorder: selector, comparison, its action, sequence, the preempted action
+    constexpr int trackedId = 4;
+
+    int resets = 0;
+
+    class SucceedingAction : public fluczakAI::BehaviorTreeAction
+    {
+    public:
+        fluczakAI::Status Tick(fluczakAI::BehaviorTreeContext& context) override { return fluczakAI::Status::SUCCESS; }
+    };
+
+    /**
+     * \brief Runs until it is aborted, counting its resets
+     */
+    class TrackedAction : public fluczakAI::BehaviorTreeAction
+    {
+    public:
+        fluczakAI::Status Tick(fluczakAI::BehaviorTreeContext& context) override { return fluczakAI::Status::RUNNING; }
+
+        void Reset(fluczakAI::BehaviorTreeContext& context) override
+        {
+            resets++;
+            BehaviorTreeAction::Reset(context);
+        }
+    };
+
+    struct IsPreempted
+    {
+        static fluczakAI::Comparator<int> Create() { return {preemptKey, fluczakAI::ComparisonType::EQUAL, 1}; }
+    };
+
+    using StaticTree = fluczakAI::StaticBehaviorTree<fluczakAI::StaticSelector<
+        fluczakAI::StaticComparison<IsPreempted, SucceedingAction>,
+        fluczakAI::StaticSequence<TrackedAction>>>;
+
+    /**
+     * \brief The same tree as StaticTree, Resume only checks the comparison again when the selector is interrupting
+     */
+    std::unique_ptr<fluczakAI::BehaviorTree> BuildTree(bool isInterrupting = false)
+    {
+        fluczakAI::BehaviorTreeBuilder builder;
+        builder.Selector(isInterrupting);
+        builder.Comparison(IsPreempted::Create());
+        builder.Action<SucceedingAction>().Back();
+        builder.Back();
+        builder.Sequence();
+        builder.Action<TrackedAction>().Back();
+        builder.Back();
+        return builder.End();
+    }
+
+    /**
+     * \brief Run the tracked action, then preempt it with the comparison branch
+     */
+    template <typename TExecute>
+    void CheckPreemption(const char* name, fluczakAI::BehaviorTreeContext& context, TExecute&& execute)
+    {
+        resets = 0;
+        context.blackboard->SetData(preemptKey, 0);
+        CHECK(execute() == fluczakAI::Status::RUNNING);
+        CHECK(context.statuses.Get(trackedId) == fluczakAI::Status::RUNNING);
+
+        context.blackboard->SetData(preemptKey, 1);
+        CHECK(execute() == fluczakAI::Status::SUCCESS);
+        if (resets == 0 || context.statuses.Get(trackedId) != fluczakAI::Status::INVALID)
+        {
+            std::printf("%s: the preempted action wasn't reset\n", name);
+        }
+        CHECK(resets > 0);
+        CHECK(context.statuses.Get(trackedId) == fluczakAI::Status::INVALID);
+    }
+
+    void TestRuntimeTree()
+    {
+        const auto tree = BuildTree();
+        fluczakAI::BehaviorTreeContext context;
+        tree->InitializeContext(context);
+        CheckPreemption("BehaviorTree", context, [&]()
+        {
+            tree->Execute(context);
+            return context.statuses.Get(0);
+        });
+    }
+
+    void TestFlatTree()
+    {
+        const auto tree = BuildTree();
+        const fluczakAI::FlatBehaviorTree flat(*tree);
+        fluczakAI::BehaviorTreeContext context;
+        tree->InitializeContext(context);
+        CheckPreemption("FlatBehaviorTree::Execute", context, [&]() { return flat.Execute(context); });
+
+        const auto interruptingTree = BuildTree(true);
+        const fluczakAI::FlatBehaviorTree interrupting(*interruptingTree);
+        interruptingTree->InitializeContext(context);
+        CheckPreemption("FlatBehaviorTree::Resume", context, [&]() { return interrupting.Resume(context); });
+    }
+
+    void TestStaticTree()
+    {
+        StaticTree tree;
+        fluczakAI::BehaviorTreeContext context;
+        tree.InitializeContext(context);
+        CheckPreemption("StaticBehaviorTree", context, [&]() { return tree.Execute(context); });
+    }
+
+    void TestEagerResetDetection()
+    {
+        CHECK(fluczakAI::OverridesReset<TrackedAction>);
+        CHECK(!fluczakAI::OverridesReset<SucceedingAction>);
+
+        // Actions created by name for deserialized trees are detected as well
+        auto& factory = fluczakAI::GenericFactory<fluczakAI::BehaviorTreeAction>::Instance();
+        factory.RegisterProduct<TrackedAction>("TrackedAction");
+        factory.RegisterProduct<SucceedingAction>("SucceedingAction");
+        CHECK(factory.CreateProduct("TrackedAction")->HasEagerReset());
+        CHECK(!factory.CreateProduct("SucceedingAction")->HasEagerReset());
+
+        // Actions without a Reset of their own keep the reset of the composites above them lazy
+        fluczakAI::BehaviorTreeBuilder builder;
+        builder.Sequence();
+        builder.Action<SucceedingAction>().Back();
+        const auto lazyTree = builder.End();
+        CHECK(!lazyTree->GetRoot()->HasEagerReset());
+    }
+}
+
+int main()
+{
+    TestRuntimeTree();
+    TestFlatTree();
+    TestStaticTree();
+    TestEagerResetDetection();
+    return TestFailures() == 0 ? 0 : 1;
+}
@@ -0,0 +1,364 @@
+// Tests of BehaviorTreeCache: validating tree json, adding and loading prototypes, replacing one while an agent
+// still executes it, instancing agents, and agents sharing a prototype without sharing their progress. Also a tree
+// referencing one shared subtree twice, built and deserialized from json, and the report of missing subtrees.
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include "test_utilities.hpp"
+#include "BehaviorTrees/behavior_tree_builder.hpp"
+#include "BehaviorTrees/behavior_tree_cache.hpp"
+#include "Serialization/editor_variables.hpp"
+#include "Serialization/generic_factory.hpp"
+
+namespace
+{
+    const fluczakAI::BlackboardKey countKey("count");
+    const fluczakAI::BlackboardKey doneKey("done");
+
+    /**
+     * \brief Counts its ticks in the blackboard, succeeds on the ticks the count reaches a multiple of its target
+     */
+    class CountAction : public fluczakAI::BehaviorTreeAction
+    {
+    public:
+        fluczakAI::Status Tick(fluczakAI::BehaviorTreeContext& context) override
+        {
+            const int count = context.blackboard->GetData<int>(countKey) + 1;
+            context.blackboard->SetData(countKey, count);
+            return count % target == 0 ? fluczakAI::Status::SUCCESS : fluczakAI::Status::RUNNING;
+        }
+
+        int target = 1;
+        fluczakAI::SerializedField<int> targetField{*this, "target", target};
+    };
+
+    /**
+     * \brief Marks the agent as done
+     */
+    class DoneAction : public fluczakAI::BehaviorTreeAction
+    {
+    public:
+        fluczakAI::Status Tick(fluczakAI::BehaviorTreeContext& context) override
+        {
+            context.blackboard->SetData(doneKey, true);
+            return fluczakAI::Status::SUCCESS;
+        }
+    };
+
+    nlohmann::json Action(const std::string& type, int target = 0)
+    {
+        nlohmann::json action = {{"name", "Action"}, {"type", type}, {"editor-variables", nullptr}, {"children", nlohmann::json::array()}};
+        if (target != 0) action["editor-variables"].push_back({{"name", "target"}, {"value", std::to_string(target)}});
+        return action;
+    }
+
+    nlohmann::json Tree(const nlohmann::json& root)
+    {
+        return {{"version", "1.0"}, {"behavior-structure-type", "BehaviorTree"}, {"children", nlohmann::json::array({root})}};
+    }
+
+    /**
+     * \brief A sequence that counts to a target and then marks the agent as done
+     */
+    nlohmann::json CountTree(int target)
+    {
+        return Tree({{"name", "Sequence"}, {"children", {Action("Count", target), Action("Done")}}});
+    }
+
+    void Reset(fluczakAI::BehaviorTreeContext& context)
+    {
+        context.blackboard->SetData(countKey, 0);
+        context.blackboard->SetData(doneKey, false);
+    }
+
+    void TestValidate()
+    {
+        std::string error = "untouched";
+        CHECK(fluczakAI::BehaviorTreeCache::Validate(CountTree(3), error));
+        CHECK(error == "untouched");
+
+        const auto failsWith = [](const nlohmann::json& json, const std::string& expected, const fluczakAI::BehaviorTreeCache* library = nullptr)
+        {
+            std::string error;
+            const bool isValid = fluczakAI::BehaviorTreeCache::Validate(json, error, library);
+            if (error != expected) std::printf("expected \"%s\", got \"%s\"\n", expected.c_str(), error.c_str());
+            return !isValid && error == expected;
+        };
+
+        CHECK(failsWith(nlohmann::json::array(), "not a behavior tree"));
+        nlohmann::json stateMachine = CountTree(3);
+        stateMachine["behavior-structure-type"] = "StateMachine";
+        CHECK(failsWith(stateMachine, "not a behavior tree"));
+        nlohmann::json noVersion = CountTree(3);
+        noVersion.erase("version");
+        CHECK(failsWith(noVersion, "the tree has no version"));
+        nlohmann::json twoRoots = CountTree(3);
+        twoRoots["children"].push_back(Action("Done"));
+        CHECK(failsWith(twoRoots, "the tree needs exactly one root"));
+
+        CHECK(failsWith(Tree(Action("Missing")), "action Missing is not registered"));
+        CHECK(failsWith(Tree({{"name", "Dance"}, {"children", nlohmann::json::array()}}), "unknown behavior Dance"));
+        CHECK(failsWith(Tree({{"name", "Inverter"}, {"children", nlohmann::json::array()}}), "Inverter needs exactly one child"));
+        CHECK(failsWith(Tree({{"name", "Repeater"}, {"children", {Action("Done")}}}), "a repeater has no number of repeats"));
+        nlohmann::json parent = Action("Done");
+        parent["children"].push_back(Action("Done"));
+        CHECK(failsWith(Tree(parent), "Action can't have children"));
+        CHECK(failsWith(Tree({{"name", "Comparison"}, {"comparator", "count vector 2 2 "}, {"children", {Action("Done")}}}),
+                        "comparator \"count vector 2 2 \" can't be read"));
+
+        // The first problem is reported, however deep it is
+        CHECK(failsWith(Tree({{"name", "Selector"}, {"children", {Action("Done"), {{"name", "Sequence"}, {"children", {Action("Other")}}}}}}),
+                        "action Other is not registered"));
+
+        // Subtrees are only looked up when there is a library to look them up in
+        const nlohmann::json reference = Tree({{"name", "SubtreeRef"}, {"subtree", "count"}, {"children", nlohmann::json::array()}});
+        fluczakAI::BehaviorTreeCache cache;
+        CHECK(fluczakAI::BehaviorTreeCache::Validate(reference, error));
+        CHECK(failsWith(reference, "subtree count is not in the cache", &cache));
+        cache.Add("count", CountTree(1));
+        CHECK(fluczakAI::BehaviorTreeCache::Validate(reference, error, &cache));
+    }
+
+    void TestAdd()
+    {
+        fluczakAI::BehaviorTreeCache cache;
+        CHECK(cache.Size() == 0);
+        CHECK(cache.Find("count") == nullptr);
+
+        const auto fromJson = cache.Add("count", CountTree(2));
+        CHECK(fromJson != nullptr);
+        CHECK(cache.Find("count") == fromJson);
+        CHECK(fromJson->GetNodeCount() == 3);
+
+        fluczakAI::BehaviorTreeBuilder builder;
+        builder.Sequence();
+        builder.Action<DoneAction>().Back();
+        const auto fromTree = cache.Add("built", builder.End());
+        CHECK(cache.Find("built") == fromTree);
+        CHECK(cache.Size() == 2);
+
+        // An invalid tree is reported and leaves the prototype of its name alone
+        nlohmann::json broken = CountTree(5);
+        broken.erase("version");
+        CHECK(cache.Add("count", broken) == nullptr);
+        CHECK(cache.GetError() == "count: the tree has no version");
+        CHECK(cache.Find("count") == fromJson);
+
+        // A tree added from json finds its subtrees in the cache
+        const auto referencing = cache.Add("twice", Tree({{"name", "Sequence"}, {"children", {
+            {{"name", "SubtreeRef"}, {"subtree", "count"}, {"children", nlohmann::json::array()}},
+            {{"name", "SubtreeRef"}, {"subtree", "built"}, {"children", nlohmann::json::array()}}}}}));
+        CHECK(referencing != nullptr);
+        fluczakAI::BehaviorTreeContext context;
+        Reset(context);
+        cache.Instantiate("twice", context);
+        referencing->Execute(context);
+        CHECK(context.statuses.Get(0) == fluczakAI::Status::RUNNING);
+        referencing->Execute(context);
+        CHECK(context.statuses.Get(0) == fluczakAI::Status::SUCCESS);
+        CHECK(context.blackboard->GetData<int>(countKey) == 2);
+        CHECK(context.blackboard->GetData<bool>(doneKey));
+
+        CHECK(cache.Remove("built"));
+        CHECK(!cache.Remove("built"));
+        CHECK(cache.Find("built") == nullptr);
+        CHECK(cache.Size() == 2);
+        cache.Clear();
+        CHECK(cache.Size() == 0);
+        CHECK(cache.Find("count") == nullptr);
+    }
+
+    void TestLoad()
+    {
+        const std::filesystem::path directory = std::filesystem::temp_directory_path();
+        const std::string path = (directory / "behavior_tree_cache_test.json").string();
+        const std::string garbagePath = (directory / "behavior_tree_cache_test_garbage.json").string();
+        const std::string invalidPath = (directory / "behavior_tree_cache_test_invalid.json").string();
+        std::ofstream(path) << CountTree(2).dump(4);
+        std::ofstream(garbagePath) << "{ \"version\": ";
+        std::ofstream(invalidPath) << Tree(Action("Missing")).dump();
+
+        // The file is read once, later loads get the same prototype
+        fluczakAI::BehaviorTreeCache cache;
+        const auto loaded = cache.Load(path);
+        CHECK(loaded != nullptr);
+        CHECK(cache.Find(path) == loaded);
+        std::filesystem::remove(path);
+        CHECK(cache.Load(path) == loaded);
+
+        fluczakAI::BehaviorTreeContext context;
+        Reset(context);
+        cache.Instantiate(path, context);
+        loaded->Execute(context);
+        loaded->Execute(context);
+        CHECK(context.statuses.Get(0) == fluczakAI::Status::SUCCESS);
+
+        const std::string missingPath = (directory / "behavior_tree_cache_test_missing.json").string();
+        CHECK(cache.Load(missingPath) == nullptr);
+        CHECK(cache.GetError() == missingPath + ": can't be read");
+        CHECK(cache.Load(garbagePath) == nullptr);
+        CHECK(cache.GetError() == garbagePath + ": can't be read");
+        CHECK(cache.Load(invalidPath) == nullptr);
+        CHECK(cache.GetError() == invalidPath + ": action Missing is not registered");
+        CHECK(cache.Size() == 1);
+
+        std::filesystem::remove(garbagePath);
+        std::filesystem::remove(invalidPath);
+    }
+
+    void TestReplace()
+    {
+        fluczakAI::BehaviorTreeCache cache;
+        const auto old = cache.Add("count", CountTree(3));
+        fluczakAI::BehaviorTreeContext oldAgent;
+        Reset(oldAgent);
+        cache.Instantiate("count", oldAgent);
+        old->Execute(oldAgent);
+
+        // The agent that holds the old prototype keeps executing it, new agents get the new one
+        const auto replacement = cache.Add("count", CountTree(1));
+        CHECK(replacement != old);
+        CHECK(cache.Find("count") == replacement);
+        CHECK(cache.Size() == 1);
+        cache.Remove("count");
+
+        old->Execute(oldAgent);
+        CHECK(oldAgent.statuses.Get(0) == fluczakAI::Status::RUNNING);
+        old->Execute(oldAgent);
+        CHECK(oldAgent.statuses.Get(0) == fluczakAI::Status::SUCCESS);
+        CHECK(oldAgent.blackboard->GetData<int>(countKey) == 3);
+
+        fluczakAI::BehaviorTreeContext newAgent;
+        Reset(newAgent);
+        replacement->InitializeContext(newAgent);
+        replacement->Execute(newAgent);
+        CHECK(newAgent.statuses.Get(0) == fluczakAI::Status::SUCCESS);
+        CHECK(newAgent.blackboard->GetData<int>(countKey) == 1);
+    }
+
+    void TestInstantiate()
+    {
+        fluczakAI::BehaviorTreeCache cache;
+        cache.Add("count", CountTree(1));
+
+        fluczakAI::BehaviorTreeContext context;
+        CHECK(cache.Instantiate("missing", context) == nullptr);
+        CHECK(context.statuses.Size() == 0);
+
+        // A context left over from another agent starts from scratch
+        context.statuses.Resize(1);
+        context.statuses[0] = fluczakAI::Status::FAILURE;
+        const auto tree = cache.Instantiate("count", context);
+        CHECK(tree == cache.Find("count"));
+        CHECK(context.statuses.Size() == tree->GetNodeCount());
+        for (int id = 0; id < static_cast<int>(tree->GetNodeCount()); id++) CHECK(context.statuses.Get(id) == fluczakAI::Status::INVALID);
+    }
+
+    void TestAgentsShareAPrototype()
+    {
+        fluczakAI::BehaviorTreeCache cache;
+        cache.Add("count", CountTree(3));
+
+        fluczakAI::BehaviorTreeContext first;
+        fluczakAI::BehaviorTreeContext second;
+        Reset(first);
+        Reset(second);
+        const auto tree = cache.Instantiate("count", first);
+        CHECK(cache.Instantiate("count", second) == tree);
+
+        // Interleaved, each agent counts its own ticks and finishes on its own third tick
+        tree->Execute(first);
+        tree->Execute(first);
+        tree->Execute(second);
+        CHECK(first.statuses.Get(0) == fluczakAI::Status::RUNNING);
+        CHECK(second.statuses.Get(0) == fluczakAI::Status::RUNNING);
+        tree->Execute(first);
+        CHECK(first.statuses.Get(0) == fluczakAI::Status::SUCCESS);
+        CHECK(first.blackboard->GetData<bool>(doneKey));
+        CHECK(second.statuses.Get(1) == fluczakAI::Status::RUNNING);
+        CHECK(second.statuses.Get(2) == fluczakAI::Status::INVALID);
+        CHECK(!second.blackboard->GetData<bool>(doneKey));
+
+        tree->Execute(second);
+        CHECK(second.statuses.Get(0) == fluczakAI::Status::RUNNING);
+        tree->Execute(second);
+        CHECK(second.statuses.Get(0) == fluczakAI::Status::SUCCESS);
+        CHECK(second.blackboard->GetData<int>(countKey) == 3);
+        CHECK(second.blackboard->GetData<bool>(doneKey));
+        CHECK(first.blackboard->GetData<int>(countKey) == 3);
+    }
+
+    void TestSubtreeReferencedTwice()
+    {
+        fluczakAI::BehaviorTreeCache cache;
+        const auto counting = cache.Add("count", Tree({{"name", "Sequence"}, {"children", {Action("Count", 3)}}}));
+
+        fluczakAI::BehaviorTreeBuilder builder;
+        builder.Parallel(2, 1);
+        builder.Subtree("count", counting).Back();
+        builder.Subtree("count", counting).Back();
+        const auto built = builder.End();
+
+        nlohmann::json json = built->Serialize();
+        std::unique_ptr<fluczakAI::Behavior> root;
+        fluczakAI::BehaviorTree deserialized(root);
+        deserialized.Deserialize(json, cache);
+        CHECK(deserialized.GetError().empty());
+        CHECK(deserialized.GetNodeCount() == 7);
+        CHECK(deserialized.Serialize() == json);
+
+        for (const fluczakAI::BehaviorTree* tree : {built.get(), &deserialized})
+        {
+            // The parallel is 0, the references 1 and 4, the sequences of the shared tree 2 and 5, its actions 3 and 6.
+            // Both references count on one blackboard, so the first one reaches 3 while the second one is at 4.
+            fluczakAI::BehaviorTreeContext context;
+            Reset(context);
+            tree->InitializeContext(context);
+            tree->Execute(context);
+            CHECK(context.statuses.Get(1) == fluczakAI::Status::RUNNING);
+            CHECK(context.statuses.Get(4) == fluczakAI::Status::RUNNING);
+            tree->Execute(context);
+            CHECK(context.statuses.Get(0) == fluczakAI::Status::RUNNING);
+            CHECK(context.statuses.Get(1) == fluczakAI::Status::SUCCESS);
+            CHECK(context.statuses.Get(4) == fluczakAI::Status::RUNNING);
+            CHECK(context.statuses.Get(6) == fluczakAI::Status::RUNNING);
+
+            // The finished reference isn't executed again, the running one goes on with its own statuses
+            tree->Execute(context);
+            CHECK(context.blackboard->GetData<int>(countKey) == 5);
+            CHECK(context.statuses.Get(0) == fluczakAI::Status::RUNNING);
+            CHECK(context.statuses.Get(1) == fluczakAI::Status::SUCCESS);
+            tree->Execute(context);
+            CHECK(context.blackboard->GetData<int>(countKey) == 6);
+            CHECK(context.statuses.Get(0) == fluczakAI::Status::SUCCESS);
+        }
+
+        // Without a cache the references become placeholders, which is reported
+        fluczakAI::BehaviorTree bare(root);
+        bare.Deserialize(json);
+        CHECK(bare.GetError() == "subtree count is not in the cache");
+        nlohmann::json unregistered = Tree({{"name", "Sequence"}, {"children", {Action("Done"), Action("Missing"), Action("Other")}}});
+        bare.Deserialize(unregistered);
+        CHECK(bare.GetError() == "action Missing is not registered");
+        nlohmann::json valid = CountTree(1);
+        bare.Deserialize(valid);
+        CHECK(bare.GetError().empty());
+    }
+}
+
+int main()
+{
+    fluczakAI::GenericFactory<fluczakAI::BehaviorTreeAction>::Instance().RegisterProduct<CountAction>("Count");
+    fluczakAI::GenericFactory<fluczakAI::BehaviorTreeAction>::Instance().RegisterProduct<DoneAction>("Done");
+
+    TestValidate();
+    TestAdd();
+    TestLoad();
+    TestReplace();
+    TestInstantiate();
+    TestAgentsShareAPrototype();
+    TestSubtreeReferencedTwice();
+    return TestFailures() == 0 ? 0 : 1;
+}
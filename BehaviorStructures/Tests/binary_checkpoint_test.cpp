@@ -0,0 +1,133 @@
+// Tests of CheckpointWriter and CheckpointReader: contexts have to survive a round trip, and truncated or corrupted
+// checkpoints have to make the reader fail instead of reading past the data, also in release builds.
+
+#include <cstring>
+#include <string>
+#include <vector>
+#include "test_utilities.hpp"
+#include "BehaviorTrees/behaviors.hpp"
+#include "FSM/finite_state_machine.hpp"
+#include "Serialization/binary_checkpoint.hpp"
+
+namespace
+{
+    const fluczakAI::BlackboardKey healthKey("health");
+    const fluczakAI::BlackboardKey nameKey("name");
+
+    std::vector<unsigned char> WriteCheckpoint()
+    {
+        fluczakAI::BehaviorTreeContext treeContext;
+        treeContext.deltaTime = 0.5f;
+        treeContext.statuses[0] = fluczakAI::Status::RUNNING;
+        treeContext.statuses[3] = fluczakAI::Status::FAILURE;
+        treeContext.blackboard->SetData(healthKey, 42);
+        treeContext.blackboard->SetData(nameKey, std::string("agent"));
+
+        fluczakAI::StateMachineContext stateMachineContext;
+        stateMachineContext.deltaTime = 0.25f;
+        stateMachineContext.blackboard->SetData(healthKey, 7);
+
+        fluczakAI::CheckpointWriter writer;
+        writer.WriteContext(treeContext);
+        writer.WriteContext(stateMachineContext);
+        return writer.Finish();
+    }
+
+    void TestRoundTrip()
+    {
+        const std::vector<unsigned char> checkpoint = WriteCheckpoint();
+        fluczakAI::CheckpointReader reader(checkpoint.data(), checkpoint.size());
+        CHECK(reader.IsValid());
+
+        fluczakAI::BehaviorTreeContext treeContext;
+        fluczakAI::StateMachineContext stateMachineContext;
+        CHECK(reader.ReadContext(treeContext));
+        CHECK(reader.ReadContext(stateMachineContext));
+        CHECK(reader.IsAtEnd());
+
+        CHECK(treeContext.deltaTime == 0.5f);
+        CHECK(treeContext.statuses.Size() == 4);
+        CHECK(treeContext.statuses.Get(0) == fluczakAI::Status::RUNNING);
+        CHECK(treeContext.statuses.Get(3) == fluczakAI::Status::FAILURE);
+        CHECK(treeContext.blackboard->GetData<int>(healthKey) == 42);
+        CHECK(treeContext.blackboard->GetData<std::string>(nameKey) == "agent");
+        CHECK(stateMachineContext.deltaTime == 0.25f);
+        CHECK(!stateMachineContext.GetCurrentState().has_value());
+        CHECK(stateMachineContext.blackboard->GetData<int>(healthKey) == 7);
+    }
+
+    void TestTruncatedCheckpoints()
+    {
+        const std::vector<unsigned char> checkpoint = WriteCheckpoint();
+
+        // Every prefix copied into a buffer of its own size, so reading past it is caught by sanitizers
+        size_t failures = 0;
+        for (size_t size = 0; size < checkpoint.size(); size++)
+        {
+            const std::vector<unsigned char> truncated(checkpoint.begin(), checkpoint.begin() + size);
+            fluczakAI::CheckpointReader reader(truncated.data(), truncated.size());
+
+            fluczakAI::BehaviorTreeContext treeContext;
+            fluczakAI::StateMachineContext stateMachineContext;
+            const bool readTree = reader.ReadContext(treeContext);
+            const bool readStateMachine = reader.ReadContext(stateMachineContext);
+            failures += !readTree || !readStateMachine ? 1 : 0;
+            CHECK(!reader.IsValid());
+        }
+        CHECK(failures == checkpoint.size());
+    }
+
+    void TestCorruptedCheckpoints()
+    {
+        // A string table that claims more strings than there are bytes
+        const uint32_t header[] = {fluczakAI::CheckpointWriter::Magic, fluczakAI::CheckpointWriter::FormatVersion, 0xFFFFFFFF};
+        unsigned char headerBytes[sizeof(header)];
+        std::memcpy(headerBytes, header, sizeof(header));
+        CHECK(!fluczakAI::CheckpointReader(headerBytes, sizeof(headerBytes)).IsValid());
+
+        fluczakAI::CheckpointWriter writer;
+        fluczakAI::Blackboard blackboard;
+
+        // A key index outside of the string table
+        writer.Write(uint32_t{1});
+        writer.Write(uint32_t{99});
+        writer.Write(uint32_t{0});
+        std::vector<unsigned char> checkpoint = writer.Finish();
+        fluczakAI::CheckpointReader badIndex(checkpoint.data(), checkpoint.size());
+        CHECK(badIndex.IsValid());
+        CHECK(!badIndex.ReadBlackboard(blackboard));
+        CHECK(!badIndex.IsValid());
+
+        // A type without a codec, its value can't be skipped
+        writer.Write(uint32_t{2});
+        writer.WriteTableString("health");
+        writer.WriteTableString("int");
+        writer.Write(5);
+        writer.WriteTableString("name");
+        writer.WriteTableString("no such type");
+        writer.Write(6);
+        checkpoint = writer.Finish();
+        fluczakAI::CheckpointReader unknownType(checkpoint.data(), checkpoint.size());
+        CHECK(!unknownType.ReadBlackboard(blackboard));
+        CHECK(blackboard.GetData<int>(healthKey) == 5);
+        CHECK(!blackboard.HasKey<int>(nameKey));
+
+        // A string longer than the checkpoint, every read after the failure fails too
+        writer.Write(uint32_t{1000});
+        writer.Write(1.0f);
+        checkpoint = writer.Finish();
+        fluczakAI::CheckpointReader longString(checkpoint.data(), checkpoint.size());
+        CHECK(longString.ReadString().empty());
+        CHECK(!longString.IsValid());
+        CHECK(longString.Read<float>() == 0.0f);
+        CHECK(longString.ReadTableString().empty());
+    }
+}
+
+int main()
+{
+    TestRoundTrip();
+    TestTruncatedCheckpoints();
+    TestCorruptedCheckpoints();
+    return TestFailures() == 0 ? 0 : 1;
+}
@@ -0,0 +1,97 @@
+// Tests that writing to keys that are already set doesn't allocate: the global operator new is replaced by one
+// that counts its calls, and steady-state Emplace and SetData calls have to leave the count unchanged.
+
+#include <cstdlib>
+#include <new>
+#include <string>
+#include "Blackboards/Blackboard.hpp"
+#include "test_utilities.hpp"
+
+namespace
+{
+    size_t allocations = 0;
+
+    void* CountedAllocate(size_t size)
+    {
+        allocations++;
+        if (void* memory = std::malloc(size == 0 ? 1 : size)) return memory;
+        throw std::bad_alloc();
+    }
+
+    struct Transform
+    {
+        float position[3];
+        float rotation[4];
+    };
+
+    // Stored in the arena of the blackboard instead of inline, and keeps its heap buffer when assigned to
+    struct Path
+    {
+        std::string name;
+        double points[32];
+    };
+
+    void Changed(void* userData, const fluczakAI::BlackboardKey& key)
+    {
+        (*static_cast<int*>(userData))++;
+    }
+}
+
+void* operator new(size_t size) { return CountedAllocate(size); }
+void* operator new[](size_t size) { return CountedAllocate(size); }
+void operator delete(void* memory) noexcept { std::free(memory); }
+void operator delete[](void* memory) noexcept { std::free(memory); }
+void operator delete(void* memory, size_t) noexcept { std::free(memory); }
+void operator delete[](void* memory, size_t) noexcept { std::free(memory); }
+
+namespace
+{
+    void TestSteadyStateWrites()
+    {
+        const fluczakAI::BlackboardKey healthKey("health");
+        const fluczakAI::BlackboardKey transformKey("transform");
+        const fluczakAI::BlackboardKey nameKey("name");
+        const fluczakAI::BlackboardKey pathKey("path");
+        const fluczakAI::BlackboardKey watchedKey("watched");
+
+        fluczakAI::Blackboard blackboard;
+        int notifications = 0;
+        blackboard.Subscribe(watchedKey, &Changed, &notifications);
+
+        // The first writes insert the keys, the strings reserve a buffer the later writes fit in
+        blackboard.SetData(healthKey, 100);
+        blackboard.SetData(transformKey, Transform{});
+        blackboard.SetData(nameKey, std::string(64, 'a'));
+        blackboard.Emplace<Path>(pathKey, Path{std::string(64, 'b'), {}});
+        blackboard.SetData(watchedKey, 0.0f);
+        blackboard.SetData("literal", true);
+        const std::string name(48, 'c');
+        const Path path{std::string(48, 'd'), {}};
+
+        const size_t before = allocations;
+        for (int i = 0; i < 1000; i++)
+        {
+            blackboard.SetData(healthKey, i);
+            blackboard.Emplace<int>(healthKey, i + 1);
+            blackboard.SetData(transformKey, Transform{{1.0f, 2.0f, 3.0f}, {0.0f, 0.0f, 0.0f, 1.0f}});
+            blackboard.SetData(nameKey, name);
+            blackboard.Emplace<std::string>(nameKey, "short name");
+            blackboard.SetData(pathKey, path);
+            blackboard.SetData(watchedKey, static_cast<float>(i));
+            // Interning a key that exists doesn't allocate either
+            blackboard.SetData("literal", i % 2 == 0);
+            blackboard.GetData<int>(healthKey)++;
+        }
+        CHECK(allocations == before);
+        CHECK(notifications == 1001);
+        CHECK(blackboard.GetData<int>(healthKey) == 1001);
+        CHECK(blackboard.GetData<std::string>(nameKey) == "short name");
+        CHECK(blackboard.GetData<Path>(pathKey).name == path.name);
+    }
+}
+
+int main()
+{
+    TestSteadyStateWrites();
+    return TestFailures() == 0 ? 0 : 1;
+}
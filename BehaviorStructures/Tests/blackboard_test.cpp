@@ -0,0 +1,164 @@
+// Tests of layered blackboards: mutable values of blackboards with and without a parent, and subscriptions that
+// have to leave the parent when the blackboard holding them is replaced or destroyed. Also tests interning keys
+// on many threads at once, and values aligned to more than the heap aligns to.
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "Blackboards/Blackboard.hpp"
+#include "test_utilities.hpp"
+
+namespace
+{
+    const fluczakAI::BlackboardKey healthKey("health");
+
+    void Changed(void* userData, const fluczakAI::BlackboardKey& key)
+    {
+        (*static_cast<int*>(userData))++;
+    }
+
+    struct alignas(32) Wide
+    {
+        float lanes[8];
+    };
+
+    bool IsAligned(const void* pointer, size_t alignment)
+    {
+        return reinterpret_cast<uintptr_t>(pointer) % alignment == 0;
+    }
+
+    void TestGetMutableData()
+    {
+        // Without a parent the value has to be local
+        fluczakAI::Blackboard orphan;
+        orphan.SetData(healthKey, 10);
+        orphan.GetMutableData<int>(healthKey) += 5;
+        CHECK(orphan.GetData<int>(healthKey) == 15);
+
+        // A value of the parent is copied, the parent keeps its own
+        auto parent = std::make_shared<fluczakAI::Blackboard>();
+        parent->SetData(healthKey, 100);
+        fluczakAI::Blackboard child;
+        child.SetParent(parent);
+        child.GetMutableData<int>(healthKey) -= 1;
+        CHECK(child.GetData<int>(healthKey) == 99);
+        CHECK(parent->GetData<int>(healthKey) == 100);
+    }
+
+    void TestMoveAssignmentUnsubscribes()
+    {
+        auto oldParent = std::make_shared<fluczakAI::Blackboard>();
+        auto newParent = std::make_shared<fluczakAI::Blackboard>();
+        int oldNotifications = 0;
+        int newNotifications = 0;
+
+        fluczakAI::Blackboard blackboard;
+        blackboard.SetParent(oldParent);
+        blackboard.Subscribe(healthKey, &Changed, &oldNotifications);
+
+        fluczakAI::Blackboard replacement;
+        replacement.SetParent(newParent);
+        replacement.Subscribe(healthKey, &Changed, &newNotifications);
+
+        oldParent->SetData(healthKey, 1);
+        CHECK(oldNotifications == 1);
+
+        // The subscription of the replaced blackboard mustn't be called by its old parent anymore
+        blackboard = std::move(replacement);
+        oldParent->SetData(healthKey, 2);
+        CHECK(oldNotifications == 1);
+
+        // The moved subscription still follows the new parent, and only once
+        newParent->SetData(healthKey, 3);
+        CHECK(newNotifications == 1);
+        blackboard.SetData(healthKey, 4);
+        CHECK(newNotifications == 2);
+    }
+
+    void TestDestructionUnsubscribes()
+    {
+        auto parent = std::make_shared<fluczakAI::Blackboard>();
+        int notifications = 0;
+        {
+            fluczakAI::Blackboard child;
+            child.SetParent(parent);
+            child.Subscribe(healthKey, &Changed, &notifications);
+            parent->SetData(healthKey, 1);
+        }
+        parent->SetData(healthKey, 2);
+        CHECK(notifications == 1);
+    }
+
+    void TestConcurrentKeys()
+    {
+        // Enough names to fill a few chunks of the registry while the other threads read them
+        constexpr int threadCount = 4;
+        constexpr int nameCount = 1000;
+        std::vector<std::vector<uint32_t>> ids(threadCount, std::vector<uint32_t>(nameCount));
+        std::vector<int> wrongNames(threadCount, 0);
+        std::vector<std::thread> threads;
+        for (int thread = 0; thread < threadCount; thread++)
+        {
+            threads.emplace_back([thread, &ids, &wrongNames]()
+            {
+                for (int i = 0; i < nameCount; i++)
+                {
+                    // Every thread goes through the names in a different order
+                    const int steps[] = {1, 3, 7, 9};
+                    const int name = i * steps[thread] % nameCount;
+                    const std::string text = "concurrent" + std::to_string(name);
+                    const fluczakAI::BlackboardKey key(text);
+                    ids[thread][name] = key.GetId();
+                    if (key.GetName() != text) wrongNames[thread]++;
+                }
+            });
+        }
+        for (auto& thread : threads) thread.join();
+
+        for (int thread = 0; thread < threadCount; thread++)
+        {
+            CHECK(wrongNames[thread] == 0);
+            CHECK(ids[thread] == ids[0]);
+        }
+        CHECK(fluczakAI::BlackboardKey("concurrent999").GetId() == ids[0][999]);
+        CHECK(fluczakAI::BlackboardKeyRegistry::Instance().GetName(fluczakAI::BlackboardKeyRegistry::InvalidId).empty());
+    }
+
+    void TestOverAlignedValues()
+    {
+        // Odd sized allocations in between, and enough of them to fill a few blocks
+        fluczakAI::BlackboardArena arena;
+        bool isAligned = true;
+        for (int i = 0; i < 200; i++)
+        {
+            arena.Allocate(1 + i % 7, 1);
+            isAligned = isAligned && IsAligned(arena.Create<Wide>(), alignof(Wide));
+            isAligned = isAligned && IsAligned(arena.Allocate(16, 64), 64);
+        }
+        CHECK(isAligned);
+
+        fluczakAI::Blackboard blackboard;
+        for (int i = 0; i < 20; i++)
+        {
+            const fluczakAI::BlackboardKey key("wide" + std::to_string(i));
+            blackboard.SetData(key, static_cast<char>(i));
+            blackboard.SetData(fluczakAI::BlackboardKey("wideValue" + std::to_string(i)), Wide{{static_cast<float>(i)}});
+            const Wide& value = blackboard.GetData<Wide>(fluczakAI::BlackboardKey("wideValue" + std::to_string(i)));
+            CHECK(IsAligned(&value, alignof(Wide)));
+            CHECK(value.lanes[0] == static_cast<float>(i));
+        }
+    }
+}
+
+int main()
+{
+    TestGetMutableData();
+    TestMoveAssignmentUnsubscribes();
+    TestDestructionUnsubscribes();
+    TestConcurrentKeys();
+    TestOverAlignedValues();
+    return TestFailures() == 0 ? 0 : 1;
+}
@@ -0,0 +1,206 @@
+// Tests of BudgetedScheduler: the round robin order of a bucket, also when agents are removed in the middle of a
+// round, the deltaTime of agents that wait for their turn or sleep, and the frames that go over the budget.
+
+#include <chrono>
+#include <vector>
+#include "test_utilities.hpp"
+#include "BehaviorTrees/behavior_tree_builder.hpp"
+#include "Scheduling/budgeted_scheduler.hpp"
+
+namespace
+{
+    const fluczakAI::BlackboardKey indexKey("index");
+    const fluczakAI::BlackboardKey ticksKey("ticks");
+    const fluczakAI::BlackboardKey sleepKey("sleep");
+    const fluczakAI::BlackboardKey spinKey("spin");
+
+    struct Tick
+    {
+        int agent;
+        float deltaTime;
+    };
+
+    std::vector<Tick> ticks;
+
+    /**
+     * \brief Records its ticks, sleeps on its first tick if asked to and spins for a while if asked to
+     */
+    class RecordingAction : public fluczakAI::BehaviorTreeAction
+    {
+    public:
+        fluczakAI::Status Tick(fluczakAI::BehaviorTreeContext& context) override
+        {
+            ticks.push_back({context.blackboard->GetData<int>(indexKey), context.deltaTime});
+
+            const int count = context.blackboard->GetData<int>(ticksKey) + 1;
+            context.blackboard->SetData(ticksKey, count);
+            if (count == 1 && context.blackboard->GetData<float>(sleepKey) > 0.0f)
+            {
+                context.Sleep(context.blackboard->GetData<float>(sleepKey));
+            }
+
+            const auto end = std::chrono::steady_clock::now() + std::chrono::microseconds(context.blackboard->GetData<int>(spinKey));
+            while (std::chrono::steady_clock::now() < end) {}
+            return fluczakAI::Status::RUNNING;
+        }
+    };
+
+    std::unique_ptr<fluczakAI::BehaviorTree> BuildTree()
+    {
+        fluczakAI::BehaviorTreeBuilder builder;
+        builder.Sequence();
+        builder.Action<RecordingAction>().Back();
+        return builder.End();
+    }
+
+    std::vector<fluczakAI::BehaviorTreeContext> MakeContexts(size_t count)
+    {
+        std::vector<fluczakAI::BehaviorTreeContext> contexts(count);
+        for (size_t i = 0; i < count; i++)
+        {
+            contexts[i].blackboard->SetData(indexKey, static_cast<int>(i));
+            contexts[i].blackboard->SetData(ticksKey, 0);
+            contexts[i].blackboard->SetData(sleepKey, 0.0f);
+            contexts[i].blackboard->SetData(spinKey, 0);
+        }
+        return contexts;
+    }
+
+    void TestRoundRobin()
+    {
+        const auto tree = BuildTree();
+        auto contexts = MakeContexts(8);
+        // Frames of a power of two, so the sums of deltaTime are exact
+        fluczakAI::BudgetedScheduler scheduler(1.0f, {1, 4});
+        std::vector<fluczakAI::BudgetedScheduler::AgentId> ids;
+        for (auto& context : contexts) ids.push_back(scheduler.Add(context, *tree, 1));
+
+        // Two agents per frame in the order of registration, the first round counts from the registration
+        ticks.clear();
+        for (int frame = 0; frame < 8; frame++)
+        {
+            const auto stats = scheduler.Update(0.25f);
+            CHECK(stats.ticked == 2);
+            CHECK(stats.deferred == 0);
+        }
+        CHECK(ticks.size() == 16);
+        for (size_t i = 0; i < ticks.size(); i++)
+        {
+            CHECK(ticks[i].agent == static_cast<int>(i % 8));
+            const float expected = i < 8 ? 0.25f * static_cast<float>(i / 2 + 1) : 1.0f;
+            CHECK(ticks[i].deltaTime == expected);
+        }
+
+        // Removing an agent that was ticked this round mustn't make a waiting one miss the round
+        ticks.clear();
+        scheduler.Update(0.25f);
+        scheduler.Remove(ids[1]);
+        for (int frame = 0; frame < 4; frame++) scheduler.Update(0.25f);
+        std::vector<int> ticked(8, 0);
+        for (size_t i = 2; i < ticks.size() && ticks[i].agent != 0; i++) ticked[ticks[i].agent]++;
+        for (int agent = 2; agent < 8; agent++) CHECK(ticked[agent] == 1);
+        for (size_t i = 2; i < ticks.size(); i++) CHECK(ticks[i].agent != 1);
+    }
+
+    void TestDeferredAgents()
+    {
+        const auto tree = BuildTree();
+        auto contexts = MakeContexts(3);
+        // No budget, one agent a frame, the others wait with their time adding up
+        fluczakAI::BudgetedScheduler scheduler(0.0f, {1});
+        for (auto& context : contexts) scheduler.Add(context, *tree, 0);
+
+        ticks.clear();
+        const auto first = scheduler.Update(0.25f);
+        CHECK(first.ticked == 1);
+        CHECK(first.deferred == 2);
+        for (int frame = 0; frame < 5; frame++) scheduler.Update(0.25f);
+
+        const int agents[] = {0, 1, 2, 0, 1, 2};
+        const float deltaTimes[] = {0.25f, 0.5f, 0.75f, 0.75f, 0.75f, 0.75f};
+        CHECK(ticks.size() == 6);
+        for (size_t i = 0; i < ticks.size() && i < 6; i++)
+        {
+            CHECK(ticks[i].agent == agents[i]);
+            CHECK(ticks[i].deltaTime == deltaTimes[i]);
+        }
+    }
+
+    void TestOverrun()
+    {
+        const auto tree = BuildTree();
+        auto contexts = MakeContexts(4);
+        fluczakAI::BudgetedScheduler scheduler(1.0f, {1});
+        for (auto& context : contexts) scheduler.Add(context, *tree, 0);
+
+        int overruns = 0;
+        fluczakAI::BudgetedScheduler::FrameStats reported;
+        scheduler.SetOverrunCallback([&](const fluczakAI::BudgetedScheduler::FrameStats& stats)
+        {
+            overruns++;
+            reported = stats;
+        });
+
+        const auto within = scheduler.Update(0.25f);
+        CHECK(within.ticked == 4);
+        CHECK(within.overrun == 0.0f);
+        CHECK(overruns == 0);
+
+        // Over the budget after the first agent, the others wait for the next frame
+        for (auto& context : contexts) context.blackboard->SetData(spinKey, 2000);
+        scheduler.SetBudget(0.001f);
+        const auto over = scheduler.Update(0.25f);
+        CHECK(over.ticked == 1);
+        CHECK(over.deferred == 3);
+        CHECK(over.elapsed >= 0.002f);
+        CHECK(over.overrun == over.elapsed - 0.001f);
+        CHECK(overruns == 1);
+        CHECK(reported.ticked == over.ticked && reported.overrun == over.overrun);
+        CHECK(scheduler.GetLastFrameStats().overrun == over.overrun);
+    }
+
+    void TestSleepingAgents()
+    {
+        const auto tree = BuildTree();
+        auto contexts = MakeContexts(3);
+        contexts[0].blackboard->SetData(sleepKey, 0.6f);
+        contexts[2].blackboard->SetData(sleepKey, 100.0f);
+        // Destroyed before the contexts, so the sleeping ones leave their blackboards first
+        fluczakAI::BudgetedScheduler scheduler(1.0f, {1});
+        std::vector<fluczakAI::BudgetedScheduler::AgentId> ids;
+        for (auto& context : contexts) ids.push_back(scheduler.Add(context, *tree, 0));
+
+        ticks.clear();
+        scheduler.Update(0.25f);
+        CHECK(scheduler.GetSleepManager().GetSleepingCount() == 2);
+
+        // Asleep agents are skipped without a tick until their time is up
+        for (int frame = 0; frame < 2; frame++)
+        {
+            const auto stats = scheduler.Update(0.25f);
+            CHECK(stats.ticked == 1);
+            CHECK(stats.asleep == 2);
+            CHECK(stats.deferred == 0);
+        }
+        ticks.clear();
+        const auto woken = scheduler.Update(0.25f);
+        CHECK(woken.ticked == 2);
+        CHECK(woken.asleep == 1);
+        CHECK(ticks.size() == 2 && ticks[0].agent == 0 && ticks[0].deltaTime == 0.75f);
+        CHECK(!contexts[0].IsSleeping());
+
+        // Removing a sleeping agent wakes it
+        scheduler.Remove(ids[2]);
+        CHECK(!contexts[2].IsSleeping());
+        CHECK(scheduler.GetSleepManager().GetSleepingCount() == 0);
+    }
+}
+
+int main()
+{
+    TestRoundRobin();
+    TestDeferredAgents();
+    TestOverrun();
+    TestSleepingAgents();
+    return TestFailures() == 0 ? 0 : 1;
+}
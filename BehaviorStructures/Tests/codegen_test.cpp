@@ -0,0 +1,140 @@
+// Differential test of the code generator: the trees and state machines generated from the json in data/ at build
+// time have to execute exactly like the ones deserialized from the same json.
+
+#include <fstream>
+#include <random>
+#include <string>
+#include <utility>
+#include "codegen_test_types.hpp"
+#include "generated_state_machine.hpp"
+#include "generated_tree.hpp"
+#include "test_utilities.hpp"
+#include "BehaviorTrees/behavior_tree.hpp"
+#include "Serialization/generic_factory.hpp"
+
+namespace
+{
+    template <int... K>
+    void RegisterActions(std::integer_sequence<int, K...>)
+    {
+        (fluczakAI::GenericFactory<fluczakAI::BehaviorTreeAction>::Instance().RegisterProduct<LoggingAction<K>>("Act" + std::to_string(K)), ...);
+    }
+
+    nlohmann::json Load(const std::string& file)
+    {
+        std::ifstream input(TEST_DATA_DIR + file);
+        return nlohmann::json::parse(input);
+    }
+
+    void TestBehaviorTree()
+    {
+        nlohmann::json json = Load("codegen_tree.json");
+        std::unique_ptr<fluczakAI::Behavior> root;
+        fluczakAI::BehaviorTree interpreted(root);
+        interpreted.Deserialize(json);
+        generated::GeneratedTree generatedTree;
+        CHECK(interpreted.GetNodeCount() == generatedTree.GetNodeCount());
+
+        for (unsigned seed = 0; seed < 300; seed++)
+        {
+            fluczakAI::BehaviorTreeContext interpretedContext;
+            fluczakAI::BehaviorTreeContext generatedContext;
+            std::mt19937 interpretedRandom(seed);
+            std::mt19937 generatedRandom(seed);
+            std::string interpretedLog;
+            std::string generatedLog;
+
+            for (int tick = 0; tick < 40; tick++)
+            {
+                const int x = static_cast<int>(seed + tick) % 4;
+                const float y = static_cast<float>((seed * 7 + tick) % 5) * 0.15f;
+                for (auto* context : {&interpretedContext, &generatedContext})
+                {
+                    context->blackboard->SetData("x", x);
+                    context->blackboard->SetData("y", y);
+                }
+
+                codegen_test::random = &interpretedRandom;
+                codegen_test::log = &interpretedLog;
+                interpreted.Execute(interpretedContext);
+                codegen_test::random = &generatedRandom;
+                codegen_test::log = &generatedLog;
+                const fluczakAI::Status generatedStatus = generatedTree.Execute(generatedContext);
+
+                CHECK(interpretedContext.statuses[0] == generatedStatus);
+            }
+            CHECK(interpretedLog == generatedLog);
+        }
+
+        // The editor variables of the json are set on the generated actions, the ones they don't have are skipped
+        int numActions = 0;
+        generatedTree.ForEachAction([&numActions](fluczakAI::BehaviorTreeAction& action)
+        {
+            numActions++;
+            if (action.GetId() == 3) CHECK(static_cast<Act0&>(action).speed == 2.5f);
+        });
+        CHECK(numActions == 13);
+    }
+
+    void TestStateMachine()
+    {
+        nlohmann::json json = Load("codegen_state_machine.json");
+        fluczakAI::FiniteStateMachine interpreted;
+        interpreted.Deserialize(json);
+        generated::GeneratedStateMachine generatedStateMachine;
+        CHECK(generated::GeneratedStateMachine::StateCount == 4);
+
+        for (unsigned seed = 0; seed < 200; seed++)
+        {
+            fluczakAI::StateMachineContext interpretedContext;
+            fluczakAI::StateMachineContext generatedContext;
+            std::mt19937 random(seed);
+            std::string interpretedLog;
+            std::string generatedLog;
+
+            for (int tick = 0; tick < 40; tick++)
+            {
+                const int x = static_cast<int>(random() % 4);
+                const float y = static_cast<float>(random() % 4) * 0.25f;
+                const std::string name = random() % 3 == 0 ? "bob" : "al";
+                const bool alert = random() % 2 == 0;
+                for (auto* context : {&interpretedContext, &generatedContext})
+                {
+                    context->blackboard->SetData("x", x);
+                    context->blackboard->SetData("y", y);
+                    context->blackboard->SetData("name", name);
+                    context->blackboard->SetData("alert", alert);
+                }
+
+                codegen_test::log = &interpretedLog;
+                interpreted.Execute(interpretedContext);
+                codegen_test::log = &generatedLog;
+                generatedStateMachine.Execute(generatedContext);
+
+                CHECK(interpretedContext.GetCurrentState() == generatedContext.GetCurrentState());
+            }
+            CHECK(interpretedLog == generatedLog);
+            CHECK(generatedLog.find("@3.5") != std::string::npos);
+        }
+
+        fluczakAI::StateMachineContext context;
+        std::string log;
+        codegen_test::log = &log;
+        generatedStateMachine.Execute(context);
+        generatedStateMachine.InitializeContext(context);
+        CHECK(!context.GetCurrentState().has_value());
+    }
+}
+
+int main()
+{
+    RegisterActions(std::make_integer_sequence<int, 13>{});
+    fluczakAI::GenericFactory<fluczakAI::State>::Instance().RegisterProduct<Idle>("Idle");
+    fluczakAI::GenericFactory<fluczakAI::State>::Instance().RegisterProduct<Patrol>("Patrol");
+    fluczakAI::GenericFactory<fluczakAI::State>::Instance().RegisterProduct<Chase>("Chase");
+    fluczakAI::GenericFactory<fluczakAI::State>::Instance().RegisterProduct<Flee>("Flee");
+
+    TestBehaviorTree();
+    TestStateMachine();
+    return TestFailures() == 0 ? 0 : 1;
+}
@@ -0,0 +1,69 @@
+#pragma once
+#include <random>
+#include <string>
+#include "BehaviorTrees/behaviors.hpp"
+#include "FSM/finite_state_machine.hpp"
+#include "Serialization/editor_variables.hpp"
+
+// The actions and states of the codegen test. They log every call, so an interpreted and a generated structure
+// executed side by side have to produce the same log.
+namespace codegen_test
+{
+inline std::mt19937* random = nullptr;
+inline std::string* log = nullptr;
+}
+
+template <int K>
+class LoggingAction : public fluczakAI::BehaviorTreeAction
+{
+public:
+    void Initialize(fluczakAI::BehaviorTreeContext& context) override { *codegen_test::log += "I" + std::to_string(m_id); }
+
+    fluczakAI::Status Tick(fluczakAI::BehaviorTreeContext& context) override
+    {
+        const auto status = static_cast<fluczakAI::Status>((*codegen_test::random)() % 4);
+        *codegen_test::log += "T" + std::to_string(m_id) + ":" + std::to_string(static_cast<int>(status)) + "@" + std::to_string(speed);
+        return status;
+    }
+
+    void End(fluczakAI::BehaviorTreeContext& context, fluczakAI::Status status) override { *codegen_test::log += "E" + std::to_string(m_id); }
+
+    void Reset(fluczakAI::BehaviorTreeContext& context) override
+    {
+        *codegen_test::log += "R" + std::to_string(m_id);
+        Behavior::Reset(context);
+    }
+
+    float speed = 1.0f;
+    fluczakAI::SerializedField<float> speedField{*this, "speed", speed};
+};
+
+template <int K>
+class LoggingState : public fluczakAI::State
+{
+public:
+    void Initialize(fluczakAI::StateMachineContext& context) override { *codegen_test::log += "i" + std::to_string(K); }
+    void Update(fluczakAI::StateMachineContext& context) override { *codegen_test::log += "u" + std::to_string(K) + "@" + std::to_string(speed); }
+    void End(fluczakAI::StateMachineContext& context) override { *codegen_test::log += "e" + std::to_string(K); }
+
+    float speed = 1.0f;
+    fluczakAI::SerializedField<float> speedField{*this, "speed", speed};
+};
+
+using Act0 = LoggingAction<0>;
+using Act1 = LoggingAction<1>;
+using Act2 = LoggingAction<2>;
+using Act3 = LoggingAction<3>;
+using Act4 = LoggingAction<4>;
+using Act5 = LoggingAction<5>;
+using Act6 = LoggingAction<6>;
+using Act7 = LoggingAction<7>;
+using Act8 = LoggingAction<8>;
+using Act9 = LoggingAction<9>;
+using Act10 = LoggingAction<10>;
+using Act11 = LoggingAction<11>;
+using Act12 = LoggingAction<12>;
+using Idle = LoggingState<0>;
+using Patrol = LoggingState<1>;
+using Chase = LoggingState<2>;
+using Flee = LoggingState<3>;
@@ -0,0 +1,180 @@
+// Tests that Comparator::EvaluateBatch matches evaluating the comparator for every agent on its own blackboard,
+// for every comparison of float, double, int and bool values. The counts leave partial groups of SIMD lanes and
+// cross words of the result bitmask, and the floating point values include NaN, which only passes NOT_EQUAL.
+// The overload taking blackboards is checked as well, across its chunks, with missing values, rows of a column
+// store and values of a type without SIMD kernels.
+
+#include <cstdint>
+#include <cstdio>
+#include <limits>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+#include "Blackboards/Blackboard.hpp"
+#include "Blackboards/BlackboardColumnStore.hpp"
+#include "Blackboards/Comparator.hpp"
+#include "test_utilities.hpp"
+
+namespace
+{
+    const fluczakAI::BlackboardKey valueKey("value");
+    // A word past the end of the bitmask that EvaluateBatch mustn't touch
+    constexpr uint64_t guard = 0xA5A5A5A5A5A5A5A5ull;
+
+    const fluczakAI::ComparisonType comparisons[] = {
+        fluczakAI::ComparisonType::EQUAL, fluczakAI::ComparisonType::NOT_EQUAL, fluczakAI::ComparisonType::LESS,
+        fluczakAI::ComparisonType::LESS_EQUAL, fluczakAI::ComparisonType::GREATER, fluczakAI::ComparisonType::GREATER_EQUAL};
+
+    // Less than a group of lanes, whole groups plus a remainder, and counts around one and two words of the bitmask
+    const size_t counts[] = {0, 1, 3, 7, 15, 17, 31, 33, 63, 64, 65, 100, 127, 128, 129, 200};
+
+    /**
+     * \brief Check the EvaluateBatch of many blackboards against Evaluate. Every third blackboard is a view of a row
+     * of a column store the comparator is bound to, every seventh one doesn't have the value.
+     */
+    template <typename T>
+    void CheckBlackboards(const std::vector<T>& pool, const std::vector<T>& constants)
+    {
+        std::mt19937 generator(13);
+        constexpr size_t maxCount = 600;
+        std::vector<fluczakAI::Blackboard> blackboards(maxCount);
+        std::vector<const fluczakAI::Blackboard*> pointers(maxCount);
+        fluczakAI::BlackboardColumnStore store(maxCount);
+        if constexpr (std::is_trivially_copyable_v<T>) store.AddColumn<T>(valueKey);
+        for (size_t i = 0; i < maxCount; i++)
+        {
+            pointers[i] = &blackboards[i];
+            if (i % 7 == 0) continue;
+            if constexpr (std::is_trivially_copyable_v<T>)
+            {
+                if (i % 3 == 0) store.BindView(blackboards[i], i);
+            }
+            const T value = pool[generator() % pool.size()];
+            blackboards[i].SetData(valueKey, value);
+        }
+
+        // Counts around the chunks the values are gathered in
+        const size_t blackboardCounts[] = {0, 1, 65, 255, 256, 257, 511, 513, 600};
+        for (const T constant : constants)
+        {
+            for (const fluczakAI::ComparisonType type : comparisons)
+            {
+                fluczakAI::Comparator<T> comparator(valueKey, type, constant);
+                comparator.BindLayout(store);
+                const fluczakAI::IComparator& shared = comparator;
+                for (const size_t count : blackboardCounts)
+                {
+                    const size_t words = (count + 63) / 64;
+                    std::vector<uint64_t> results(words + 1, ~uint64_t{0});
+                    results[words] = guard;
+                    shared.EvaluateBatch(pointers.data(), count, results.data());
+
+                    size_t mismatches = 0;
+                    for (size_t i = 0; i < count; i++)
+                    {
+                        const bool batched = (results[i >> 6] >> (i & 63)) & 1;
+                        if (batched != comparator.Evaluate(*pointers[i])) mismatches++;
+                    }
+                    const bool isTailClear = count % 64 == 0 || (results[count >> 6] >> (count & 63)) == 0;
+                    CHECK(mismatches == 0);
+                    CHECK(isTailClear);
+                    CHECK(results[words] == guard);
+                }
+            }
+        }
+    }
+
+    /**
+     * \brief Check EvaluateBatch against Evaluate for every comparison and count, with values drawn from a pool
+     * \param name - name of the type to print on a failure
+     * \param pool - the values of the agents are drawn from it, it holds the constants as well
+     * \param constants - the values the agents are compared against
+     */
+    template <typename T>
+    void Check(const char* name, const std::vector<T>& pool, const std::vector<T>& constants)
+    {
+        std::mt19937 generator(11);
+        constexpr size_t maxCount = 200;
+        std::vector<T> values(maxCount);
+        std::vector<std::unique_ptr<fluczakAI::Blackboard>> blackboards(maxCount);
+        for (size_t i = 0; i < maxCount; i++)
+        {
+            const T value = pool[generator() % pool.size()];
+            values[i] = value;
+            blackboards[i] = std::make_unique<fluczakAI::Blackboard>();
+            blackboards[i]->SetData(valueKey, value);
+        }
+
+        // std::vector<bool> has no data(), so the values are copied into an array
+        const std::unique_ptr<T[]> array(new T[maxCount]);
+        std::copy(values.begin(), values.end(), array.get());
+
+        for (const T constant : constants)
+        {
+            for (const fluczakAI::ComparisonType type : comparisons)
+            {
+                const fluczakAI::Comparator<T> comparator(valueKey, type, constant);
+                for (const size_t count : counts)
+                {
+                    const size_t words = (count + 63) / 64;
+                    std::vector<uint64_t> results(words + 1, ~uint64_t{0});
+                    results[words] = guard;
+                    comparator.EvaluateBatch(array.get(), count, results.data());
+
+                    size_t mismatches = 0;
+                    for (size_t i = 0; i < count; i++)
+                    {
+                        const bool batched = (results[i >> 6] >> (i & 63)) & 1;
+                        if (batched != comparator.Evaluate(*blackboards[i])) mismatches++;
+                    }
+                    // The bits past the count are cleared, the word after the bitmask is left alone
+                    const bool isTailClear = count % 64 == 0 || (results[count >> 6] >> (count & 63)) == 0;
+                    if (mismatches != 0 || !isTailClear || results[words] != guard)
+                    {
+                        std::printf("%s, comparison %d, %zu values: %zu mismatches\n", name, static_cast<int>(type), count, mismatches);
+                    }
+                    CHECK(mismatches == 0);
+                    CHECK(isTailClear);
+                    CHECK(results[words] == guard);
+                }
+            }
+        }
+
+        // The same through a column store
+        fluczakAI::BlackboardColumnStore store(maxCount);
+        store.AddColumn<T>(valueKey);
+        std::copy(values.begin(), values.end(), store.GetColumn<T>(valueKey));
+        for (const fluczakAI::ComparisonType type : comparisons)
+        {
+            const fluczakAI::Comparator<T> comparator(valueKey, type, constants.front());
+            std::vector<uint64_t> results((maxCount + 63) / 64);
+            comparator.EvaluateBatch(store, results.data());
+            size_t mismatches = 0;
+            for (size_t i = 0; i < maxCount; i++)
+            {
+                const bool batched = (results[i >> 6] >> (i & 63)) & 1;
+                if (batched != comparator.Evaluate(*blackboards[i])) mismatches++;
+            }
+            CHECK(mismatches == 0);
+        }
+
+        CheckBlackboards<T>(pool, constants);
+    }
+}
+
+int main()
+{
+    const float nanFloat = std::numeric_limits<float>::quiet_NaN();
+    const double nanDouble = std::numeric_limits<double>::quiet_NaN();
+    const float infFloat = std::numeric_limits<float>::infinity();
+
+    Check<float>("float", {-infFloat, -1.5f, -0.0f, 0.0f, 0.5f, 1.5f, infFloat, nanFloat}, {0.5f, 0.0f, -infFloat, nanFloat});
+    Check<double>("double", {-2.0, -0.0, 0.0, 0.25, 2.0, 1e300, nanDouble}, {0.25, 0.0, nanDouble});
+    Check<int>("int", {std::numeric_limits<int>::min(), -7, -1, 0, 1, 7, std::numeric_limits<int>::max()},
+               {0, 7, std::numeric_limits<int>::min(), std::numeric_limits<int>::max()});
+    Check<bool>("bool", {false, true}, {false, true});
+    CheckBlackboards<std::string>({"", "a", "b", "ab"}, {"a", ""});
+
+    return TestFailures() == 0 ? 0 : 1;
+}
@@ -0,0 +1,164 @@
+// Tests of ContextPool: a released context comes back as it was first acquired, including the row of a
+// BlackboardColumnStore its blackboard is bound to, and once the pool has grown, acquiring, executing and releasing
+// contexts with trivially copyable defaults doesn't allocate. The global operator new is replaced by one that counts
+// its calls.
+
+#include <cstdlib>
+#include <new>
+#include "context_pool.hpp"
+#include "test_utilities.hpp"
+#include "BehaviorTrees/behavior_tree_builder.hpp"
+#include "Blackboards/BlackboardColumnStore.hpp"
+
+namespace
+{
+    size_t allocations = 0;
+
+    void* CountedAllocate(size_t size)
+    {
+        allocations++;
+        if (void* memory = std::malloc(size == 0 ? 1 : size)) return memory;
+        throw std::bad_alloc();
+    }
+}
+
+void* operator new(size_t size) { return CountedAllocate(size); }
+void* operator new[](size_t size) { return CountedAllocate(size); }
+void operator delete(void* memory) noexcept { std::free(memory); }
+void operator delete[](void* memory) noexcept { std::free(memory); }
+void operator delete(void* memory, size_t) noexcept { std::free(memory); }
+void operator delete[](void* memory, size_t) noexcept { std::free(memory); }
+
+namespace
+{
+    const fluczakAI::BlackboardKey healthKey("health");
+    const fluczakAI::BlackboardKey ammoKey("ammo");
+    const fluczakAI::BlackboardKey speedKey("speed");
+    const fluczakAI::BlackboardKey alertKey("alert");
+    const fluczakAI::BlackboardKey seenKey("seen");
+
+    /**
+     * \brief Changes the column values, the template values and a key that isn't in the template
+     */
+    class FightAction : public fluczakAI::BehaviorTreeAction
+    {
+    public:
+        fluczakAI::Status Tick(fluczakAI::BehaviorTreeContext& context) override
+        {
+            fluczakAI::Blackboard& blackboard = *context.blackboard;
+            blackboard.SetData(healthKey, blackboard.GetData<float>(healthKey) - 10.0f);
+            blackboard.SetData(ammoKey, blackboard.GetData<int>(ammoKey) - 1);
+            blackboard.SetData(speedKey, 2.0f);
+            blackboard.SetData(alertKey, true);
+            blackboard.SetData(seenKey, 1);
+            return fluczakAI::Status::RUNNING;
+        }
+    };
+
+    std::unique_ptr<fluczakAI::BehaviorTree> BuildTree()
+    {
+        fluczakAI::BehaviorTreeBuilder builder;
+        builder.Sequence();
+        builder.Action<FightAction>().Back();
+        return builder.End();
+    }
+
+    fluczakAI::BlackboardTemplate MakeDefaults()
+    {
+        fluczakAI::BlackboardTemplate defaults;
+        defaults.Set(speedKey, 1.0f).Set(alertKey, false);
+        return defaults;
+    }
+
+    bool IsFresh(const fluczakAI::BehaviorTreeContext& context, const fluczakAI::BehaviorTree& tree)
+    {
+        const fluczakAI::Blackboard& blackboard = *context.blackboard;
+        bool isFresh = context.deltaTime == 0.0f && !context.IsSleeping() && context.statuses.Size() == tree.GetNodeCount();
+        for (int id = 0; id < static_cast<int>(tree.GetNodeCount()); id++) isFresh = isFresh && context.statuses.Get(id) == fluczakAI::Status::INVALID;
+        return isFresh && blackboard.GetData<float>(healthKey) == 100.0f && blackboard.GetData<int>(ammoKey) == 30 &&
+            blackboard.GetData<float>(speedKey) == 1.0f && !blackboard.GetData<bool>(alertKey) && blackboard.TryGet<int>(seenKey) == nullptr;
+    }
+
+    void TestRecycledContexts()
+    {
+        const auto tree = BuildTree();
+        fluczakAI::BlackboardColumnStore store(3);
+        store.AddColumn<float>(healthKey, 100.0f);
+        store.AddColumn<int>(ammoKey, 30);
+
+        fluczakAI::BehaviorTreeContextPool pool(*tree, MakeDefaults());
+        fluczakAI::BehaviorTreeContext* contexts[3];
+        for (size_t i = 0; i < 3; i++)
+        {
+            contexts[i] = &pool.Acquire();
+            store.BindView(*contexts[i]->blackboard, i);
+        }
+        for (auto* context : contexts)
+        {
+            context->deltaTime = 0.5f;
+            tree->Execute(*context);
+        }
+        CHECK(store.GetColumn<float>(healthKey)[1] == 90.0f);
+
+        // The released agent gets the defaults of the columns back, the other rows keep their values
+        pool.Release(*contexts[1]);
+        CHECK(pool.GetFreeCount() == 1);
+        CHECK(store.GetColumn<float>(healthKey)[1] == 100.0f);
+        CHECK(store.GetColumn<int>(ammoKey)[1] == 30);
+        CHECK(store.GetColumn<float>(healthKey)[0] == 90.0f && store.GetColumn<int>(ammoKey)[2] == 29);
+
+        // Acquired again, it is still bound to its row and starts from scratch
+        fluczakAI::BehaviorTreeContext& recycled = pool.Acquire();
+        CHECK(&recycled == contexts[1]);
+        CHECK(pool.Size() == 3);
+        CHECK(IsFresh(recycled, *tree));
+        tree->Execute(recycled);
+        CHECK(store.GetColumn<float>(healthKey)[1] == 90.0f);
+
+        for (auto* context : contexts) pool.Release(*context);
+        for (size_t i = 0; i < 3; i++) CHECK(store.GetColumn<float>(healthKey)[i] == 100.0f);
+    }
+
+    void TestNoAllocations()
+    {
+        const auto tree = BuildTree();
+        constexpr size_t count = 8;
+        fluczakAI::BlackboardColumnStore store(count);
+        store.AddColumn<float>(healthKey, 100.0f);
+        store.AddColumn<int>(ammoKey, 30);
+
+        fluczakAI::BehaviorTreeContextPool pool(*tree, MakeDefaults());
+        pool.Reserve(count);
+        fluczakAI::BehaviorTreeContext* contexts[count];
+        for (size_t i = 0; i < count; i++)
+        {
+            contexts[i] = &pool.Acquire();
+            store.BindView(*contexts[i]->blackboard, i);
+            tree->Execute(*contexts[i]);
+        }
+        for (auto* context : contexts) pool.Release(*context);
+
+        const size_t before = allocations;
+        bool isFresh = true;
+        for (int round = 0; round < 100; round++)
+        {
+            for (auto*& context : contexts)
+            {
+                context = &pool.Acquire();
+                isFresh = isFresh && IsFresh(*context, *tree);
+                tree->Execute(*context);
+            }
+            for (auto* context : contexts) pool.Release(*context);
+        }
+        CHECK(allocations == before);
+        CHECK(isFresh);
+        CHECK(pool.Size() == count);
+    }
+}
+
+int main()
+{
+    TestRecycledContexts();
+    TestNoAllocations();
+    return TestFailures() == 0 ? 0 : 1;
+}
@@ -0,0 +1,156 @@
+// Tests of CoroutineAction: frames are kept per context, destroyed as soon as their action is done or reset, and
+// can be created by the children of a threaded Parallel at the same time.
+
+#include "BehaviorTrees/coroutine_action.hpp"
+#include "test_utilities.hpp"
+
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+#include <atomic>
+#include <vector>
+#include "BehaviorTrees/behavior_tree_builder.hpp"
+#include "BehaviorTrees/flat_behavior_tree.hpp"
+#include "BehaviorTrees/static_behavior_tree.hpp"
+#include "Scheduling/thread_pool.hpp"
+
+namespace
+{
+    // The number of frames that are alive
+    std::atomic<int> liveFrames{0};
+
+    struct FrameGuard
+    {
+        FrameGuard() { liveFrames++; }
+        ~FrameGuard() { liveFrames--; }
+    };
+
+    /**
+     * \brief Waits a number of ticks that depends on its id, then succeeds
+     */
+    class CountdownAction : public fluczakAI::CoroutineAction
+    {
+    protected:
+        fluczakAI::BehaviorTask Run(fluczakAI::BehaviorTreeContext& context) override
+        {
+            FrameGuard guard;
+            for (int i = 0; i < 1 + m_id % 3; i++)
+            {
+                co_await fluczakAI::NextTick();
+            }
+            co_return fluczakAI::Status::SUCCESS;
+        }
+    };
+
+    /**
+     * \brief Never finishes on its own
+     */
+    class ForeverAction : public fluczakAI::CoroutineAction
+    {
+    protected:
+        fluczakAI::BehaviorTask Run(fluczakAI::BehaviorTreeContext& context) override
+        {
+            FrameGuard guard;
+            while (true)
+            {
+                co_await fluczakAI::NextTick();
+            }
+        }
+    };
+
+    class RunningAction : public fluczakAI::BehaviorTreeAction
+    {
+    public:
+        fluczakAI::Status Tick(fluczakAI::BehaviorTreeContext& context) override { return fluczakAI::Status::RUNNING; }
+    };
+
+    void TestResetDestroysFrames()
+    {
+        // The Parallel succeeds as soon as its first child does and resets the Sequence below it, which has to
+        // destroy the frame suspended in its action even though the Sequence isn't executed again
+        fluczakAI::BehaviorTreeBuilder builder;
+        builder.Sequence();
+        builder.Parallel(1, 1);
+        builder.Action<fluczakAI::BehaviorTreeAction>().Back();
+        builder.Sequence();
+        builder.Action<ForeverAction>().Back();
+        builder.Back();
+        builder.Back();
+        builder.Action<RunningAction>().Back();
+        const auto tree = builder.End();
+        const fluczakAI::FlatBehaviorTree flat(*tree);
+        fluczakAI::StaticBehaviorTree<fluczakAI::StaticSequence<
+            fluczakAI::StaticParallel<1, 1, fluczakAI::BehaviorTreeAction, fluczakAI::StaticSequence<ForeverAction>>,
+            RunningAction>> staticTree;
+
+        fluczakAI::BehaviorTreeContext context;
+        fluczakAI::BehaviorTreeContext flatContext;
+        fluczakAI::BehaviorTreeContext staticContext;
+        for (int tick = 0; tick < 100; tick++)
+        {
+            tree->Execute(context);
+            flat.Execute(flatContext);
+            staticTree.Execute(staticContext);
+            CHECK(liveFrames == 0);
+        }
+
+        // Resetting the root reaches the frames right away as well
+        fluczakAI::BehaviorTreeBuilder sequenceBuilder;
+        sequenceBuilder.Sequence();
+        sequenceBuilder.Action<ForeverAction>().Back();
+        const auto sequence = sequenceBuilder.End();
+        fluczakAI::BehaviorTreeContext sequenceContext;
+        sequence->Execute(sequenceContext);
+        CHECK(liveFrames == 1);
+        sequence->GetRoot()->Reset(sequenceContext);
+        CHECK(liveFrames == 0);
+    }
+
+    void TestThreadedParallel()
+    {
+        fluczakAI::BehaviorTreeBuilder builder;
+        builder.Sequence();
+        builder.Parallel(0, 0);
+        for (int i = 0; i < 8; i++)
+        {
+            builder.Action<CountdownAction>().Back();
+        }
+        builder.Back();
+        builder.Action<CountdownAction>().Back();
+        const auto tree = builder.End();
+
+        fluczakAI::ThreadPool pool(4);
+        constexpr size_t count = 64;
+        std::vector<fluczakAI::BehaviorTreeContext> serial(count);
+        std::vector<fluczakAI::BehaviorTreeContext> threaded(count);
+        for (auto& context : threaded) context.threadPool = &pool;
+
+        for (int tick = 0; tick < 100; tick++)
+        {
+            for (size_t i = 0; i < count; i++)
+            {
+                tree->Execute(serial[i]);
+                tree->Execute(threaded[i]);
+                for (size_t id = 0; id < tree->GetNodeCount(); id++)
+                {
+                    CHECK(serial[i].statuses.Get(id) == threaded[i].statuses.Get(id));
+                }
+            }
+        }
+
+        serial.clear();
+        threaded.clear();
+        CHECK(liveFrames == 0);
+    }
+}
+
+int main()
+{
+    TestResetDestroysFrames();
+    TestThreadedParallel();
+    return TestFailures() == 0 ? 0 : 1;
+}
+#else
+int main()
+{
+    return 0;
+}
+#endif
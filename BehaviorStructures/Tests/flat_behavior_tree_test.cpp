@@ -0,0 +1,248 @@
+// Differential tests of FlatBehaviorTree and BatchBehaviorTreeExecutor: random trees are executed for random agents
+// by BehaviorTree::Execute and by the flat tree, and every behavior has to be called in the same order with the
+// same results and end with the same status.
+
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+#include "BehaviorTrees/batch_behavior_tree_executor.hpp"
+#include "BehaviorTrees/behavior_tree.hpp"
+#include "BehaviorTrees/behavior_tree_builder.hpp"
+#include "BehaviorTrees/flat_behavior_tree.hpp"
+#include "test_utilities.hpp"
+
+namespace
+{
+    /**
+     * \brief What happened to the actions of one agent, kept in its blackboard so agents executed in a batch don't
+     * share it
+     */
+    struct AgentLog
+    {
+        uint32_t random = 0;
+        std::vector<std::string> events{};
+    };
+
+    const fluczakAI::BlackboardKey logKey("log");
+    const fluczakAI::BlackboardKey valueKey("value");
+
+    /**
+     * \brief Logs every call and returns a status drawn from the random state of its agent
+     */
+    class LoggingAction : public fluczakAI::BehaviorTreeAction
+    {
+    public:
+        void Initialize(fluczakAI::BehaviorTreeContext& context) override
+        {
+            Log(context, "I");
+        }
+
+        fluczakAI::Status Tick(fluczakAI::BehaviorTreeContext& context) override
+        {
+            auto& log = context.blackboard->GetData<AgentLog>(logKey);
+            log.random = log.random * 1664525u + 1013904223u;
+            constexpr fluczakAI::Status statuses[] = {fluczakAI::Status::SUCCESS, fluczakAI::Status::RUNNING,
+                                                      fluczakAI::Status::FAILURE};
+            const fluczakAI::Status status = statuses[(log.random >> 16) % 3];
+            Log(context, "T" + std::to_string(static_cast<int>(status)));
+            return status;
+        }
+
+        void End(fluczakAI::BehaviorTreeContext& context, fluczakAI::Status status) override
+        {
+            Log(context, "E" + std::to_string(static_cast<int>(status)));
+        }
+
+        void Reset(fluczakAI::BehaviorTreeContext& context) override
+        {
+            Log(context, "R");
+            Behavior::Reset(context);
+        }
+
+    private:
+        void Log(fluczakAI::BehaviorTreeContext& context, const std::string& event) const
+        {
+            context.blackboard->GetData<AgentLog>(logKey).events.push_back(std::to_string(m_id) + event);
+        }
+    };
+
+    /**
+     * \brief Add a random subtree below the current behavior of the builder
+     * \param interruptingOnly - whether every selector is interrupting, so Resume executes the same as Execute
+     */
+    void BuildRandomSubtree(fluczakAI::BehaviorTreeBuilder& builder, std::mt19937& random, int depth,
+                            bool interruptingOnly)
+    {
+        const uint32_t kind = depth >= 5 ? 0 : random() % 10;
+        switch (kind)
+        {
+        case 1:
+        case 2:
+            builder.Sequence();
+            break;
+        case 3:
+        case 4:
+            builder.Selector(interruptingOnly || random() % 2 == 0);
+            break;
+        case 5:
+            builder.Parallel(static_cast<int>(random() % 3), static_cast<int>(random() % 3));
+            break;
+        case 6:
+            builder.Inverter();
+            break;
+        case 7:
+            switch (random() % 3)
+            {
+            case 0: builder.Repeater(1 + static_cast<int>(random() % 3)); break;
+            case 1: builder.AlwaysSucceed(); break;
+            default: builder.UntilFail(); break;
+            }
+            break;
+        case 8:
+            builder.Comparison(fluczakAI::Comparator<int>(valueKey, static_cast<fluczakAI::ComparisonType>(random() % 6),
+                                                          static_cast<int>(random() % 3)), random() % 2 == 0);
+            break;
+        default:
+            builder.Action<LoggingAction>().Back();
+            return;
+        }
+
+        const bool isDecorator = kind >= 6;
+        const uint32_t children = isDecorator ? 1 : 1 + random() % 4;
+        for (uint32_t i = 0; i < children; i++)
+        {
+            BuildRandomSubtree(builder, random, depth + 1, interruptingOnly);
+        }
+        builder.Back();
+    }
+
+    std::unique_ptr<fluczakAI::BehaviorTree> BuildRandomTree(uint32_t seed, bool interruptingOnly)
+    {
+        std::mt19937 random(seed);
+        fluczakAI::BehaviorTreeBuilder builder;
+        builder.Sequence();
+        for (uint32_t i = 0, count = 1 + random() % 4; i < count; i++)
+        {
+            BuildRandomSubtree(builder, random, 1, interruptingOnly);
+        }
+        return builder.End();
+    }
+
+    void InitializeAgent(fluczakAI::BehaviorTreeContext& context, uint32_t seed)
+    {
+        context.blackboard->SetData(logKey, AgentLog{seed});
+        context.blackboard->SetData(valueKey, 0);
+    }
+
+    void SetValue(fluczakAI::BehaviorTreeContext& context, int value)
+    {
+        context.blackboard->SetData(valueKey, value);
+    }
+
+    void CheckSameExecution(const fluczakAI::BehaviorTree& tree, fluczakAI::BehaviorTreeContext& expected,
+                            fluczakAI::BehaviorTreeContext& actual)
+    {
+        auto& expectedLog = expected.blackboard->GetData<AgentLog>(logKey);
+        auto& actualLog = actual.blackboard->GetData<AgentLog>(logKey);
+        CHECK(expectedLog.events == actualLog.events);
+        expectedLog.events.clear();
+        actualLog.events.clear();
+
+        for (size_t id = 0; id < tree.GetNodeCount(); id++)
+        {
+            CHECK(expected.statuses.Get(id) == actual.statuses.Get(id));
+        }
+    }
+
+    void TestExecute()
+    {
+        for (uint32_t seed = 0; seed < 500; seed++)
+        {
+            const auto tree = BuildRandomTree(seed, false);
+            const fluczakAI::FlatBehaviorTree flat(*tree);
+
+            fluczakAI::BehaviorTreeContext expected;
+            fluczakAI::BehaviorTreeContext actual;
+            InitializeAgent(expected, seed);
+            InitializeAgent(actual, seed);
+            for (int tick = 0; tick < 40; tick++)
+            {
+                SetValue(expected, tick % 3);
+                SetValue(actual, tick % 3);
+                tree->Execute(expected);
+                CHECK(flat.Execute(actual) == expected.statuses.Get(0));
+                CheckSameExecution(*tree, expected, actual);
+            }
+        }
+    }
+
+    void TestResume()
+    {
+        // Resume skips the children of non-interrupting selectors before their running child, so it only executes
+        // like Execute when all selectors are interrupting
+        for (uint32_t seed = 0; seed < 500; seed++)
+        {
+            const auto tree = BuildRandomTree(seed, true);
+            const fluczakAI::FlatBehaviorTree flat(*tree);
+
+            fluczakAI::BehaviorTreeContext expected;
+            fluczakAI::BehaviorTreeContext actual;
+            InitializeAgent(expected, seed);
+            InitializeAgent(actual, seed);
+            for (int tick = 0; tick < 40; tick++)
+            {
+                SetValue(expected, tick % 3);
+                SetValue(actual, tick % 3);
+                tree->Execute(expected);
+                CHECK(flat.Resume(actual) == expected.statuses.Get(0));
+                CheckSameExecution(*tree, expected, actual);
+            }
+        }
+    }
+
+    void TestBatchExecute()
+    {
+        constexpr size_t agentCount = 37;
+        for (uint32_t seed = 0; seed < 100; seed++)
+        {
+            const auto tree = BuildRandomTree(seed, false);
+            const fluczakAI::FlatBehaviorTree flat(*tree);
+            fluczakAI::BatchBehaviorTreeExecutor executor(flat);
+
+            std::vector<fluczakAI::BehaviorTreeContext> expected(agentCount);
+            std::vector<fluczakAI::BehaviorTreeContext> actual(agentCount);
+            for (size_t i = 0; i < agentCount; i++)
+            {
+                InitializeAgent(expected[i], seed * 1000 + static_cast<uint32_t>(i));
+                InitializeAgent(actual[i], seed * 1000 + static_cast<uint32_t>(i));
+            }
+
+            std::vector<fluczakAI::Status> results(agentCount);
+            for (int tick = 0; tick < 20; tick++)
+            {
+                for (size_t i = 0; i < agentCount; i++)
+                {
+                    SetValue(expected[i], static_cast<int>((tick + i) % 3));
+                    SetValue(actual[i], static_cast<int>((tick + i) % 3));
+                    tree->Execute(expected[i]);
+                }
+
+                executor.Execute(actual, results);
+                for (size_t i = 0; i < agentCount; i++)
+                {
+                    CHECK(results[i] == expected[i].statuses.Get(0));
+                    CheckSameExecution(*tree, expected[i], actual[i]);
+                }
+            }
+        }
+    }
+}
+
+int main()
+{
+    TestExecute();
+    TestResume();
+    TestBatchExecute();
+    return TestFailures() == 0 ? 0 : 1;
+}
@@ -0,0 +1,165 @@
+// Tests of Parallel: finishing on the success and failure thresholds, failing once too few children are left to
+// succeed, not executing the children that have finished, and the thresholds written to and read from json.
+
+#include "test_utilities.hpp"
+#include "BehaviorTrees/behavior_tree.hpp"
+#include "BehaviorTrees/behavior_tree_builder.hpp"
+#include "Serialization/generic_factory.hpp"
+
+namespace
+{
+    const fluczakAI::BlackboardKey statusKeys[] = {
+        fluczakAI::BlackboardKey("status0"), fluczakAI::BlackboardKey("status1"), fluczakAI::BlackboardKey("status2")};
+    const fluczakAI::BlackboardKey tickKeys[] = {
+        fluczakAI::BlackboardKey("ticks0"), fluczakAI::BlackboardKey("ticks1"), fluczakAI::BlackboardKey("ticks2")};
+
+    using fluczakAI::Status;
+
+    /**
+     * \brief Returns the status the blackboard scripts for it and counts its ticks
+     */
+    template <int Index>
+    class ScriptedAction : public fluczakAI::BehaviorTreeAction
+    {
+    public:
+        Status Tick(fluczakAI::BehaviorTreeContext& context) override
+        {
+            context.blackboard->SetData(tickKeys[Index], context.blackboard->GetData<int>(tickKeys[Index]) + 1);
+            return context.blackboard->GetData<Status>(statusKeys[Index]);
+        }
+    };
+
+    /**
+     * \brief A parallel of three scripted children, its id is 0 and the ids of its children are 1 to 3
+     */
+    std::unique_ptr<fluczakAI::BehaviorTree> BuildParallel(int successThreshold, int failureThreshold)
+    {
+        fluczakAI::BehaviorTreeBuilder builder;
+        builder.Parallel(successThreshold, failureThreshold);
+        builder.Action<ScriptedAction<0>>().Back();
+        builder.Action<ScriptedAction<1>>().Back();
+        builder.Action<ScriptedAction<2>>().Back();
+        return builder.End();
+    }
+
+    /**
+     * \brief Execute a tree once with the statuses the children have to return
+     * \return - the status of the parallel
+     */
+    Status Execute(const fluczakAI::BehaviorTree& tree, fluczakAI::BehaviorTreeContext& context, Status first, Status second, Status third)
+    {
+        context.blackboard->SetData(statusKeys[0], first);
+        context.blackboard->SetData(statusKeys[1], second);
+        context.blackboard->SetData(statusKeys[2], third);
+        tree.Execute(context);
+        return context.statuses.Get(0);
+    }
+
+    int Ticks(const fluczakAI::BehaviorTreeContext& context, int index)
+    {
+        return context.blackboard->GetData<int>(tickKeys[index]);
+    }
+
+    fluczakAI::BehaviorTreeContext MakeContext(const fluczakAI::BehaviorTree& tree)
+    {
+        fluczakAI::BehaviorTreeContext context;
+        for (const auto& key : tickKeys) context.blackboard->SetData(key, 0);
+        tree.InitializeContext(context);
+        return context;
+    }
+
+    void TestSuccessThreshold()
+    {
+        const auto tree = BuildParallel(2, 3);
+        auto context = MakeContext(*tree);
+        CHECK(Execute(*tree, context, Status::SUCCESS, Status::RUNNING, Status::FAILURE) == Status::RUNNING);
+
+        // The children that have finished keep their statuses and aren't executed again
+        CHECK(Execute(*tree, context, Status::FAILURE, Status::RUNNING, Status::SUCCESS) == Status::RUNNING);
+        CHECK(Ticks(context, 0) == 1 && Ticks(context, 1) == 2 && Ticks(context, 2) == 1);
+        CHECK(context.statuses.Get(1) == Status::SUCCESS);
+        CHECK(context.statuses.Get(3) == Status::FAILURE);
+
+        CHECK(Execute(*tree, context, Status::FAILURE, Status::SUCCESS, Status::FAILURE) == Status::SUCCESS);
+        CHECK(Ticks(context, 0) == 1 && Ticks(context, 1) == 3 && Ticks(context, 2) == 1);
+
+        // Finishing resets the children, so all of them are executed again
+        CHECK(Execute(*tree, context, Status::RUNNING, Status::RUNNING, Status::RUNNING) == Status::RUNNING);
+        CHECK(Ticks(context, 0) == 2 && Ticks(context, 1) == 4 && Ticks(context, 2) == 2);
+    }
+
+    void TestFailureThreshold()
+    {
+        const auto tree = BuildParallel(1, 2);
+        auto context = MakeContext(*tree);
+        CHECK(Execute(*tree, context, Status::FAILURE, Status::RUNNING, Status::RUNNING) == Status::RUNNING);
+        CHECK(Execute(*tree, context, Status::SUCCESS, Status::FAILURE, Status::RUNNING) == Status::FAILURE);
+        CHECK(Ticks(context, 0) == 1 && Ticks(context, 1) == 2 && Ticks(context, 2) == 2);
+
+        // Reaching both thresholds on the same tick succeeds
+        CHECK(Execute(*tree, context, Status::FAILURE, Status::FAILURE, Status::SUCCESS) == Status::SUCCESS);
+    }
+
+    void TestTooFewChildrenLeft()
+    {
+        // Two successes are needed, so after two failures the last child can't make it, failing before the
+        // failure threshold of three is reached
+        const auto tree = BuildParallel(2, 3);
+        auto context = MakeContext(*tree);
+        CHECK(Execute(*tree, context, Status::FAILURE, Status::RUNNING, Status::RUNNING) == Status::RUNNING);
+        CHECK(Execute(*tree, context, Status::RUNNING, Status::FAILURE, Status::RUNNING) == Status::FAILURE);
+        CHECK(Ticks(context, 2) == 2);
+    }
+
+    void TestAllChildren()
+    {
+        // A threshold of 0 means all of the children, one above their number is clamped to it
+        const auto all = BuildParallel(0, 0);
+        auto context = MakeContext(*all);
+        CHECK(Execute(*all, context, Status::SUCCESS, Status::SUCCESS, Status::RUNNING) == Status::RUNNING);
+        CHECK(Execute(*all, context, Status::RUNNING, Status::RUNNING, Status::SUCCESS) == Status::SUCCESS);
+        CHECK(Execute(*all, context, Status::FAILURE, Status::FAILURE, Status::RUNNING) == Status::FAILURE);
+
+        const auto clamped = BuildParallel(5, 1);
+        auto clampedContext = MakeContext(*clamped);
+        CHECK(Execute(*clamped, clampedContext, Status::SUCCESS, Status::SUCCESS, Status::SUCCESS) == Status::SUCCESS);
+    }
+
+    void TestJson()
+    {
+        const auto tree = BuildParallel(2, 3);
+        nlohmann::json json = tree->Serialize();
+        const nlohmann::json& node = json["children"][0];
+        CHECK(node["name"] == "Parallel");
+        CHECK(node["success-threshold"] == 2);
+        CHECK(node["failure-threshold"] == 3);
+
+        std::unique_ptr<fluczakAI::Behavior> root;
+        fluczakAI::BehaviorTree deserialized(root);
+        deserialized.Deserialize(json);
+        CHECK(deserialized.GetError().empty());
+        const auto* parallel = dynamic_cast<const fluczakAI::Parallel*>(deserialized.GetRoot().get());
+        CHECK(parallel != nullptr && parallel->GetSuccessThreshold() == 2 && parallel->GetFailureThreshold() == 3);
+        CHECK(parallel != nullptr && parallel->GetChildren().size() == 3);
+
+        // Without the fields, all of the children have to succeed and one failure is enough
+        json["children"][0].erase("success-threshold");
+        json["children"][0].erase("failure-threshold");
+        deserialized.Deserialize(json);
+        parallel = dynamic_cast<const fluczakAI::Parallel*>(deserialized.GetRoot().get());
+        CHECK(parallel != nullptr && parallel->GetSuccessThreshold() == 0 && parallel->GetFailureThreshold() == 1);
+    }
+}
+
+int main()
+{
+    // Template arguments aren't serialized, so every child is deserialized as the same action
+    fluczakAI::GenericFactory<fluczakAI::BehaviorTreeAction>::Instance().RegisterProduct<ScriptedAction<0>>("ScriptedAction");
+
+    TestSuccessThreshold();
+    TestFailureThreshold();
+    TestTooFewChildrenLeft();
+    TestAllChildren();
+    TestJson();
+    return TestFailures() == 0 ? 0 : 1;
+}
@@ -0,0 +1,298 @@
+// Tests of sleeping agents: TimerWheel against a brute force list of deadlines, SleepManager waking contexts by
+// time, by key and on request, and AgentScheduler skipping the agents that sleep, also when the children of a
+// threaded Parallel ask to sleep at the same time.
+
+#include <random>
+#include <vector>
+#include "test_utilities.hpp"
+#include "BehaviorTrees/behavior_tree_builder.hpp"
+#include "Scheduling/agent_scheduler.hpp"
+#include "Scheduling/sleep_manager.hpp"
+#include "Scheduling/timer_wheel.hpp"
+
+namespace
+{
+    const fluczakAI::BlackboardKey ticksKey("ticks");
+    const fluczakAI::BlackboardKey sleepyKey("sleepy");
+    const fluczakAI::BlackboardKey alarmKey("alarm");
+    const fluczakAI::BlackboardKey otherKey("other");
+    const fluczakAI::BlackboardKey waitKeys[] = {
+        fluczakAI::BlackboardKey("first"), fluczakAI::BlackboardKey("second"),
+        fluczakAI::BlackboardKey("third"), fluczakAI::BlackboardKey("fourth")};
+
+    /**
+     * \brief A timer of the reference, which expires on the first tick at or after its deadline
+     */
+    struct ReferenceTimer
+    {
+        uint64_t deadline;
+        fluczakAI::TimerWheel::TimerId id;
+        bool isPending;
+    };
+
+    void TestTimerWheelMatchesBruteForce()
+    {
+        // Whole ticks of one second, so the deadlines of the reference are exact
+        fluczakAI::TimerWheel wheel(1.0f);
+        std::vector<ReferenceTimer> timers;
+        uint64_t now = 0;
+        std::mt19937 generator(7);
+
+        // Mostly short delays, some on every level and a few past the range of the wheel
+        const auto randomDelay = [&generator]()
+        {
+            const uint32_t kind = generator() % 100;
+            if (kind < 60) return 1 + generator() % 64;
+            if (kind < 85) return 1 + generator() % 4096;
+            if (kind < 97) return 1 + generator() % 300000;
+            return 16777216 + (generator() % 8) * 2;
+        };
+
+        const auto schedule = [&](uint64_t from, uint32_t delay)
+        {
+            const auto payload = static_cast<uint32_t>(timers.size());
+            timers.push_back({from + delay, wheel.Schedule(static_cast<float>(delay), payload), true});
+        };
+
+        size_t expiredOutOfTime = 0;
+        for (int operation = 0; operation < 5000; operation++)
+        {
+            const uint32_t kind = generator() % 10;
+            if (kind < 4)
+            {
+                schedule(now, randomDelay());
+            }
+            else if (kind < 6 && !timers.empty())
+            {
+                // Cancelling an expired or cancelled timer must not touch the timer that reuses its slot
+                ReferenceTimer& timer = timers[generator() % timers.size()];
+                wheel.Cancel(timer.id);
+                timer.isPending = false;
+            }
+            else
+            {
+                const uint64_t ticks = generator() % 500 == 0 ? 1 + generator() % 16777216 : generator() % 200;
+                const uint64_t target = now + ticks;
+                uint64_t lastDeadline = now;
+                wheel.Advance(static_cast<float>(ticks), [&](uint32_t payload)
+                {
+                    ReferenceTimer& timer = timers[payload];
+                    // Every timer expires once, after the previous ones and not past the end of the advance
+                    if (!timer.isPending || timer.deadline < lastDeadline || timer.deadline > target) expiredOutOfTime++;
+                    timer.isPending = false;
+                    lastDeadline = timer.deadline;
+
+                    // Timers scheduled while expiring others count from the tick they are scheduled on
+                    if (payload % 3 == 0) schedule(timer.deadline, 1 + generator() % 100);
+                });
+                now = target;
+
+                size_t pending = 0;
+                for (const ReferenceTimer& timer : timers)
+                {
+                    if (timer.isPending && timer.deadline <= now) expiredOutOfTime++;
+                    pending += timer.isPending ? 1 : 0;
+                }
+                CHECK(wheel.GetTimerCount() == pending);
+            }
+        }
+        CHECK(expiredOutOfTime == 0);
+
+        // Every single tick is checked exactly for timers of every level
+        fluczakAI::TimerWheel exact(1.0f);
+        std::vector<uint64_t> deadlines;
+        for (uint32_t i = 0; i < 1000; i++)
+        {
+            const uint32_t delay = 1 + generator() % 300000;
+            deadlines.push_back(delay);
+            exact.Schedule(static_cast<float>(delay), i);
+        }
+        size_t wrongTick = 0;
+        for (uint64_t tick = 1; tick <= 300000; tick++)
+        {
+            exact.Advance(1.0f, [&](uint32_t payload) { if (deadlines[payload] != tick) wrongTick++; });
+        }
+        CHECK(wrongTick == 0);
+        CHECK(exact.GetTimerCount() == 0);
+    }
+
+    void TestSleepManager()
+    {
+        // Sleep times of whole ticks of a power of two resolution, so they are exact
+        fluczakAI::SleepManager manager(0.25f);
+        fluczakAI::AIExecutionContext context;
+        fluczakAI::Blackboard blackboard;
+
+        // Asleep by time
+        context.Sleep(1.0f);
+        context.Sleep(0.5f);
+        CHECK(manager.NeedsUpdate(context));
+        manager.Update(context, blackboard);
+        CHECK(context.IsSleeping());
+        CHECK(!manager.ShouldTick(context));
+        CHECK(manager.GetSleepingCount() == 1);
+        manager.Advance(0.25f);
+        CHECK(!manager.ShouldTick(context));
+        manager.Advance(0.25f);
+        CHECK(manager.ShouldTick(context));
+
+        // Ticked after waking up, the context is forgotten
+        CHECK(manager.NeedsUpdate(context));
+        manager.Update(context, blackboard);
+        CHECK(!context.IsSleeping());
+        CHECK(!manager.NeedsUpdate(context));
+        CHECK(manager.GetSleepingCount() == 0);
+
+        // Asleep until a key changes, other keys and time don't wake it
+        context.SleepUntilChanged(alarmKey);
+        manager.Update(context, blackboard);
+        blackboard.SetData(otherKey, 1);
+        manager.Advance(1000.0f);
+        CHECK(!manager.ShouldTick(context));
+        blackboard.SetData(alarmKey, 1);
+        CHECK(manager.ShouldTick(context));
+        manager.Update(context, blackboard);
+        CHECK(manager.GetSleepingCount() == 0);
+
+        // Whichever comes first wakes it, the timer of a context woken by a key is cancelled
+        context.Sleep(0.5f);
+        context.SleepUntilChanged(alarmKey);
+        manager.Update(context, blackboard);
+        blackboard.SetData(alarmKey, 2);
+        CHECK(manager.ShouldTick(context));
+        manager.Update(context, blackboard);
+        context.Sleep(0.25f);
+        context.SleepUntilChanged(alarmKey);
+        manager.Update(context, blackboard);
+        manager.Advance(0.25f);
+        CHECK(manager.ShouldTick(context));
+        manager.Update(context, blackboard);
+
+        // Woken on request, its subscription is gone so the record can be reused by another context
+        context.SleepUntilChanged(alarmKey);
+        manager.Update(context, blackboard);
+        manager.Wake(context);
+        CHECK(!context.IsSleeping());
+        CHECK(manager.ShouldTick(context));
+        CHECK(manager.GetSleepingCount() == 0);
+
+        fluczakAI::AIExecutionContext other;
+        other.SleepUntilChanged(otherKey);
+        manager.Update(other, blackboard);
+        blackboard.SetData(alarmKey, 3);
+        CHECK(!manager.ShouldTick(other));
+        manager.Wake(other);
+    }
+
+    /**
+     * \brief Counts its ticks, and goes to sleep until the alarm if the agent is sleepy
+     */
+    class SleepyAction : public fluczakAI::BehaviorTreeAction
+    {
+    public:
+        fluczakAI::Status Tick(fluczakAI::BehaviorTreeContext& context) override
+        {
+            context.blackboard->SetData(ticksKey, context.blackboard->GetData<int>(ticksKey) + 1);
+            if (context.blackboard->GetData<bool>(sleepyKey))
+            {
+                context.Sleep(1.0f);
+                context.SleepUntilChanged(alarmKey);
+            }
+            return fluczakAI::Status::RUNNING;
+        }
+    };
+
+    void TestSchedulerSkipsSleepingAgents()
+    {
+        fluczakAI::BehaviorTreeBuilder builder;
+        builder.Sequence();
+        builder.Action<SleepyAction>().Back();
+        const auto tree = builder.End();
+
+        constexpr size_t count = 1000;
+        std::vector<fluczakAI::BehaviorTreeContext> contexts(count);
+        for (size_t i = 0; i < count; i++)
+        {
+            contexts[i].blackboard->SetData(ticksKey, 0);
+            contexts[i].blackboard->SetData(sleepyKey, i % 2 == 0);
+        }
+
+        // Destroyed before the contexts, so the sleeping ones leave their blackboards first
+        fluczakAI::ThreadPool pool(4);
+        fluczakAI::AgentScheduler scheduler(pool, 16);
+        const auto ticksOf = [&contexts](size_t i) { return contexts[i].blackboard->GetData<int>(ticksKey); };
+
+        for (int tick = 0; tick < 3; tick++) scheduler.Tick(*tree, contexts.data(), count);
+        CHECK(scheduler.GetSleepManager().GetSleepingCount() == count / 2);
+        for (size_t i = 0; i < count; i++)
+        {
+            CHECK(ticksOf(i) == (i % 2 == 0 ? 1 : 3));
+            CHECK(contexts[i].IsSleeping() == (i % 2 == 0));
+        }
+
+        // The alarm wakes a few before their time is up
+        for (size_t i = 0; i < count; i += 10) contexts[i].blackboard->SetData(alarmKey, 1);
+        scheduler.AdvanceTime(0.9f);
+        scheduler.Tick(*tree, contexts.data(), count);
+        for (size_t i = 0; i < count; i += 2) CHECK(ticksOf(i) == (i % 10 == 0 ? 2 : 1));
+
+        // The others wake when their time is up, everyone has slept once more since
+        scheduler.AdvanceTime(0.2f);
+        scheduler.Tick(*tree, contexts.data(), count);
+        for (size_t i = 0; i < count; i += 2) CHECK(ticksOf(i) == 2);
+        CHECK(scheduler.GetSleepManager().GetSleepingCount() == count / 2);
+    }
+
+    /**
+     * \brief Waits for the key named by the blackboard, on a thread of its own in a threaded Parallel
+     */
+    template <int Index>
+    class WaitingAction : public fluczakAI::BehaviorTreeAction
+    {
+    public:
+        fluczakAI::Status Tick(fluczakAI::BehaviorTreeContext& context) override
+        {
+            context.Sleep(10.0f + Index);
+            context.SleepUntilChanged(waitKeys[Index]);
+            return fluczakAI::Status::RUNNING;
+        }
+    };
+
+    void TestSleepFromThreadedParallel()
+    {
+        fluczakAI::BehaviorTreeBuilder builder;
+        builder.Parallel(4, 1);
+        builder.Action<WaitingAction<0>>().Back();
+        builder.Action<WaitingAction<1>>().Back();
+        builder.Action<WaitingAction<2>>().Back();
+        builder.Action<WaitingAction<3>>().Back();
+        const auto tree = builder.End();
+
+        fluczakAI::ThreadPool pool(4);
+        constexpr size_t count = 400;
+        std::vector<fluczakAI::BehaviorTreeContext> contexts(count);
+        for (auto& context : contexts) context.threadPool = &pool;
+
+        fluczakAI::AgentScheduler scheduler(pool, 8);
+        scheduler.Tick(*tree, contexts.data(), count);
+        CHECK(scheduler.GetSleepManager().GetSleepingCount() == count);
+
+        // Every child's key was kept, so any of them wakes its agent, and the shortest sleep time was kept
+        for (size_t i = 0; i < count; i += 5) contexts[i].blackboard->SetData(waitKeys[i % 4], 1);
+        size_t awake = 0;
+        for (const auto& context : contexts) awake += scheduler.GetSleepManager().ShouldTick(context) ? 1 : 0;
+        CHECK(awake == count / 5);
+
+        scheduler.AdvanceTime(10.5f);
+        for (const auto& context : contexts) CHECK(scheduler.GetSleepManager().ShouldTick(context));
+    }
+}
+
+int main()
+{
+    TestTimerWheelMatchesBruteForce();
+    TestSleepManager();
+    TestSchedulerSkipsSleepingAgents();
+    TestSleepFromThreadedParallel();
+    return TestFailures() == 0 ? 0 : 1;
+}
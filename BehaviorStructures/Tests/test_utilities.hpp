@@ -0,0 +1,21 @@
+#pragma once
+#include <iostream>
+
+/**
+ * \brief The number of failed checks of the test, its main returns nonzero if there are any
+ */
+inline int& TestFailures()
+{
+    static int failures = 0;
+    return failures;
+}
+
+#define CHECK(condition)                                                                              \
+    do                                                                                                \
+    {                                                                                                 \
+        if (!(condition))                                                                             \
+        {                                                                                             \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": CHECK(" #condition ") failed" << std::endl; \
+            TestFailures()++;                                                                         \
+        }                                                                                             \
+    } while (false)
@@ -0,0 +1,105 @@
+// Tests of WorkStealingDeque and ThreadPool: every task pushed has to be taken exactly once, while the owner pushes
+// and pops and the thieves steal at the same time, also when the deque grows.
+
+#include <atomic>
+#include <thread>
+#include <vector>
+#include "test_utilities.hpp"
+#include "Scheduling/thread_pool.hpp"
+
+namespace
+{
+    struct Item
+    {
+        size_t value;
+        size_t padding[3];
+    };
+
+    void TestSingleThreaded()
+    {
+        fluczakAI::WorkStealingDeque<Item> deque(4);
+        CHECK(!deque.Pop().has_value());
+        CHECK(!deque.Steal().has_value());
+
+        // Grows twice, the steals take the oldest items and the pops the newest
+        for (size_t i = 0; i < 16; i++) deque.Push({i, {}});
+        CHECK(deque.Steal()->value == 0);
+        CHECK(deque.Steal()->value == 1);
+        CHECK(deque.Pop()->value == 15);
+        CHECK(deque.Pop()->value == 14);
+
+        // Wraps around the ring buffer
+        for (size_t i = 16; i < 20; i++) deque.Push({i, {}});
+        size_t count = 0;
+        while (deque.Steal().has_value()) count++;
+        CHECK(count == 16);
+        CHECK(!deque.Pop().has_value());
+    }
+
+    void TestConcurrentSteals()
+    {
+        constexpr size_t itemCount = 200000;
+        constexpr size_t thiefCount = 3;
+
+        fluczakAI::WorkStealingDeque<Item> deque(8);
+        std::vector<std::atomic<int>> taken(itemCount);
+        std::atomic<bool> done{false};
+
+        std::vector<std::thread> thieves;
+        for (size_t i = 0; i < thiefCount; i++)
+        {
+            thieves.emplace_back([&]()
+            {
+                while (!done.load(std::memory_order_acquire))
+                {
+                    if (const auto item = deque.Steal()) taken[item->value]++;
+                }
+            });
+        }
+
+        // Pushes in bursts and pops some of them, so the owner and the thieves race for the last items
+        for (size_t i = 0; i < itemCount;)
+        {
+            const size_t burst = i % 7 * 13 + 1;
+            for (size_t j = 0; j < burst && i < itemCount; j++, i++) deque.Push({i, {}});
+            for (size_t j = 0; j < burst / 2; j++)
+            {
+                if (const auto item = deque.Pop()) taken[item->value]++;
+            }
+        }
+        while (const auto item = deque.Pop()) taken[item->value]++;
+
+        done.store(true, std::memory_order_release);
+        for (auto& thief : thieves) thief.join();
+
+        size_t wrong = 0;
+        for (const auto& count : taken) wrong += count.load() != 1;
+        CHECK(wrong == 0);
+    }
+
+    void TestParallelForRunsEveryChunkOnce()
+    {
+        fluczakAI::ThreadPool pool(3);
+        std::vector<std::atomic<int>> calls(5000);
+        for (int run = 0; run < 20; run++)
+        {
+            // One task per element, many more than a deque holds before it grows
+            pool.ParallelFor(calls.size(), 1, [&calls](size_t begin, size_t end, fluczakAI::WorkerContext&)
+            {
+                for (size_t i = begin; i < end; i++) calls[i]++;
+            });
+        }
+
+        size_t wrong = 0;
+        for (const auto& count : calls) wrong += count.load() != 20;
+        CHECK(wrong == 0);
+    }
+}
+
+int main()
+{
+    TestSingleThreaded();
+    TestConcurrentSteals();
+    TestParallelForRunsEveryChunkOnce();
+    return TestFailures() == 0 ? 0 : 1;
+}
@@ -0,0 +1,90 @@
+// Generates a C++ header from a behavior tree or state machine serialized to json, see fluczakAI::CodeGenerator.
+//
+//   behavior_codegen <input.json> <output.hpp> <name> [--namespace <namespace>] [--library-path <path>] [--include <header>]...
+//
+// Meant to run as a build step, so the generated header is rebuilt whenever a designer changes the json.
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "../Serialization/code_generator.hpp"
+
+int main(int argc, char** argv)
+{
+    if (argc < 4)
+    {
+        std::cerr << "usage: behavior_codegen <input.json> <output.hpp> <name> [--namespace <namespace>] [--library-path <path>] [--include <header>]...\n";
+        return 1;
+    }
+
+    std::string nameSpace;
+    std::string libraryPath;
+    std::vector<std::string> includes;
+    for (int i = 4; i < argc; i++)
+    {
+        const std::string option = argv[i];
+        if (i + 1 >= argc)
+        {
+            std::cerr << "behavior_codegen: " << option << " needs a value\n";
+            return 1;
+        }
+
+        if (option == "--namespace") nameSpace = argv[++i];
+        else if (option == "--library-path") libraryPath = argv[++i];
+        else if (option == "--include") includes.emplace_back(argv[++i]);
+        else
+        {
+            std::cerr << "behavior_codegen: unknown option " << option << "\n";
+            return 1;
+        }
+    }
+
+    std::ifstream input(argv[1]);
+    if (!input)
+    {
+        std::cerr << "behavior_codegen: can't open " << argv[1] << "\n";
+        return 1;
+    }
+
+    const nlohmann::json json = nlohmann::json::parse(input, nullptr, false);
+    if (json.is_discarded())
+    {
+        std::cerr << "behavior_codegen: " << argv[1] << " is not valid json\n";
+        return 1;
+    }
+
+    fluczakAI::CodeGenerator generator(argv[3], nameSpace);
+    generator.SetLibraryPath(libraryPath);
+    for (auto& include : includes)
+    {
+        generator.AddInclude(std::move(include));
+    }
+
+    const std::string source = generator.Generate(json);
+    if (source.empty())
+    {
+        std::cerr << "behavior_codegen: " << argv[1] << ": " << generator.GetError() << "\n";
+        return 1;
+    }
+
+    // An unchanged header isn't rewritten, so the build doesn't recompile everything including it
+    std::ifstream previous(argv[2]);
+    if (previous)
+    {
+        std::stringstream contents;
+        contents << previous.rdbuf();
+        if (contents.str() == source) return 0;
+    }
+
+    std::ofstream output(argv[2]);
+    output << source;
+    if (!output)
+    {
+        std::cerr << "behavior_codegen: can't write " << argv[2] << "\n";
+        return 1;
+    }
+
+    return 0;
+}
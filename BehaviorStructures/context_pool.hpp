@@ -0,0 +1,120 @@
+#pragma once
+#include <cassert>
+#include <deque>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "BehaviorTrees/behavior_tree.hpp"
+#include "Blackboards/BlackboardTemplate.hpp"
+#include "FSM/finite_state_machine.hpp"
+
+namespace fluczakAI
+{
+/**
+ * \brief Recycles the contexts of the agents of a single behavior tree or state machine. A released context
+ * keeps its memory: the statuses stay presized, and the blackboard is cleared in place and refilled from a
+ * template, so once the pool has grown to the number of live agents, Acquire and Release don't allocate.
+ * A blackboard bound to a row of a BlackboardColumnStore stays bound, and its row is reset to the defaults of the
+ * columns.
+ * \tparam TContext - BehaviorTreeContext or StateMachineContext
+ * \tparam TStructure - BehaviorTree or FiniteStateMachine, anything with InitializeContext(TContext&)
+ */
+template <typename TContext, typename TStructure>
+class ContextPool
+{
+public:
+    /**
+     * \param structure - the tree or state machine the contexts are executed with, it has to outlive the pool
+     * \param defaults - the values the blackboards of acquired contexts start with
+     */
+    explicit ContextPool(const TStructure& structure, BlackboardTemplate defaults = {}) : m_structure(structure), m_defaults(std::move(defaults)) {}
+
+    ContextPool(const ContextPool&) = delete;
+    ContextPool& operator=(const ContextPool&) = delete;
+
+    /**
+     * \brief Get a context that is ready for its first execution
+     * \return - the context, it stays valid until it is released or the pool is destroyed
+     */
+    TContext& Acquire()
+    {
+        if (m_free.empty()) Grow(1);
+
+        TContext* context = m_free.back();
+        m_free.pop_back();
+        return *context;
+    }
+
+    /**
+     * \brief Give a context back to the pool. It must not be asleep in a SleepManager.
+     * \param context - a context returned by Acquire
+     */
+    void Release(TContext& context)
+    {
+        assert(!context.IsSleeping());
+        Reset(context);
+        m_free.push_back(&context);
+    }
+
+    /**
+     * \brief Create contexts up front, so up to a given number of contexts can be acquired without allocating
+     * \param count - the number of contexts the pool should have
+     */
+    void Reserve(size_t count)
+    {
+        if (count > m_contexts.size()) Grow(count - m_contexts.size());
+    }
+
+    /**
+     * \brief Get the number of contexts created by the pool
+     */
+    size_t Size() const { return m_contexts.size(); }
+
+    /**
+     * \brief Get the number of contexts that can be acquired without creating new ones
+     */
+    size_t GetFreeCount() const { return m_free.size(); }
+
+private:
+    void Grow(size_t count)
+    {
+        // Releasing contexts never has to grow the free list
+        m_free.reserve(m_contexts.size() + count);
+        for (size_t i = 0; i < count; i++)
+        {
+            m_contexts.emplace_back();
+            Reset(m_contexts.back());
+            m_free.push_back(&m_contexts.back());
+        }
+    }
+
+    void Reset(TContext& context) const
+    {
+        context.deltaTime = 0.0f;
+        context.ClearSleepRequest();
+        m_structure.InitializeContext(context);
+
+        if constexpr (std::is_same_v<TContext, BehaviorTreeContext>)
+        {
+            context.runningPath.clear();
+            context.threadPool = nullptr;
+        }
+
+        Blackboard& blackboard = *context.blackboard;
+        if (blackboard.GetParent() != nullptr) blackboard.SetParent(nullptr);
+        blackboard.Clear();
+        // Clear leaves the values of a bound row to their owner
+        blackboard.ResetLayoutValues();
+        m_defaults.Apply(blackboard);
+    }
+
+    const TStructure& m_structure;
+    BlackboardTemplate m_defaults;
+    // A deque, so contexts don't move when the pool grows
+    std::deque<TContext> m_contexts{};
+    std::vector<TContext*> m_free{};
+};
+
+using BehaviorTreeContextPool = ContextPool<BehaviorTreeContext, BehaviorTree>;
+using StateMachineContextPool = ContextPool<StateMachineContext, FiniteStateMachine>;
+}
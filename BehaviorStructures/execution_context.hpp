@@ -1,7 +1,28 @@
 #pragma once
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+#include <limits>
+#include <mutex>
+#include <vector>
+#include "Blackboards/BlackboardKey.hpp"
 
 namespace fluczakAI
 {
+namespace detail
+{
+    /**
+     * \brief The lock taken by the sleep requests of a context. The children of a threaded Parallel share their
+     * context and can ask to sleep at the same time. A mutex per context would make contexts immovable, and sleep
+     * requests are rare, so contexts share a few locks picked by their address.
+     */
+    inline std::mutex& SleepRequestMutex(const void* context)
+    {
+        static std::mutex mutexes[16];
+        return mutexes[reinterpret_cast<uintptr_t>(context) / alignof(std::max_align_t) % 16];
+    }
+}
+
 /**
  * \brief A base class for an execution context- it is used to store useful data while
  * executing AI behavior selection structures
@@ -9,5 +30,58 @@ namespace fluczakAI
 struct AIExecutionContext
     {
         virtual ~AIExecutionContext() = default;
+
+        /**
+         * \brief Ask the scheduler to stop ticking the context until a given time has passed. Meant to be called by
+         * a behavior or a state that has nothing to do until then, the context falls asleep after the current tick.
+         * Safe to call from the children of a threaded Parallel.
+         * \param seconds - time until the context is ticked again
+         */
+        void Sleep(float seconds)
+        {
+            std::lock_guard<std::mutex> lock(detail::SleepRequestMutex(this));
+            m_sleepSeconds = std::min(m_sleepSeconds, seconds);
+            m_isSleepRequested = true;
+        }
+
+        /**
+         * \brief Ask the scheduler to stop ticking the context until the value of a key in its blackboard changes.
+         * Can be combined with Sleep and other keys, the context wakes up on whichever comes first. Safe to call from
+         * the children of a threaded Parallel.
+         * \param key - the key to wait for
+         */
+        void SleepUntilChanged(const BlackboardKey& key)
+        {
+            std::lock_guard<std::mutex> lock(detail::SleepRequestMutex(this));
+            if (std::find(m_wakeKeys.begin(), m_wakeKeys.end(), key) == m_wakeKeys.end())
+            {
+                m_wakeKeys.push_back(key);
+            }
+            m_isSleepRequested = true;
+        }
+
+        /**
+         * \brief Forget the calls to Sleep and SleepUntilChanged made since the last tick
+         */
+        void ClearSleepRequest()
+        {
+            m_isSleepRequested = false;
+            m_sleepSeconds = std::numeric_limits<float>::infinity();
+            m_wakeKeys.clear();
+        }
+
+        /**
+         * \brief Whether or not the context is asleep, or was woken up and hasn't been ticked since
+         */
+        bool IsSleeping() const { return m_sleepRecord != NotSleeping; }
+
+    private:
+        friend class SleepManager;
+        static constexpr uint32_t NotSleeping = std::numeric_limits<uint32_t>::max();
+
+        bool m_isSleepRequested = false;
+        float m_sleepSeconds = std::numeric_limits<float>::infinity();
+        std::vector<BlackboardKey> m_wakeKeys{};
+        uint32_t m_sleepRecord = NotSleeping;
     };
 }  // namespace bee::ai